@@ -0,0 +1,31 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_platform/platform.h"
+#include "al2o3_thread/atomic.h"
+
+// The address ranges of a manager's blocks sorted by base, so a pointer into
+// any element can be mapped back to its block with a binary search.
+// Blocks are only ever added so inserts are rare, they are serialised on the
+// sequence (odd while one is in progress) and finds retry if it changed under
+// them, the same protocol as the 64 bit manager's SeqLock element access.
+// A grown array replaces the old one which is kept until Destroy, as a find
+// may still be reading it. A zero'ed index is valid and empty.
+typedef struct Handle_AddressRange {
+	uintptr_t base;
+	size_t size;
+	// index of the element at base
+	uint64_t firstIndex;
+} Handle_AddressRange;
+
+typedef struct Handle_AddressIndex {
+	Thread_Atomic32_t sequence;
+	// current array, NULL until the first insert
+	Thread_AtomicPtr_t ranges;
+} Handle_AddressIndex;
+
+AL2O3_EXTERN_C bool Handle_AddressIndexInsert(Handle_AddressIndex *index, void const *base, size_t size, uint64_t firstIndex);
+// returns false if ptr isn't inside any range
+AL2O3_EXTERN_C bool Handle_AddressIndexFind(Handle_AddressIndex *index, void const *ptr, Handle_AddressRange *range);
+// frees the current and any replaced arrays, leaves it empty
+AL2O3_EXTERN_C void Handle_AddressIndexDestroy(Handle_AddressIndex *index);
@@ -0,0 +1,23 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_platform/platform.h"
+
+// Where a manager gets its header and block memory from, so blocks can come
+// from an arena, huge page pool or tracking allocator shared by many managers.
+// alloc must return zero'ed memory aligned to at least alignment, free is
+// given back the same size. context is passed through untouched.
+typedef void *(*Handle_BlockAllocFunc)(void *context, size_t size, size_t alignment);
+typedef void (*Handle_BlockFreeFunc)(void *context, void *ptr, size_t size);
+
+typedef struct Handle_BlockAllocator {
+	Handle_BlockAllocFunc alloc;
+	Handle_BlockFreeFunc free;
+	void *context;
+} Handle_BlockAllocator;
+
+// alignment the managers ask for (enough for the 128 bit atomics in the header)
+#define Handle_BlockAlignment 16u
+
+// MEMORY_CALLOC/MEMORY_FREE, what managers use when not given one
+AL2O3_EXTERN_C Handle_BlockAllocator const *Handle_BlockAllocatorDefault(void);
@@ -0,0 +1,76 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_handle/handle.h"
+
+// Epoch based protection for readers of Handle_Manager32 elements.
+// A plain Release immediately reuses the start of the element as a free list
+// link, so a reader holding a pointer from HandleToPtr can race with it.
+// Readers instead pin the current epoch (Enter/Leave, a store and a fence) and
+// Handle_EpochRelease32 invalidates the handle straight away but only recycles
+// the slot once every thread pinned at that time has left.
+// Each thread using a domain registers once and passes its record to the calls.
+#define Handle_EpochMaxThreads 64
+#define Handle_EpochCacheLineSize 64
+
+typedef struct Handle_EpochRetired32 {
+	Handle_Manager32 *manager;
+	uint32_t index;
+	uint64_t epoch;
+} Handle_EpochRetired32;
+
+typedef struct Handle_EpochThread {
+	// (epoch << 1) | 1 when pinned, 0 when not
+	Thread_Atomic64_t state;
+
+	// only touched by the owning thread
+	Handle_EpochRetired32 *retired;
+	uint32_t retiredCount;
+	uint32_t retiredCapacity;
+
+	Thread_Atomic32_t inUse;
+
+	// one thread per cache line
+	uint8_t padding[Handle_EpochCacheLineSize - sizeof(Thread_Atomic64_t) - sizeof(Handle_EpochRetired32 *) -
+			(3 * sizeof(uint32_t))];
+} Handle_EpochThread;
+
+typedef struct Handle_EpochDomain {
+	Thread_Atomic64_t globalEpoch;
+	uint8_t padding[Handle_EpochCacheLineSize - sizeof(Thread_Atomic64_t)];
+
+	Handle_EpochThread threads[Handle_EpochMaxThreads];
+} Handle_EpochDomain;
+
+AL2O3_EXTERN_C Handle_EpochDomain *Handle_EpochDomainCreate(void);
+// recycles anything still retired, no thread may be pinned
+AL2O3_EXTERN_C void Handle_EpochDomainDestroy(Handle_EpochDomain *domain);
+
+// returns NULL if Handle_EpochMaxThreads are already registered
+AL2O3_EXTERN_C Handle_EpochThread *Handle_EpochRegisterThread(Handle_EpochDomain *domain);
+// waits until everything this thread retired has been recycled
+AL2O3_EXTERN_C void Handle_EpochUnregisterThread(Handle_EpochDomain *domain, Handle_EpochThread *thread);
+
+// invalidates the handle now, the slot is recycled once no reader can still see it
+// returns false, leaving the handle valid, if out of memory to track it
+AL2O3_EXTERN_C bool Handle_EpochRelease32(Handle_EpochDomain *domain,
+																					Handle_EpochThread *thread,
+																					Handle_Manager32 *manager,
+																					Handle_Handle32 handle);
+// tries to advance the epoch and recycle this threads retired slots, returns how many are still waiting
+AL2O3_EXTERN_C uint32_t Handle_EpochReclaim(Handle_EpochDomain *domain, Handle_EpochThread *thread);
+
+// pointers from HandleToPtr are safe from concurrent Handle_EpochRelease32 until Leave
+AL2O3_FORCE_INLINE void Handle_EpochEnter(Handle_EpochDomain *domain, Handle_EpochThread *thread) {
+	uint64_t const epoch = Thread_AtomicLoad64Relaxed(&domain->globalEpoch);
+	Thread_AtomicStore64Relaxed(&thread->state, (epoch << 1u) | 1u);
+	// the pin must be visible before any element reads
+	Thread_AtomicThreadFenceSeqCst();
+}
+
+AL2O3_FORCE_INLINE void Handle_EpochLeave(Handle_EpochDomain *domain, Handle_EpochThread *thread) {
+	(void) domain;
+	// element reads must complete before we unpin
+	Thread_AtomicThreadFenceRelease();
+	Thread_AtomicStore64Relaxed(&thread->state, 0);
+}
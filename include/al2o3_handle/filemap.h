@@ -0,0 +1,34 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_platform/platform.h"
+
+// A read/write shared mapping of a whole file, used as block storage by
+// Handle_Manager64CreateFile. The file is extended (sparse) to the requested
+// size so untouched regions take no disk or memory and the OS pages the rest
+// on demand. POSIX only, elsewhere Open fails.
+typedef enum Handle_FileAdvice {
+	Handle_FileAdviceNormal = 0,
+	Handle_FileAdviceSequential,
+	Handle_FileAdviceRandom,
+	// start reading it in now
+	Handle_FileAdviceWillNeed,
+	// drop the resident pages, the data stays in the file
+	Handle_FileAdviceDontNeed,
+} Handle_FileAdvice;
+
+typedef struct Handle_FileMap {
+	uint8_t *base;
+	size_t size;
+	int fd;
+	// the file was new (or empty) when opened
+	bool created;
+} Handle_FileMap;
+
+// maps path, creating or growing it to size bytes
+AL2O3_EXTERN_C Handle_FileMap *Handle_FileMapOpen(char const *path, size_t size);
+AL2O3_EXTERN_C void Handle_FileMapClose(Handle_FileMap *map);
+
+// writes dirty pages in the range back to the file, sync waits for it to complete
+AL2O3_EXTERN_C bool Handle_FileMapFlush(Handle_FileMap *map, size_t offset, size_t size, bool sync);
+AL2O3_EXTERN_C void Handle_FileMapAdvise(Handle_FileMap *map, size_t offset, size_t size, Handle_FileAdvice advice);
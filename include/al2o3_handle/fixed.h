@@ -2,6 +2,7 @@
 #pragma once
 
 #include "al2o3_thread/atomic.h"
+#include "al2o3_handle/initpolicy.h"
 // A 32 bit handle can access 16.7 million objects and 256 generations per handle
 typedef uint32_t Handle_FixedHandle32;
 #define Handle_MaxFixedHandles32 0x00FFFFFF
@@ -19,13 +20,38 @@ typedef struct Handle_FixedManager32 {
 	// if any release or allocs have occured the transaction will detect and reverse
 	Thread_Atomic64_t freeListHeads;
 
+	// how Alloc prepares elements
+	Handle_ElementInit init;
+
+	// only ownerThread uses it and the free lists are plain loads and stores
+	bool singleThreaded;
+	uint64_t ownerThread;
+
+	// high water mark, indices from resetCursor up to resetLimit haven't been
+	// handed out since creation (or the last Reset) and are bumped out in order
+	// before the free list, which only ever holds released indices
+	Thread_Atomic32_t resetCursor;
+	uint32_t resetLimit;
+
 } Handle_FixedManager32;
 
 AL2O3_EXTERN_C Handle_FixedManager32* Handle_FixedManager32Create(uint32_t elementSize, uint32_t totalHandleCount);
+// only the calling thread may use it (asserted in debug builds), nothing on the alloc or release path is atomic
+AL2O3_EXTERN_C Handle_FixedManager32* Handle_FixedManager32CreateSingleThreaded(uint32_t elementSize, uint32_t totalHandleCount);
+// hands a single threaded manager to the calling thread, the old owner must have stopped using it
+AL2O3_EXTERN_C void Handle_FixedManager32SetOwner(Handle_FixedManager32* manager);
 AL2O3_EXTERN_C void Handle_FixedManager32Destroy(Handle_FixedManager32* manager);
 
 AL2O3_EXTERN_C Handle_FixedHandle32 Handle_FixedManager32Alloc(Handle_FixedManager32* manager);
+AL2O3_EXTERN_C uint32_t Handle_FixedManager32AllocBatch(Handle_FixedManager32* manager, Handle_FixedHandle32* handles, uint32_t count);
+AL2O3_EXTERN_C void Handle_FixedManager32SetInitPolicy(Handle_FixedManager32* manager,
+																											 Handle_InitPolicy policy,
+																											 Handle_InitFunc func,
+																											 void* userData);
 AL2O3_EXTERN_C void Handle_FixedManager32Release(Handle_FixedManager32* manager, Handle_FixedHandle32 handle);
+// Invalidates every handle at once with a single pass over the generations,
+// the slots are reissued lazily. Needs exclusive access to the manager
+AL2O3_EXTERN_C void Handle_FixedManager32Reset(Handle_FixedManager32* manager);
 
 AL2O3_FORCE_INLINE bool Handle_FixedManager32IsValid(Handle_FixedManager32* manager, Handle_FixedHandle32 handle) {
 	if(handle == Handle_InvalidFixedHandle32) {
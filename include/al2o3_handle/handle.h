@@ -2,6 +2,15 @@
 #pragma once
 
 #include "al2o3_thread/atomic.h"
+#include "al2o3_handle/numa.h"
+#include "al2o3_handle/blockalloc.h"
+#include "al2o3_handle/filemap.h"
+#include "al2o3_handle/addrindex.h"
+#include "al2o3_handle/initpolicy.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 // A 32 bit handle can access 16.7 million objects and 256 generations per handle
 typedef struct { uint32_t handle; } Handle_Handle32;
@@ -14,6 +23,10 @@ typedef struct { uint64_t handle; } Handle_Handle64;
 #define Handle_GenerationSize32 sizeof(Handle_GenerationType32)
 #define Handle_HandleDistance32(a, b) (((b).handle & Handle_MaxHandles32) - ((a).handle & Handle_MaxHandles32))
 #define Handle_HandleEqual32(a, b) ((a).handle == (b).handle)
+// how far ahead of the last completed frame ReleaseDeferred can be
+#define Handle_MaxDeferredFrames32 8u
+// released range stacks, one per power of 2 length from 2 up to 2^24
+#define Handle_FreeRunBuckets32 24u
 
 #define Handle_MaxHandles64 0x000000FFFFFFFFFFull
 #define Handle_GenerationBitShift64 40ull
@@ -24,12 +37,47 @@ typedef struct { uint64_t handle; } Handle_Handle64;
 #define Handle_HandleDistance64(a, b) (((b).handle & Handle_MaxHandles64) - ((a).handle & Handle_MaxHandles64))
 #define Handle_HandleEqual64(a, b) ((a).handle == (b).handle)
 
+// Handle_Manager64CreateEx flags
+// adds a sequence counter per slot for Begin/EndWrite and ReadConsistent
+#define Handle_Manager64FlagSeqLock 0x1u
+// only the creating thread uses it, the free lists are plain loads and stores
+#define Handle_Manager64FlagSingleThreaded 0x2u
+#define Handle_SequenceType64 uint32_t
+#define Handle_SequenceSize64 sizeof(Handle_SequenceType64)
+
+// a run of count slots from index first
+typedef struct Handle_DirtyRange32 {
+	uint32_t first;
+	uint32_t count;
+} Handle_DirtyRange32;
+
+// the indices released for one pending frame. They are kept out of band as
+// the elements may still be read until the frame completes, AdvanceFrame
+// links them through the elements and splices them back in one go
+typedef struct Handle_DeferredFrame32 {
+	uint32_t *indices;
+	uint32_t count;
+	uint32_t capacity;
+	// the frame the indices belong to, only meaningful while count != 0
+	uint64_t frame;
+	Thread_Atomic32_t lock;
+} Handle_DeferredFrame32;
+
 typedef struct Handle_Manager32 {
 	uint32_t elementSize;
 	uint32_t maxBlocks;
+	// the first block's size when geometric
 	uint32_t handlesPerBlockMask;
 	uint32_t handlesPerBlockShift;
 	uint32_t neverReissueOldHandles : 1;
+	// block k holds (handlesPerBlockMask + 1) << k handles
+	uint32_t geometric : 1;
+	// only ownerThread allocs, see Handle_Manager32CreateOwned
+	uint32_t owned : 1;
+	// owned and ownerThread releases too, see Handle_Manager32CreateSingleThreaded
+	uint32_t singleThreaded : 1;
+	// each block has a dirty bit per slot after the generations
+	uint32_t dirtyTracked : 1;
 
 	// we sometimes want to decrement and other times we need to swap the lists atomically
 	// this kind of dcas isn't supported on any HW we target
@@ -39,10 +87,56 @@ typedef struct Handle_Manager32 {
 	Thread_Atomic64_t freeListHeads;
 
 	// each block includes the data and the generations store
+	// NULL for growable managers which use directory instead
 	Thread_AtomicPtr_t *blocks;
 
+	// growable managers root array of directory pages, each page is the block
+	// pointers for 1 << directoryPageShift blocks followed by their nodes
+	Thread_AtomicPtr_t *directory;
+	uint32_t directoryPageShift;
+
 	Thread_Atomic32_t totalHandlesAllocated;
 
+	// Handle_NumaNodeNone, Handle_NumaNodeLocal or the node every block is placed on
+	int32_t numaNode;
+	// the node each block was placed on (in the directory pages when growable)
+	uint8_t *blockNodes;
+
+	// header, block and directory page memory when not on a specific NUMA node
+	Handle_BlockAllocator allocator;
+
+	// every block's element range, for PtrToHandle
+	Handle_AddressIndex addressIndex;
+
+	// how Alloc prepares elements
+	Handle_ElementInit init;
+
+	// owned managers, the thread id of the owner and a stack of indices released
+	// by other threads (same marker links as the free list, 0 is empty)
+	uint64_t ownerThread;
+	Thread_Atomic32_t remoteFreeHead;
+
+	// the fresh run, the never issued tail of the newest block. Alloc and
+	// AllocRange bump it so new blocks are never linked onto the free list
+	// low 32 bits the next index, high 32 bits the end
+	Thread_Atomic64_t freshRun;
+
+	// ranges released whole, kept whole for AllocRange. Bucket b stacks runs of
+	// 2^(b+1) to 2^(b+2)-1 slots that share a generation, the first slot links to
+	// the next run (same marker links as the free list, 0 is empty) and the second
+	// holds the length. Alloc moves them to the free list before making a new block
+	Thread_Atomic32_t freeRunHeads[Handle_FreeRunBuckets32];
+
+	// after a Reset the free list is empty and indices below resetLimit are
+	// handed out in order by bumping resetCursor, before any new block is made
+	Thread_Atomic32_t resetCursor;
+	uint32_t resetLimit;
+
+	// frame delayed release, the oldest frame not yet completed
+	Thread_Atomic64_t pendingFrame;
+	// retired indices per frame (frame % Handle_MaxDeferredFrames32)
+	Handle_DeferredFrame32 deferredFrames[Handle_MaxDeferredFrames32];
+
 } Handle_Manager32;
 
 typedef struct Handle_Manager64 {
@@ -52,6 +146,10 @@ typedef struct Handle_Manager64 {
 	uint32_t handlesPerBlockShift;
 
 	uint32_t neverReissueOldHandles : 1;
+	// each block has a sequence counter per slot after the generations
+	uint32_t seqLocked : 1;
+	// Handle_Manager64FlagSingleThreaded, only ownerThread may use it
+	uint32_t singleThreaded : 1;
 
 	// we sometimes want to decrement and other times we need to swap the lists atomically
 	// this kind of dcas isn't supported on any HW we target
@@ -60,35 +158,322 @@ typedef struct Handle_Manager64 {
 	// if any release or allocs have occured the transaction will detect and reverse
 	Thread_Atomic128_t freeListHeads;
 
+	// the fresh run, 1 + the next never issued index of the newest block, 0 when
+	// it is used up. The run ends with the block so new blocks are never linked
+	Thread_Atomic64_t freshRun;
+
 	// each block includes the data and the generations store
 	Thread_AtomicPtr_t *blocks;
 
 	Thread_Atomic64_t totalHandlesAllocated;
 
+	// Handle_NumaNodeNone, Handle_NumaNodeLocal or the node every block is placed on
+	int32_t numaNode;
+	// the node each block was placed on
+	uint8_t *blockNodes;
+
+	// header and block memory when not on a specific NUMA node or in a file
+	Handle_BlockAllocator allocator;
+
+	// non NULL when the manager and its blocks live in a mapped file
+	Handle_FileMap *fileMap;
+
+	// every block's element range for PtrToHandle, unused when file backed as
+	// the blocks are at fixed offsets in the one mapping
+	Handle_AddressIndex addressIndex;
+
+	// single threaded managers, checked in debug builds
+	uint64_t ownerThread;
+
+	// how Alloc prepares elements
+	Handle_ElementInit init;
+
+	// after a Reset the free list is empty and indices below resetLimit are
+	// handed out in order by bumping resetCursor, before any new block is made
+	Thread_Atomic64_t resetCursor;
+	uint64_t resetLimit;
+
 } Handle_Manager64;
 
 AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32Create(uint32_t elementSize,
 																												uint32_t allocationBlockSize,
 																												uint32_t maxBlocks,
 																												bool neverReissueOldHandles);
+// numaNode is a node index, Handle_NumaNodeLocal or Handle_NumaNodeNone (same as Create)
+// on single node machines this is the same as Handle_Manager32Create
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateNuma(uint32_t elementSize,
+																														uint32_t allocationBlockSize,
+																														uint32_t maxBlocks,
+																														bool neverReissueOldHandles,
+																														int32_t numaNode);
+// header and blocks come from allocator (copied, so only the context needs to outlive the manager)
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateWithAllocator(uint32_t elementSize,
+																																		 uint32_t allocationBlockSize,
+																																		 uint32_t maxBlocks,
+																																		 bool neverReissueOldHandles,
+																																		 Handle_BlockAllocator const *allocator);
+// Blocks double in size, the first holds firstBlockSize handles and block k
+// firstBlockSize << k, so small pools stay small and big ones grow in a few steps
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateGeometric(uint32_t elementSize,
+																																 uint32_t firstBlockSize,
+																																 uint32_t maxBlocks,
+																																 bool neverReissueOldHandles);
+// No maxBlocks, block pointers live in a two level directory whose pages are
+// allocated as the manager grows so it can reach the full index range
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateGrowable(uint32_t elementSize,
+																																uint32_t allocationBlockSize,
+																																bool neverReissueOldHandles);
+// Only the calling (owner) thread may alloc and its releases update the free
+// lists with plain loads and stores. Releases from any other thread are pushed
+// onto a lock-free remote stack that the owner takes in one go when it runs out
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateOwned(uint32_t elementSize,
+																														 uint32_t allocationBlockSize,
+																														 uint32_t maxBlocks,
+																														 bool neverReissueOldHandles);
+// Each block keeps a dirty bit per slot, set by Alloc, Release, Reset and
+// MarkDirty, so checkpoints and replicas can copy just what has changed
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateTracked(uint32_t elementSize,
+																															 uint32_t allocationBlockSize,
+																															 uint32_t maxBlocks,
+																															 bool neverReissueOldHandles);
+// Owned where the owner thread is also the only one to release, so there is no
+// remote stack and nothing on the alloc or release path is atomic. Same handles
+// and lookups as any other manager, use from another thread asserts in debug builds
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateSingleThreaded(uint32_t elementSize,
+																																			uint32_t allocationBlockSize,
+																																			uint32_t maxBlocks,
+																																			bool neverReissueOldHandles);
+// hands an owned (or single threaded) manager to the calling thread, the old
+// owner must have stopped using it
+AL2O3_EXTERN_C void Handle_Manager32SetOwner(Handle_Manager32 *manager);
 AL2O3_EXTERN_C void Handle_Manager32Destroy(Handle_Manager32 *manager);
 AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32Clone(Handle_Manager32 *src);
 
 AL2O3_EXTERN_C Handle_Handle32 Handle_Manager32Alloc(Handle_Manager32 *manager);
+// allocs up to count handles, initialising runs of adjacent elements in one pass
+// returns how many were allocated (less than count if the manager ran out)
+AL2O3_EXTERN_C uint32_t Handle_Manager32AllocBatch(Handle_Manager32 *manager, Handle_Handle32 *handles, uint32_t count);
+// func and userData are only used by Handle_InitPolicyCallback
+AL2O3_EXTERN_C void Handle_Manager32SetInitPolicy(Handle_Manager32 *manager,
+																									Handle_InitPolicy policy,
+																									Handle_InitFunc func,
+																									void *userData);
 AL2O3_EXTERN_C void Handle_Manager32Release(Handle_Manager32 *manager, Handle_Handle32 handle);
 
+// Allocs count handles with consecutive indices in one block so their elements
+// are contiguous from HandleToPtr(firstHandle). Element i's handle is
+// Handle_Manager32RangeHandle(firstHandle, i) and is checked on its own like
+// any other. Ranges are cut from the fresh run, then from ranges released
+// whole, then (after a Reset) from the indices not yet reissued, before a new
+// block is made. Single slots on the free list are never used.
+// Returns false if count is more than a block holds or the manager is full
+AL2O3_EXTERN_C bool Handle_Manager32AllocRange(Handle_Manager32 *manager, uint32_t count, Handle_Handle32 *firstHandle);
+// releases count handles from firstHandle on, all must still be valid. If they
+// still share a generation the run is kept whole for the next AllocRange
+AL2O3_EXTERN_C void Handle_Manager32ReleaseRange(Handle_Manager32 *manager, Handle_Handle32 firstHandle, uint32_t count);
+
+// the elements of a range are fresh when alloced so share a generation
+AL2O3_FORCE_INLINE Handle_Handle32 Handle_Manager32RangeHandle(Handle_Handle32 firstHandle, uint32_t i) {
+	Handle_Handle32 handle = {firstHandle.handle + i};
+	return handle;
+}
+
+// Release split in two for deferred reuse. Retire invalidates the handle straight
+// away (bumps the generation) but leaves the memory alone, Recycle later puts the
+// index back on the free list (overwriting the start of the element).
+// Release is Retire followed immediately by Recycle
+AL2O3_EXTERN_C void Handle_Manager32Retire(Handle_Manager32 *manager, Handle_Handle32 handle);
+AL2O3_EXTERN_C void Handle_Manager32Recycle(Handle_Manager32 *manager, uint32_t index);
+
+// Frame delayed release. The handle is invalid immediately but the index only
+// goes back on the free list once AdvanceFrame reports frame as completed, all
+// indices released for a frame are spliced back with a single CAS.
+// The element is left untouched until then, so it can still be read (e.g. by
+// the GPU) while the frame is in flight.
+// A frame that has already completed is released immediately. Returns false,
+// leaving the handle valid, if frame is Handle_MaxDeferredFrames32 or more past
+// the oldest pending frame or if out of memory
+AL2O3_EXTERN_C bool Handle_Manager32ReleaseDeferred(Handle_Manager32 *manager, Handle_Handle32 handle, uint64_t frame);
+// every frame up to and including completedFrame is done with its handles
+AL2O3_EXTERN_C void Handle_Manager32AdvanceFrame(Handle_Manager32 *manager, uint64_t completedFrame);
+
+// Reverse lookup for pointers handed back by callbacks, so elements needn't
+// store their own handle. The block is found in a sorted index of block
+// addresses, the slot from the offset and the generation is the current one.
+// Any address inside an element maps to it. ptr must point at a live element
+// (a 32 bit slot doesn't know if it is free), invalid if it is in no block
+AL2O3_EXTERN_C Handle_Handle32 Handle_Manager32PtrToHandle(Handle_Manager32 *manager, void const *ptr);
+
+// number of blocks currently placed on a NUMA node
+AL2O3_EXTERN_C uint32_t Handle_Manager32NumaBlockCount(Handle_Manager32 *manager, uint32_t node);
+
+// Dirty tracking, the manager must be created with Handle_Manager32CreateTracked.
+// MarkDirty records a write to the element by the user.
+// CollectDirty fills ranges with runs of dirty slots from startIndex on (never
+// spanning blocks) and returns how many, a full array means there may be more
+// after the last one. ClearDirty should be called before the elements are copied
+// so writes during the copy show up next time.
+AL2O3_EXTERN_C void Handle_Manager32MarkDirty(Handle_Manager32 *manager, Handle_Handle32 handle);
+AL2O3_EXTERN_C uint32_t Handle_Manager32CollectDirty(Handle_Manager32 *manager,
+																										 uint32_t startIndex,
+																										 Handle_DirtyRange32 *ranges,
+																										 uint32_t maxRanges);
+AL2O3_EXTERN_C void Handle_Manager32ClearDirty(Handle_Manager32 *manager,
+																							 Handle_DirtyRange32 const *ranges,
+																							 uint32_t rangeCount);
+// Writes the free list state and the generations and elements of the ranges to
+// dst. Returns the bytes needed, dst is only written if dstSize is big enough
+AL2O3_EXTERN_C size_t Handle_Manager32SerialiseDelta(Handle_Manager32 *manager,
+																										 Handle_DirtyRange32 const *ranges,
+																										 uint32_t rangeCount,
+																										 void *dst,
+																										 size_t dstSize);
+// applies a delta to a replica made with the same element and block size,
+// growing it as needed. Needs exclusive access to the replica
+AL2O3_EXTERN_C bool Handle_Manager32ApplyDelta(Handle_Manager32 *manager, void const *src, size_t size);
+
+// Invalidates every handle at once with a single pass over each block's
+// generations, no free list walking. The slots are reissued lazily as later
+// allocs work back up through them (never reissue managers skip the lost ones).
+// Needs exclusive access, nothing else may use the manager during the Reset
+AL2O3_EXTERN_C void Handle_Manager32Reset(Handle_Manager32 *manager);
+
 AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64Create(uint32_t elementSize,
 																												uint32_t allocationBlockSize,
 																												uint32_t maxBlocks,
 																												bool neverReissueOldHandles);
+AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64CreateNuma(uint32_t elementSize,
+																														uint32_t allocationBlockSize,
+																														uint32_t maxBlocks,
+																														bool neverReissueOldHandles,
+																														int32_t numaNode);
+// flags are a combination of Handle_Manager64Flag*
+AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64CreateEx(uint32_t elementSize,
+																													uint32_t allocationBlockSize,
+																													uint32_t maxBlocks,
+																													bool neverReissueOldHandles,
+																													int32_t numaNode,
+																													uint32_t flags);
+// header and blocks come from allocator (copied, so only the context needs to outlive the manager)
+AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64CreateWithAllocator(uint32_t elementSize,
+																																		 uint32_t allocationBlockSize,
+																																		 uint32_t maxBlocks,
+																																		 bool neverReissueOldHandles,
+																																		 uint32_t flags,
+																																		 Handle_BlockAllocator const *allocator);
+// The manager and all its blocks live in a memory mapped file sized for maxBlocks
+// (sparse), the OS pages elements in and out on demand so pools can exceed RAM.
+// If path already holds a manager created with the same parameters it is
+// remapped with every handle intact. Destroy flushes and unmaps it.
+AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64CreateFile(char const *path,
+																														uint32_t elementSize,
+																														uint32_t allocationBlockSize,
+																														uint32_t maxBlocks,
+																														bool neverReissueOldHandles,
+																														uint32_t flags);
+// hands a single threaded manager to the calling thread, the old owner must have stopped using it
+AL2O3_EXTERN_C void Handle_Manager64SetOwner(Handle_Manager64 *manager);
 AL2O3_EXTERN_C void Handle_Manager64Destroy(Handle_Manager64 *manager);
 AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64Clone(Handle_Manager64 *src);
 
 AL2O3_EXTERN_C Handle_Handle64 Handle_Manager64Alloc(Handle_Manager64 *manager);
+AL2O3_EXTERN_C uint64_t Handle_Manager64AllocBatch(Handle_Manager64 *manager, Handle_Handle64 *handles, uint64_t count);
+AL2O3_EXTERN_C void Handle_Manager64SetInitPolicy(Handle_Manager64 *manager,
+																									Handle_InitPolicy policy,
+																									Handle_InitFunc func,
+																									void *userData);
 AL2O3_EXTERN_C void Handle_Manager64Release(Handle_Manager64 *manager, Handle_Handle64 handle);
 
+// as Handle_Manager32PtrToHandle but a released slot gives an invalid handle,
+// file backed managers compute the block from the offset into the file
+AL2O3_EXTERN_C Handle_Handle64 Handle_Manager64PtrToHandle(Handle_Manager64 *manager, void const *ptr);
+
+AL2O3_EXTERN_C uint64_t Handle_Manager64NumaBlockCount(Handle_Manager64 *manager, uint32_t node);
+
+// same as Handle_Manager32Reset, leaked slots stay leaked
+AL2O3_EXTERN_C void Handle_Manager64Reset(Handle_Manager64 *manager);
+
+// file backed managers only, writes dirty elements back to the file (sync waits)
+AL2O3_EXTERN_C bool Handle_Manager64FileFlush(Handle_Manager64 *manager, bool sync);
+// access pattern hint for the whole file
+AL2O3_EXTERN_C void Handle_Manager64FileAdvise(Handle_Manager64 *manager, Handle_FileAdvice advice);
+
+// Seqlock access, the manager must be created with Handle_Manager64FlagSeqLock.
+// One writer per handle brackets its changes with BeginWrite/EndWrite, readers
+// use ReadConsistent which copies the element out and retries if it saw a torn write.
+// Returns false if the handle is invalid (or is released during the read)
+AL2O3_EXTERN_C bool Handle_Manager64ReadConsistent(Handle_Manager64 *manager,
+																									 Handle_Handle64 handle,
+																									 void *dst,
+																									 size_t size);
+
+AL2O3_FORCE_INLINE uint32_t Handle_CountLeadingZeros32(uint32_t value) {
+	ASSERT(value != 0);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse(&index, value);
+	return 31u - (uint32_t) index;
+#else
+	return (uint32_t) __builtin_clz(value);
+#endif
+}
+
+// Lookups. The plain IsValid/HandleToPtr are the fast path for managers from
+// Create (and the other fixed block size creates bar Growable), they are just
+// shift, mask and load. Geometric and growable managers have their own, Any
+// works on every manager by branching on its layout, which containers use
+
+// geometric block k starts at base * (2^k - 1) so adding base to the index
+// leaves the block in the top set bit and the slot below it, returns the
+// block's handle count
+AL2O3_FORCE_INLINE uint32_t Handle_Manager32LocateGeometric(Handle_Manager32 const *manager,
+																														uint32_t actualIndex,
+																														uint32_t *blockIndex,
+																														uint32_t *slot) {
+	ASSERT(manager->geometric);
+	uint32_t const biased = actualIndex + manager->handlesPerBlockMask + 1;
+	uint32_t const topBit = 31u - Handle_CountLeadingZeros32(biased);
+	*blockIndex = topBit - manager->handlesPerBlockShift;
+	*slot = biased ^ (1u << topBit);
+	return 1u << topBit;
+}
+
+// splits an index into its block and the slot within that block for any
+// manager, returns the block's handle count
+AL2O3_FORCE_INLINE uint32_t Handle_Manager32Locate(Handle_Manager32 const *manager,
+																									 uint32_t actualIndex,
+																									 uint32_t *blockIndex,
+																									 uint32_t *slot) {
+	if (manager->geometric) {
+		return Handle_Manager32LocateGeometric(manager, actualIndex, blockIndex, slot);
+	}
+	*blockIndex = actualIndex >> manager->handlesPerBlockShift;
+	*slot = actualIndex & manager->handlesPerBlockMask;
+	return manager->handlesPerBlockMask + 1;
+}
+
+// base of a growable manager's block, NULL if it hasn't been allocated
+AL2O3_FORCE_INLINE uint8_t *Handle_Manager32BlockBaseGrowable(Handle_Manager32 *manager, uint32_t blockIndex) {
+	ASSERT(manager->directory);
+	Thread_AtomicPtr_t *page =
+			(Thread_AtomicPtr_t *) Thread_AtomicLoadPtrRelaxed(&manager->directory[blockIndex >> manager->directoryPageShift]);
+	if (!page) {
+		return NULL;
+	}
+	return (uint8_t *) Thread_AtomicLoadPtrRelaxed(&page[blockIndex & ((1u << manager->directoryPageShift) - 1u)]);
+}
+
+// base of a block's memory for any manager, NULL if it hasn't been allocated
+AL2O3_FORCE_INLINE uint8_t *Handle_Manager32BlockBase(Handle_Manager32 *manager, uint32_t blockIndex) {
+	if (manager->directory) {
+		return Handle_Manager32BlockBaseGrowable(manager, blockIndex);
+	}
+	return (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex]);
+}
+
 AL2O3_FORCE_INLINE bool Handle_Manager32IsValid(Handle_Manager32 *manager,
 																								Handle_Handle32 handle) {
+	ASSERT(!manager->geometric && !manager->directory);
 	if (handle.handle == 0) {
 		return false;
 	}
@@ -128,10 +513,103 @@ AL2O3_FORCE_INLINE void *Handle_Manager32HandleToPtr(Handle_Manager32 *manager,
 	return (void *) (base + (index * manager->elementSize));
 }
 
+// the element for a valid handle, NULL otherwise. Shared by the layout
+// specific HandleToPtrs which do one lookup for both check and pointer
+AL2O3_FORCE_INLINE void *Handle_Manager32SlotToPtr(Handle_Manager32 const *manager,
+																									 Handle_Handle32 handle,
+																									 uint8_t *base,
+																									 uint32_t blockHandles,
+																									 uint32_t index) {
+	ASSERT(base);
+	Handle_GenerationType32 const *gen = base + (blockHandles * manager->elementSize) + (index * Handle_GenerationSize32);
+	if ((handle.handle >> Handle_GenerationBitShift32) != *gen) {
+		LOGERROR("Handle being converted to pointer is not valid!");
+		return NULL;
+	}
+	return (void *) (base + (index * manager->elementSize));
+}
+
+AL2O3_FORCE_INLINE bool Handle_Manager32IsValidGeometric(Handle_Manager32 *manager,
+																												 Handle_Handle32 handle) {
+	if (handle.handle == 0) {
+		return false;
+	}
+	uint32_t blockIndex;
+	uint32_t index;
+	uint32_t const blockHandles =
+			Handle_Manager32LocateGeometric(manager, handle.handle & Handle_MaxHandles32, &blockIndex, &index);
+	uint8_t const *base = (uint8_t const *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex]);
+	ASSERT(base);
+	return (handle.handle >> Handle_GenerationBitShift32) == base[(blockHandles * manager->elementSize) + index];
+}
+
+AL2O3_FORCE_INLINE void *Handle_Manager32HandleToPtrGeometric(Handle_Manager32 *manager,
+																															Handle_Handle32 handle) {
+	if (handle.handle == 0) {
+		return NULL;
+	}
+	uint32_t blockIndex;
+	uint32_t index;
+	uint32_t const blockHandles =
+			Handle_Manager32LocateGeometric(manager, handle.handle & Handle_MaxHandles32, &blockIndex, &index);
+	uint8_t *base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex]);
+	return Handle_Manager32SlotToPtr(manager, handle, base, blockHandles, index);
+}
+
+AL2O3_FORCE_INLINE bool Handle_Manager32IsValidGrowable(Handle_Manager32 *manager,
+																												Handle_Handle32 handle) {
+	if (handle.handle == 0) {
+		return false;
+	}
+	uint32_t const actualIndex = (handle.handle & Handle_MaxHandles32);
+	uint32_t const index = actualIndex & manager->handlesPerBlockMask;
+	uint8_t const *base = Handle_Manager32BlockBaseGrowable(manager, actualIndex >> manager->handlesPerBlockShift);
+	ASSERT(base);
+	return (handle.handle >> Handle_GenerationBitShift32) ==
+			base[((manager->handlesPerBlockMask + 1) * manager->elementSize) + index];
+}
+
+AL2O3_FORCE_INLINE void *Handle_Manager32HandleToPtrGrowable(Handle_Manager32 *manager,
+																														 Handle_Handle32 handle) {
+	if (handle.handle == 0) {
+		return NULL;
+	}
+	uint32_t const actualIndex = (handle.handle & Handle_MaxHandles32);
+	uint8_t *base = Handle_Manager32BlockBaseGrowable(manager, actualIndex >> manager->handlesPerBlockShift);
+	return Handle_Manager32SlotToPtr(manager,
+																	 handle,
+																	 base,
+																	 manager->handlesPerBlockMask + 1,
+																	 actualIndex & manager->handlesPerBlockMask);
+}
+
+AL2O3_FORCE_INLINE bool Handle_Manager32IsValidAny(Handle_Manager32 *manager, Handle_Handle32 handle) {
+	if (manager->geometric) {
+		return Handle_Manager32IsValidGeometric(manager, handle);
+	}
+	if (manager->directory) {
+		return Handle_Manager32IsValidGrowable(manager, handle);
+	}
+	return Handle_Manager32IsValid(manager, handle);
+}
+
+AL2O3_FORCE_INLINE void *Handle_Manager32HandleToPtrAny(Handle_Manager32 *manager, Handle_Handle32 handle) {
+	if (manager->geometric) {
+		return Handle_Manager32HandleToPtrGeometric(manager, handle);
+	}
+	if (manager->directory) {
+		return Handle_Manager32HandleToPtrGrowable(manager, handle);
+	}
+	return Handle_Manager32HandleToPtr(manager, handle);
+}
+
 #define HANDLE_MANAGER64_GETBASE_CONST(manager, blockIndex ) (uint8_t const * const ) Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex]); ASSERT(base)
 #define HANDLE_MANAGER64_GETGEN_CONST(manager, base, index) (Handle_GenerationType64 const * const) (base + \
 																						((manager->handlesPerBlockMask + 1) * manager->elementSize) + \
 																						(index * Handle_GenerationSize64)); ASSERT(index < (manager->handlesPerBlockMask + 1))
+#define HANDLE_MANAGER64_GETSEQ(manager, base, index) (Thread_Atomic32_t *) (base + \
+																						((manager->handlesPerBlockMask + 1) * (manager->elementSize + Handle_GenerationSize64)) + \
+																						(index * Handle_SequenceSize64)); ASSERT(manager->seqLocked)
 #define HANDLE_MANAGER64_MAKEHANDLE(gen, actualIndex) { ((uint64_t)(*gen & 0x00FFFFFFu)) << Handle_GenerationBitShift64 | actualIndex }
 
 AL2O3_FORCE_INLINE bool Handle_Manager64IsValid(Handle_Manager64 *manager,
@@ -190,4 +668,35 @@ AL2O3_FORCE_INLINE Handle_Handle64 Handle_Manager64IndexToHandle(Handle_Manager6
 		Handle_Handle64 invalid = {0};
 		return invalid;
 	}
-}
\ No newline at end of file
+}
+
+AL2O3_FORCE_INLINE Thread_Atomic32_t *Handle_Manager64HandleToSequence(Handle_Manager64 *manager,
+																																			 Handle_Handle64 handle) {
+	uint64_t const actualIndex = (handle.handle & Handle_MaxHandles64);
+	uint64_t const blockIndex = actualIndex >> manager->handlesPerBlockShift;
+	uint64_t const index = actualIndex & manager->handlesPerBlockMask;
+
+	uint8_t const * const base = HANDLE_MANAGER64_GETBASE_CONST(manager, blockIndex);
+	Thread_Atomic32_t * const seq = HANDLE_MANAGER64_GETSEQ(manager, base, index);
+	return seq;
+}
+
+// the sequence is odd whilst a write is in progress
+AL2O3_FORCE_INLINE void Handle_Manager64BeginWrite(Handle_Manager64 *manager, Handle_Handle64 handle) {
+	ASSERT(Handle_Manager64IsValid(manager, handle));
+	Thread_Atomic32_t *seq = Handle_Manager64HandleToSequence(manager, handle);
+	uint32_t const value = Thread_AtomicLoad32Relaxed(seq);
+	ASSERT((value & 0x1u) == 0);
+	Thread_AtomicStore32Relaxed(seq, value + 1);
+	// the odd sequence must be visible before any of the element writes
+	Thread_AtomicThreadFenceRelease();
+}
+
+AL2O3_FORCE_INLINE void Handle_Manager64EndWrite(Handle_Manager64 *manager, Handle_Handle64 handle) {
+	Thread_Atomic32_t *seq = Handle_Manager64HandleToSequence(manager, handle);
+	uint32_t const value = Thread_AtomicLoad32Relaxed(seq);
+	ASSERT(value & 0x1u);
+	// element writes must complete before the sequence goes even again
+	Thread_AtomicThreadFenceRelease();
+	Thread_AtomicStore32Relaxed(seq, value + 1);
+}
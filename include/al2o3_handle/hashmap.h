@@ -0,0 +1,50 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_handle/handle.h"
+
+// A flat open addressing hash map for attaching side data to handles owned by
+// another manager. The key is the handle itself, its index bits are used
+// directly as the hash (manager indices are dense so no mixing is needed).
+// Control bytes are probed 16 at a time (SSE2 when available).
+// As a manager only ever has one live generation per index, an entry whose
+// generation differs from the key being inserted is dead and is simply reused,
+// Purge can be called to lazily drop keys the owning manager has released.
+// A map should be keyed with either 32 or 64 bit handles, not both.
+// The hash map is NOT thread safe.
+#define Handle_HashMapGroupWidth 16
+
+typedef struct Handle_HashMap {
+	uint32_t valueSize;
+	uint32_t entrySize;
+	uint64_t capacity;
+	uint32_t capacityShift;
+	uint64_t count;
+	uint64_t tombstones;
+
+	// one control byte per entry, empty, deleted or 7 bits of the key
+	uint8_t *ctrl;
+	// each entry is the full handle (64 bit for both 32 and 64 bit) then the value
+	uint8_t *entries;
+} Handle_HashMap;
+
+AL2O3_EXTERN_C Handle_HashMap *Handle_HashMapCreate(uint32_t valueSize, uint64_t initialCapacity);
+AL2O3_EXTERN_C void Handle_HashMapDestroy(Handle_HashMap *map);
+
+// returns pointer to the value for this key, a new (or replaced stale) value is zeroed
+// pointers are invalidated by the next insert
+AL2O3_EXTERN_C void *Handle_HashMapInsert32(Handle_HashMap *map, Handle_Handle32 key);
+// returns NULL if the key isn't in the map (including stale generations)
+AL2O3_EXTERN_C void *Handle_HashMapLookup32(Handle_HashMap *map, Handle_Handle32 key);
+AL2O3_EXTERN_C bool Handle_HashMapRemove32(Handle_HashMap *map, Handle_Handle32 key);
+// removes every key no longer valid in the manager, returns how many were removed
+AL2O3_EXTERN_C uint64_t Handle_HashMapPurge32(Handle_HashMap *map, Handle_Manager32 *manager);
+
+AL2O3_EXTERN_C void *Handle_HashMapInsert64(Handle_HashMap *map, Handle_Handle64 key);
+AL2O3_EXTERN_C void *Handle_HashMapLookup64(Handle_HashMap *map, Handle_Handle64 key);
+AL2O3_EXTERN_C bool Handle_HashMapRemove64(Handle_HashMap *map, Handle_Handle64 key);
+AL2O3_EXTERN_C uint64_t Handle_HashMapPurge64(Handle_HashMap *map, Handle_Manager64 *manager);
+
+AL2O3_FORCE_INLINE uint64_t Handle_HashMapCount(Handle_HashMap const *map) {
+	return map->count;
+}
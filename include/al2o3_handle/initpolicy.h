@@ -0,0 +1,47 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_platform/platform.h"
+
+// How the managers prepare an element on Alloc, set per manager.
+typedef enum Handle_InitPolicy {
+	// memset to 0, the default
+	Handle_InitPolicyZero = 0,
+	// left as is, including the free list link in the first 4 or 8 bytes
+	Handle_InitPolicyNone,
+	// the user callback does it
+	Handle_InitPolicyCallback,
+	// zero with non temporal stores, so big elements about to be overwritten
+	// don't evict everything else from the cache (memset where unsupported)
+	Handle_InitPolicyStreamZero,
+} Handle_InitPolicy;
+
+typedef void (*Handle_InitFunc)(void *userData, void *element, size_t elementSize);
+
+typedef struct Handle_ElementInit {
+	Handle_InitPolicy policy;
+	Handle_InitFunc func;
+	void *userData;
+} Handle_ElementInit;
+
+AL2O3_EXTERN_C void Handle_InitElementsSlow(Handle_ElementInit const *init, void *elements, size_t elementSize, uint32_t count);
+AL2O3_EXTERN_C void Handle_InitStreamFence(void);
+
+// initialises count elements laid out back to back
+AL2O3_FORCE_INLINE void Handle_InitElements(Handle_ElementInit const *init,
+																						void *elements,
+																						size_t elementSize,
+																						uint32_t count) {
+	if (init->policy == Handle_InitPolicyZero) {
+		memset(elements, 0x0, elementSize * count);
+	} else {
+		Handle_InitElementsSlow(init, elements, elementSize, count);
+	}
+}
+
+// non temporal stores need a fence before another thread can see them
+AL2O3_FORCE_INLINE void Handle_InitFence(Handle_ElementInit const *init) {
+	if (init->policy == Handle_InitPolicyStreamZero) {
+		Handle_InitStreamFence();
+	}
+}
@@ -0,0 +1,100 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_handle/handle.h"
+#include "al2o3_handle/sizeclass.h"
+
+// Interns strings and blobs as 4 byte generational handles. Equal content
+// always gets the same handle while it is interned and a released handle
+// fails IsValid instead of resolving to someone else's bytes.
+// Each blob has an entry in a Handle_Manager32, so Resolve is a plain handle
+// lookup. Blobs up to Handle_InternInlineSize bytes are kept in the entry
+// itself, bigger ones in a size class allocator (pooled blocks per power of 2).
+// The content index is a chained hash split into cache line padded stripes,
+// each with its own spin lock and bucket array that doubles independently, so
+// Intern and Find from different threads rarely touch the same lock.
+// Resolve takes no lock. Release removes the content for everyone who
+// interned it, callers that share a table must agree on when that happens.
+#define Handle_InternInlineSize 16u
+#define Handle_InternMaxStripes 256u
+#define Handle_InternCacheLineSize 64u
+#define Handle_InternBlobBlockSize (64u * 1024u)
+
+typedef struct Handle_InternEntry32 {
+	uint32_t hash;
+	uint32_t size;
+	// handle of the next entry in the bucket chain, 0 ends it
+	uint32_t next;
+	union {
+		// size > Handle_InternInlineSize
+		Handle_Handle64 blob;
+		uint8_t bytes[Handle_InternInlineSize];
+	} data;
+} Handle_InternEntry32;
+
+typedef struct Handle_InternStripe {
+	// chain heads, a handle or 0
+	uint32_t *buckets;
+	Thread_Atomic32_t lock;
+	uint32_t count;
+	uint32_t bucketMask;
+	uint8_t padding[Handle_InternCacheLineSize - sizeof(uint32_t *) - (3 * sizeof(uint32_t))];
+} Handle_InternStripe;
+
+typedef struct Handle_InternTable {
+	// elements are Handle_InternEntry32
+	Handle_Manager32 *entries;
+	Handle_SizeClassAllocator *blobs;
+
+	uint32_t stripeCount;
+	uint32_t stripeShift;
+	// cache line aligned
+	Handle_InternStripe *stripes;
+} Handle_InternTable;
+
+// stripeCount of 0 uses 4 per core, it is rounded up to a power of 2
+// entriesPerBlock and maxBlocks size the entry manager, the blob classes get
+// the same number of Handle_InternBlobBlockSize blocks
+AL2O3_EXTERN_C Handle_InternTable *Handle_InternTableCreate(uint32_t entriesPerBlock,
+																														uint32_t maxBlocks,
+																														uint32_t stripeCount,
+																														bool neverReissueOldHandles);
+AL2O3_EXTERN_C void Handle_InternTableDestroy(Handle_InternTable *table);
+
+// lookup or insert, returns the handle for this content or an invalid handle
+// if out of handles or memory. Safe to call from any thread
+AL2O3_EXTERN_C Handle_Handle32 Handle_InternTableIntern(Handle_InternTable *table, void const *data, size_t size);
+// lookup only, returns an invalid handle if the content isn't interned
+AL2O3_EXTERN_C Handle_Handle32 Handle_InternTableFind(Handle_InternTable *table, void const *data, size_t size);
+// removes the content, every copy of the handle goes stale. Returns false if it already was
+AL2O3_EXTERN_C bool Handle_InternTableRelease(Handle_InternTable *table, Handle_Handle32 handle);
+// number of interned blobs, only exact when nothing is being interned or released
+AL2O3_EXTERN_C uint32_t Handle_InternTableCount(Handle_InternTable *table);
+
+// the terminating 0 isn't part of the content, resolve gives the bytes without it
+AL2O3_FORCE_INLINE Handle_Handle32 Handle_InternTableInternString(Handle_InternTable *table, char const *str) {
+	return Handle_InternTableIntern(table, str, strlen(str));
+}
+
+AL2O3_FORCE_INLINE bool Handle_InternTableIsValid(Handle_InternTable *table, Handle_Handle32 handle) {
+	return Handle_Manager32IsValid(table->entries, handle);
+}
+
+// O(1), returns the interned bytes and their size or NULL for a stale handle
+// the bytes stay put until the handle is released
+AL2O3_FORCE_INLINE void const *Handle_InternTableResolve(Handle_InternTable *table,
+																												 Handle_Handle32 handle,
+																												 size_t *size) {
+	// stale ids are expected here, so check quietly rather than let HandleToPtr log
+	if (!Handle_Manager32IsValid(table->entries, handle)) {
+		return NULL;
+	}
+	Handle_InternEntry32 const *entry = (Handle_InternEntry32 const *) Handle_Manager32HandleToPtr(table->entries, handle);
+	if (size) {
+		*size = entry->size;
+	}
+	if (entry->size <= Handle_InternInlineSize) {
+		return entry->data.bytes;
+	}
+	return Handle_SizeClassHandleToPtr(table->blobs, entry->data.blob);
+}
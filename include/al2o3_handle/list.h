@@ -0,0 +1,95 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_handle/handle.h"
+
+// Intrusive containers whose links are 32 bit handles stored inside elements of
+// a Handle_Manager32. A link is half the size of a pointer and is generation
+// checked, so a node released without being unlinked shows up as a dangling
+// (invalid) link rather than a pointer to reused memory.
+// The link lives at linkOffset inside each element, containers never allocate
+// and are NOT thread safe. A node can only be in one container per link.
+
+// doubly linked, used by Handle_List32
+typedef struct Handle_ListLink32 {
+	Handle_Handle32 next;
+	Handle_Handle32 prev;
+} Handle_ListLink32;
+
+// singly linked, used by Handle_Queue32
+typedef struct Handle_QueueLink32 {
+	Handle_Handle32 next;
+} Handle_QueueLink32;
+
+// A doubly linked list, Push/Pop at both ends means it is a deque as well
+typedef struct Handle_List32 {
+	Handle_Manager32 *manager;
+	uint32_t linkOffset;
+	uint32_t count;
+	Handle_Handle32 head;
+	Handle_Handle32 tail;
+} Handle_List32;
+
+// A FIFO queue with a single next link per node
+typedef struct Handle_Queue32 {
+	Handle_Manager32 *manager;
+	uint32_t linkOffset;
+	uint32_t count;
+	Handle_Handle32 head;
+	Handle_Handle32 tail;
+} Handle_Queue32;
+
+AL2O3_EXTERN_C void Handle_List32Init(Handle_List32 *list, Handle_Manager32 *manager, uint32_t linkOffset);
+
+AL2O3_EXTERN_C void Handle_List32PushFront(Handle_List32 *list, Handle_Handle32 node);
+AL2O3_EXTERN_C void Handle_List32PushBack(Handle_List32 *list, Handle_Handle32 node);
+// pos must be in the list. Neighbours of pos or node must still be allocated,
+// a node released whilst linked ASSERTs here, Handle_List32Validate checks it
+AL2O3_EXTERN_C void Handle_List32InsertAfter(Handle_List32 *list, Handle_Handle32 pos, Handle_Handle32 node);
+AL2O3_EXTERN_C void Handle_List32InsertBefore(Handle_List32 *list, Handle_Handle32 pos, Handle_Handle32 node);
+// O(1) unlink, node must be in the list
+AL2O3_EXTERN_C void Handle_List32Remove(Handle_List32 *list, Handle_Handle32 node);
+// return the unlinked node or an invalid handle if empty
+AL2O3_EXTERN_C Handle_Handle32 Handle_List32PopFront(Handle_List32 *list);
+AL2O3_EXTERN_C Handle_Handle32 Handle_List32PopBack(Handle_List32 *list);
+
+// returns an invalid handle at the end or if the neighbour was released whilst still linked
+AL2O3_EXTERN_C Handle_Handle32 Handle_List32Next(Handle_List32 const *list, Handle_Handle32 node);
+AL2O3_EXTERN_C Handle_Handle32 Handle_List32Prev(Handle_List32 const *list, Handle_Handle32 node);
+// walks the whole list, false if any link is dangling or inconsistent
+AL2O3_EXTERN_C bool Handle_List32Validate(Handle_List32 const *list);
+
+AL2O3_FORCE_INLINE bool Handle_List32IsEmpty(Handle_List32 const *list) {
+	return list->count == 0;
+}
+
+AL2O3_FORCE_INLINE uint32_t Handle_List32Count(Handle_List32 const *list) {
+	return list->count;
+}
+
+AL2O3_FORCE_INLINE Handle_Handle32 Handle_List32Head(Handle_List32 const *list) {
+	return list->head;
+}
+
+AL2O3_FORCE_INLINE Handle_Handle32 Handle_List32Tail(Handle_List32 const *list) {
+	return list->tail;
+}
+
+AL2O3_EXTERN_C void Handle_Queue32Init(Handle_Queue32 *queue, Handle_Manager32 *manager, uint32_t linkOffset);
+
+AL2O3_EXTERN_C void Handle_Queue32Push(Handle_Queue32 *queue, Handle_Handle32 node);
+// returns an invalid handle if empty. If the next node was released whilst
+// queued the queue is truncated (emptied) after returning the head
+AL2O3_EXTERN_C Handle_Handle32 Handle_Queue32Pop(Handle_Queue32 *queue);
+
+AL2O3_FORCE_INLINE bool Handle_Queue32IsEmpty(Handle_Queue32 const *queue) {
+	return queue->count == 0;
+}
+
+AL2O3_FORCE_INLINE uint32_t Handle_Queue32Count(Handle_Queue32 const *queue) {
+	return queue->count;
+}
+
+AL2O3_FORCE_INLINE Handle_Handle32 Handle_Queue32Peek(Handle_Queue32 const *queue) {
+	return queue->head;
+}
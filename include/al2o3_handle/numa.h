@@ -0,0 +1,28 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_platform/platform.h"
+
+// NUMA placement for manager blocks. On Linux blocks are mmap'ed and bound to
+// a preferred node via mbind, elsewhere (or on single node machines) it falls
+// back to the normal allocator so behaviour is unchanged.
+
+// blocks come from the normal allocator, which is the default
+#define Handle_NumaNodeNone (-1)
+// each block is placed on the node of the thread that grows the manager
+#define Handle_NumaNodeLocal (-2)
+
+#define Handle_NumaMaxNodes 64
+// what NumaBlockCount reports blocks from the normal allocator under, they
+// weren't placed so first touch decides
+#define Handle_NumaBlockNodeNone 0xFFu
+
+AL2O3_EXTERN_C uint32_t Handle_NumaNodeCount(void);
+AL2O3_EXTERN_C uint32_t Handle_NumaCurrentNode(void);
+
+// resolves Handle_NumaNodeLocal to the calling threads node
+AL2O3_EXTERN_C uint32_t Handle_NumaResolveNode(int32_t numaNode);
+
+// returns zero'ed memory placed on node, must be freed with Handle_NumaFree
+AL2O3_EXTERN_C void *Handle_NumaAlloc(size_t size, uint32_t node);
+AL2O3_EXTERN_C void Handle_NumaFree(void *ptr, size_t size);
@@ -0,0 +1,81 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_handle/handle.h"
+
+// A Handle_Manager64 variant whose free and deferred heads are packed into a
+// single 64 bit word, so alloc and release use a 64 bit CAS instead of the
+// slower 128 bit one (and the manager doesn't need 16 byte alignment).
+// Handles keep the 40 bit index / 24 bit generation format and the same block
+// layout as Handle_Manager64, the trade off is each head is 32 bits. A link is
+// the index + 1 in the low 24 bits tagged with the low 8 bits of the slot's
+// generation, so a pop whose slot was taken and released in between fails its
+// CAS (ABA). That limits a packed manager to ~16.7 million handles rather than 2^40.
+#define Handle_MaxPackedHandles64 0x0000000000FFFFFFull
+#define Handle_PackedLinkIndexBits64 24u
+#define Handle_PackedLinkIndexMask64 0x00FFFFFFu
+
+typedef struct Handle_PackedManager64 {
+	uint64_t elementSize;
+	uint64_t maxBlocks;
+	uint32_t handlesPerBlockMask;
+	uint32_t handlesPerBlockShift;
+
+	uint32_t neverReissueOldHandles : 1;
+
+	// same transaction as Handle_Manager32, lower 32 bits is the free list head and
+	// upper 32 bits the deferred list head. Each is a tagged index + 1 so 0 is empty
+	Thread_Atomic64_t freeListHeads;
+
+	// each block includes the data and the generations store
+	Thread_AtomicPtr_t *blocks;
+
+	Thread_Atomic64_t totalHandlesAllocated;
+
+} Handle_PackedManager64;
+
+AL2O3_EXTERN_C Handle_PackedManager64 *Handle_PackedManager64Create(uint32_t elementSize,
+																																		uint32_t allocationBlockSize,
+																																		uint32_t maxBlocks,
+																																		bool neverReissueOldHandles);
+AL2O3_EXTERN_C void Handle_PackedManager64Destroy(Handle_PackedManager64 *manager);
+
+AL2O3_EXTERN_C Handle_Handle64 Handle_PackedManager64Alloc(Handle_PackedManager64 *manager);
+AL2O3_EXTERN_C void Handle_PackedManager64Release(Handle_PackedManager64 *manager, Handle_Handle64 handle);
+
+AL2O3_FORCE_INLINE bool Handle_PackedManager64IsValid(Handle_PackedManager64 *manager,
+																											Handle_Handle64 handle) {
+	if (handle.handle == 0) {
+		return false;
+	}
+	uint64_t const handleGen = handle.handle >> Handle_GenerationBitShift64;
+	uint64_t const actualIndex = (handle.handle & Handle_MaxHandles64);
+	uint64_t const blockIndex = actualIndex >> manager->handlesPerBlockShift;
+	uint64_t const index = actualIndex & manager->handlesPerBlockMask;
+
+	// fetch the base memory block for this index
+	uint8_t const * const base = HANDLE_MANAGER64_GETBASE_CONST(manager, blockIndex);
+	Handle_GenerationType64 const * const gen = HANDLE_MANAGER64_GETGEN_CONST(manager, base, index);
+
+	return (handleGen == (*gen & 0x00FFFFFFu));
+}
+
+AL2O3_FORCE_INLINE void *Handle_PackedManager64HandleToPtr(Handle_PackedManager64 *manager,
+																													 Handle_Handle64 handle) {
+	if (handle.handle == 0) {
+		return NULL;
+	}
+	if (!Handle_PackedManager64IsValid(manager, handle)) {
+		LOGERROR("Handle being converted to pointer is not valid!");
+		return NULL;
+	}
+
+	// fetch the base memory block for this index
+	uint64_t const actualIndex = (handle.handle & Handle_MaxHandles64);
+	uint64_t const blockIndex = actualIndex >> manager->handlesPerBlockShift;
+	uint64_t const index = actualIndex & manager->handlesPerBlockMask;
+
+	uint8_t const * const base = HANDLE_MANAGER64_GETBASE_CONST(manager, blockIndex);
+
+	return (void *) (base + (index * manager->elementSize));
+}
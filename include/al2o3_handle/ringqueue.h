@@ -0,0 +1,85 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_handle/handle.h"
+
+// Lock free bounded multi producer multi consumer ring of handles, for handing
+// ownership of elements between threads without allocating queue nodes.
+// Each cell holds a handle and the turn (position) it is next valid for, a
+// producer can fill a cell when the turn matches its position and a consumer can
+// empty it when the turn is position + 1 (Vyukov's bounded queue).
+// Handles use every bit so the turn can't live inside them, the 32 bit queue
+// packs both into a single 64 bit word (8 bytes per entry, pointer queues need 16)
+// the 64 bit queue keeps a separate turn per cell.
+// Handle 0 is never valid so it is used as the 'empty' return from Pop.
+// Pushes release and pops acquire, so element writes before a push are visible
+// to the thread that pops the handle.
+#define Handle_RingQueueCacheLineSize 64
+
+typedef struct Handle_RingQueue32 {
+	uint32_t capacityMask;
+	// (turn << 32) | handle
+	Thread_Atomic64_t *cells;
+	uint8_t padding0[Handle_RingQueueCacheLineSize - sizeof(uint32_t) - sizeof(Thread_Atomic64_t *)];
+
+	// producers and consumers each get their own cache line
+	Thread_Atomic64_t tail;
+	uint8_t padding1[Handle_RingQueueCacheLineSize - sizeof(Thread_Atomic64_t)];
+	Thread_Atomic64_t head;
+	uint8_t padding2[Handle_RingQueueCacheLineSize - sizeof(Thread_Atomic64_t)];
+} Handle_RingQueue32;
+
+typedef struct Handle_RingQueueCell64 {
+	Thread_Atomic64_t turn;
+	uint64_t handle;
+} Handle_RingQueueCell64;
+
+typedef struct Handle_RingQueue64 {
+	uint64_t capacityMask;
+	Handle_RingQueueCell64 *cells;
+	uint8_t padding0[Handle_RingQueueCacheLineSize - sizeof(uint64_t) - sizeof(Handle_RingQueueCell64 *)];
+
+	Thread_Atomic64_t tail;
+	uint8_t padding1[Handle_RingQueueCacheLineSize - sizeof(Thread_Atomic64_t)];
+	Thread_Atomic64_t head;
+	uint8_t padding2[Handle_RingQueueCacheLineSize - sizeof(Thread_Atomic64_t)];
+} Handle_RingQueue64;
+
+// capacity is rounded up to a power of 2
+AL2O3_EXTERN_C Handle_RingQueue32 *Handle_RingQueue32Create(uint32_t capacity);
+AL2O3_EXTERN_C void Handle_RingQueue32Destroy(Handle_RingQueue32 *queue);
+
+// false if the queue is full
+AL2O3_EXTERN_C bool Handle_RingQueue32Push(Handle_RingQueue32 *queue, Handle_Handle32 handle);
+// returns an invalid handle if the queue is empty
+AL2O3_EXTERN_C Handle_Handle32 Handle_RingQueue32Pop(Handle_RingQueue32 *queue);
+// claim a run of positions with one CAS, returns how many were pushed/popped.
+// Only cells already ready are claimed so it never waits on another thread,
+// less than count if full/empty or a slower thread still has the next cell
+AL2O3_EXTERN_C uint32_t Handle_RingQueue32PushBatch(Handle_RingQueue32 *queue,
+																										Handle_Handle32 const *handles,
+																										uint32_t count);
+AL2O3_EXTERN_C uint32_t Handle_RingQueue32PopBatch(Handle_RingQueue32 *queue, Handle_Handle32 *handles, uint32_t count);
+
+AL2O3_EXTERN_C Handle_RingQueue64 *Handle_RingQueue64Create(uint64_t capacity);
+AL2O3_EXTERN_C void Handle_RingQueue64Destroy(Handle_RingQueue64 *queue);
+
+AL2O3_EXTERN_C bool Handle_RingQueue64Push(Handle_RingQueue64 *queue, Handle_Handle64 handle);
+AL2O3_EXTERN_C Handle_Handle64 Handle_RingQueue64Pop(Handle_RingQueue64 *queue);
+AL2O3_EXTERN_C uint64_t Handle_RingQueue64PushBatch(Handle_RingQueue64 *queue,
+																										Handle_Handle64 const *handles,
+																										uint64_t count);
+AL2O3_EXTERN_C uint64_t Handle_RingQueue64PopBatch(Handle_RingQueue64 *queue, Handle_Handle64 *handles, uint64_t count);
+
+// only exact when no other thread is pushing or popping
+AL2O3_FORCE_INLINE uint32_t Handle_RingQueue32Count(Handle_RingQueue32 *queue) {
+	uint64_t const head = Thread_AtomicLoad64Relaxed(&queue->head);
+	uint64_t const tail = Thread_AtomicLoad64Relaxed(&queue->tail);
+	return (tail > head) ? (uint32_t) (tail - head) : 0;
+}
+
+AL2O3_FORCE_INLINE uint64_t Handle_RingQueue64Count(Handle_RingQueue64 *queue) {
+	uint64_t const head = Thread_AtomicLoad64Relaxed(&queue->head);
+	uint64_t const tail = Thread_AtomicLoad64Relaxed(&queue->tail);
+	return (tail > head) ? (tail - head) : 0;
+}
@@ -0,0 +1,92 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_handle/handle.h"
+
+// A sharded variant of Handle_Manager32 for many cores. Instead of one
+// freeListHeads every thread is hashed to one of K shards, each with its own
+// cache line padded free/deferred heads (same transaction as Handle_Manager32).
+// When a shards lists are empty it steals from the others before growing, a new
+// block is given to the shard that ran dry so blocks spread across the shards.
+// Handles have the same format and lookups cost the same as Handle_Manager32.
+#define Handle_ShardedMaxShards 64
+#define Handle_ShardedCacheLineSize 64
+
+typedef struct Handle_ShardedHeads32 {
+	Thread_Atomic64_t freeListHeads;
+	uint8_t padding[Handle_ShardedCacheLineSize - sizeof(Thread_Atomic64_t)];
+} Handle_ShardedHeads32;
+
+typedef struct Handle_ShardedManager32 {
+	// read mostly config used by every lookup, the mutable heads live in shards
+	// which are on their own cache lines so never false share with this
+	uint32_t elementSize;
+	uint32_t maxBlocks;
+	uint32_t handlesPerBlockMask;
+	uint32_t handlesPerBlockShift;
+	uint32_t shardCount;
+	uint32_t shardShift;
+	uint32_t neverReissueOldHandles : 1;
+
+	// each block includes the data and the generations store
+	Thread_AtomicPtr_t *blocks;
+
+	// K cache line aligned heads
+	Handle_ShardedHeads32 *shards;
+
+	// only changes when a block is added
+	Thread_Atomic32_t totalHandlesAllocated;
+
+} Handle_ShardedManager32;
+
+// shardCount of 0 uses the number of cores, it is rounded up to a power of 2
+AL2O3_EXTERN_C Handle_ShardedManager32 *Handle_ShardedManager32Create(uint32_t elementSize,
+																																			uint32_t allocationBlockSize,
+																																			uint32_t maxBlocks,
+																																			uint32_t shardCount,
+																																			bool neverReissueOldHandles);
+AL2O3_EXTERN_C void Handle_ShardedManager32Destroy(Handle_ShardedManager32 *manager);
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_ShardedManager32Alloc(Handle_ShardedManager32 *manager);
+AL2O3_EXTERN_C void Handle_ShardedManager32Release(Handle_ShardedManager32 *manager, Handle_Handle32 handle);
+
+AL2O3_FORCE_INLINE bool Handle_ShardedManager32IsValid(Handle_ShardedManager32 *manager,
+																											 Handle_Handle32 handle) {
+	if (handle.handle == 0) {
+		return false;
+	}
+	uint32_t const handleGen = handle.handle >> Handle_GenerationBitShift32;
+	uint32_t const actualIndex = (handle.handle & Handle_MaxHandles32);
+	uint32_t const blockIndex = actualIndex >> manager->handlesPerBlockShift;
+	uint32_t const index = actualIndex & manager->handlesPerBlockMask;
+
+	// fetch the base memory block for this index
+	uint8_t *base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex]);
+	ASSERT(base);
+	// point to generation data for this index
+	Handle_GenerationType32
+			*gen = base + ((manager->handlesPerBlockMask + 1) * manager->elementSize) + (index * Handle_GenerationSize32);
+
+	return (handleGen == *gen);
+}
+
+AL2O3_FORCE_INLINE void *Handle_ShardedManager32HandleToPtr(Handle_ShardedManager32 *manager,
+																														Handle_Handle32 handle) {
+	if (handle.handle == 0) {
+		return NULL;
+	}
+	if (!Handle_ShardedManager32IsValid(manager, handle)) {
+		LOGERROR("Handle being converted to pointer is not valid!");
+		return NULL;
+	}
+
+	// fetch the base memory block for this index
+	uint32_t const actualIndex = (handle.handle & Handle_MaxHandles32);
+	uint32_t const blockIndex = actualIndex >> manager->handlesPerBlockShift;
+	uint32_t const index = actualIndex & manager->handlesPerBlockMask;
+
+	uint8_t const
+			*const base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex]);
+	ASSERT(base);
+	return (void *) (base + (index * manager->elementSize));
+}
@@ -0,0 +1,99 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_handle/handle.h"
+
+// A Handle_Manager32 that lives entirely inside a shared memory segment so
+// several processes can alloc, release and look up the same handles with the
+// same lock free free list. Blocks are addressed by offset from the segment
+// start rather than pointer, so each process can map it anywhere. The segment
+// is sized for maxBlocks up front, untouched blocks cost no physical memory.
+// Named segments use shm_open, a NULL name uses an anonymous memfd (Linux) to be
+// shared via fork or fd passing. Not available on Windows (Create returns NULL).
+#define Handle_SharedMagic32 0x32534848u // 'HHS2'
+
+// at offset 0 of the segment
+typedef struct Handle_SharedHeader32 {
+	uint32_t magic;
+	uint32_t elementSize;
+	uint32_t maxBlocks;
+	uint32_t handlesPerBlockMask;
+	uint32_t handlesPerBlockShift;
+	uint32_t neverReissueOldHandles;
+	uint64_t blockSize;
+	// offset from the segment start to block 0, blocks follow each other
+	uint64_t blocksOffset;
+
+	// same packed free and deferred list heads as Handle_Manager32
+	Thread_Atomic64_t freeListHeads;
+	Thread_Atomic32_t totalHandlesAllocated;
+} Handle_SharedHeader32;
+
+// per process view of the segment
+typedef struct Handle_SharedManager32 {
+	Handle_SharedHeader32 *header;
+	uint8_t *blocks;
+	size_t mappedSize;
+	int fd;
+} Handle_SharedManager32;
+
+// name is a shm object name ("/foo") or NULL for an anonymous memfd
+AL2O3_EXTERN_C Handle_SharedManager32 *Handle_SharedManager32Create(char const *name,
+																																		uint32_t elementSize,
+																																		uint32_t allocationBlockSize,
+																																		uint32_t maxBlocks,
+																																		bool neverReissueOldHandles);
+// map a segment another process created
+AL2O3_EXTERN_C Handle_SharedManager32 *Handle_SharedManager32Open(char const *name);
+AL2O3_EXTERN_C Handle_SharedManager32 *Handle_SharedManager32OpenFd(int fd);
+// unmaps this process's view, the segment lives until every process has closed it (and it's unlinked)
+AL2O3_EXTERN_C void Handle_SharedManager32Close(Handle_SharedManager32 *manager);
+AL2O3_EXTERN_C void Handle_SharedManager32Unlink(char const *name);
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_SharedManager32Alloc(Handle_SharedManager32 *manager);
+AL2O3_EXTERN_C void Handle_SharedManager32Release(Handle_SharedManager32 *manager, Handle_Handle32 handle);
+
+AL2O3_FORCE_INLINE int Handle_SharedManager32Fd(Handle_SharedManager32 *manager) {
+	return manager->fd;
+}
+
+AL2O3_FORCE_INLINE uint8_t *Handle_SharedManager32BlockBase(Handle_SharedManager32 *manager, uint32_t blockIndex) {
+	ASSERT(blockIndex < manager->header->maxBlocks);
+	return manager->blocks + (blockIndex * manager->header->blockSize);
+}
+
+AL2O3_FORCE_INLINE bool Handle_SharedManager32IsValid(Handle_SharedManager32 *manager, Handle_Handle32 handle) {
+	if (handle.handle == 0) {
+		return false;
+	}
+	Handle_SharedHeader32 const *header = manager->header;
+	uint32_t const handleGen = handle.handle >> Handle_GenerationBitShift32;
+	uint32_t const actualIndex = (handle.handle & Handle_MaxHandles32);
+	if (actualIndex >= Thread_AtomicLoad32Relaxed((Thread_Atomic32_t *) &header->totalHandlesAllocated)) {
+		return false;
+	}
+	uint32_t const blockIndex = actualIndex >> header->handlesPerBlockShift;
+	uint32_t const index = actualIndex & header->handlesPerBlockMask;
+
+	uint8_t const *base = Handle_SharedManager32BlockBase(manager, blockIndex);
+	Handle_GenerationType32 const
+			*gen = base + ((header->handlesPerBlockMask + 1) * header->elementSize) + (index * Handle_GenerationSize32);
+
+	return (handleGen == *gen);
+}
+
+AL2O3_FORCE_INLINE void *Handle_SharedManager32HandleToPtr(Handle_SharedManager32 *manager, Handle_Handle32 handle) {
+	if (handle.handle == 0) {
+		return NULL;
+	}
+	if (!Handle_SharedManager32IsValid(manager, handle)) {
+		LOGERROR("Handle being converted to pointer is not valid!");
+		return NULL;
+	}
+	Handle_SharedHeader32 const *header = manager->header;
+	uint32_t const actualIndex = (handle.handle & Handle_MaxHandles32);
+	uint32_t const blockIndex = actualIndex >> header->handlesPerBlockShift;
+	uint32_t const index = actualIndex & header->handlesPerBlockMask;
+
+	return (void *) (Handle_SharedManager32BlockBase(manager, blockIndex) + (index * header->elementSize));
+}
@@ -0,0 +1,90 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_handle/handle.h"
+
+// Variable sized allocations with generational handles.
+// A family of Handle_Manager64, one per power of 2 size class from 16 bytes up
+// to 32 KiB, created on first use. The class lives in the top 4 bits of the 40
+// bit index so a single 64 bit handle finds its manager, anything bigger goes
+// down the large object path which keeps a separately allocated block of memory
+// per handle. Handle 0 is still never valid. Thread safe like Handle_Manager64.
+#define Handle_SizeClassShift64 36ull
+#define Handle_SizeClassIndexMask64 ((1ull << Handle_SizeClassShift64) - 1ull)
+#define Handle_SizeClassMinSize 16u
+#define Handle_SizeClassCount 12u
+#define Handle_SizeClassMaxSize (Handle_SizeClassMinSize << (Handle_SizeClassCount - 1u))
+#define Handle_SizeClassLarge 15u
+
+typedef struct Handle_SizeClassLargeEntry64 {
+	void *memory;
+	size_t size;
+} Handle_SizeClassLargeEntry64;
+
+typedef struct Handle_SizeClassAllocator {
+	// bytes per block, each class gets as many handles as fit (at least 16)
+	uint32_t blockSize;
+	uint32_t maxBlocks;
+
+	// NULL until the first alloc of that class
+	Thread_AtomicPtr_t classes[Handle_SizeClassCount];
+	// elements are Handle_SizeClassLargeEntry64
+	Thread_AtomicPtr_t large;
+} Handle_SizeClassAllocator;
+
+AL2O3_EXTERN_C Handle_SizeClassAllocator *Handle_SizeClassAllocatorCreate(uint32_t blockSize, uint32_t maxBlocks);
+// frees every class manager and any large objects still alive
+AL2O3_EXTERN_C void Handle_SizeClassAllocatorDestroy(Handle_SizeClassAllocator *allocator);
+
+// the memory is zero'ed, returns an invalid handle if out of handles or memory
+AL2O3_EXTERN_C Handle_Handle64 Handle_SizeClassAlloc(Handle_SizeClassAllocator *allocator, size_t size);
+AL2O3_EXTERN_C void Handle_SizeClassRelease(Handle_SizeClassAllocator *allocator, Handle_Handle64 handle);
+// usable size, the class size or the exact size for large objects
+AL2O3_EXTERN_C size_t Handle_SizeClassHandleToSize(Handle_SizeClassAllocator *allocator, Handle_Handle64 handle);
+
+AL2O3_FORCE_INLINE uint32_t Handle_SizeClassOf(Handle_Handle64 handle) {
+	return (uint32_t) ((handle.handle & Handle_MaxHandles64) >> Handle_SizeClassShift64);
+}
+
+// the handle as its class manager knows it
+AL2O3_FORCE_INLINE Handle_Handle64 Handle_SizeClassToManagerHandle(Handle_Handle64 handle) {
+	Handle_Handle64 managerHandle = {handle.handle & ~(Handle_MaxHandles64 & ~Handle_SizeClassIndexMask64)};
+	return managerHandle;
+}
+
+AL2O3_FORCE_INLINE Handle_Manager64 *Handle_SizeClassManager(Handle_SizeClassAllocator *allocator, uint32_t sizeClass) {
+	if (sizeClass == Handle_SizeClassLarge) {
+		return (Handle_Manager64 *) Thread_AtomicLoadPtrRelaxed(&allocator->large);
+	}
+	if (sizeClass >= Handle_SizeClassCount) {
+		return NULL;
+	}
+	return (Handle_Manager64 *) Thread_AtomicLoadPtrRelaxed(&allocator->classes[sizeClass]);
+}
+
+AL2O3_FORCE_INLINE bool Handle_SizeClassIsValid(Handle_SizeClassAllocator *allocator, Handle_Handle64 handle) {
+	if (handle.handle == 0) {
+		return false;
+	}
+	Handle_Manager64 *manager = Handle_SizeClassManager(allocator, Handle_SizeClassOf(handle));
+	if (!manager) {
+		return false;
+	}
+	return Handle_Manager64IsValid(manager, Handle_SizeClassToManagerHandle(handle));
+}
+
+AL2O3_FORCE_INLINE void *Handle_SizeClassHandleToPtr(Handle_SizeClassAllocator *allocator, Handle_Handle64 handle) {
+	if (!Handle_SizeClassIsValid(allocator, handle)) {
+		if (handle.handle != 0) {
+			LOGERROR("Handle being converted to pointer is not valid!");
+		}
+		return NULL;
+	}
+	uint32_t const sizeClass = Handle_SizeClassOf(handle);
+	Handle_Manager64 *manager = Handle_SizeClassManager(allocator, sizeClass);
+	void *ptr = Handle_Manager64HandleToPtr(manager, Handle_SizeClassToManagerHandle(handle));
+	if (sizeClass == Handle_SizeClassLarge) {
+		return ((Handle_SizeClassLargeEntry64 *) ptr)->memory;
+	}
+	return ptr;
+}
@@ -0,0 +1,70 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+
+#include "al2o3_handle/handle.h"
+
+// A slot map uses the same 32 bit handle encoding as Handle_Manager32 but keeps
+// the live elements packed in a dense array, so iterating all of them is a
+// linear sweep with no holes. Handles index an indirection (slot) array that
+// points into the dense array, release swaps the last element into the hole.
+// Unlike the managers, element pointers are only stable until the next alloc
+// or release and the slot map is NOT thread safe.
+typedef struct Handle_SlotMap32 {
+	uint32_t elementSize;
+	uint32_t capacity;
+	uint32_t size;
+	uint32_t slotCount;
+	// free slots are reused oldest first to maximise the generation overlap distance
+	uint32_t freeListHead;
+	uint32_t freeListTail;
+
+	// slot -> dense index when alive, slot -> next free slot when dead
+	uint32_t *slots;
+	Handle_GenerationType32 *generations;
+	// dense index -> slot for swap and pop release
+	uint32_t *denseToSlot;
+	uint8_t *dense;
+} Handle_SlotMap32;
+
+AL2O3_EXTERN_C Handle_SlotMap32 *Handle_SlotMap32Create(uint32_t elementSize, uint32_t initialCapacity);
+AL2O3_EXTERN_C void Handle_SlotMap32Destroy(Handle_SlotMap32 *map);
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_SlotMap32Alloc(Handle_SlotMap32 *map);
+AL2O3_EXTERN_C void Handle_SlotMap32Release(Handle_SlotMap32 *map, Handle_Handle32 handle);
+
+AL2O3_FORCE_INLINE bool Handle_SlotMap32IsValid(Handle_SlotMap32 const *map, Handle_Handle32 handle) {
+	if (handle.handle == 0) {
+		return false;
+	}
+	uint32_t const index = (handle.handle & Handle_MaxHandles32);
+	if (index >= map->slotCount) {
+		return false;
+	}
+	uint32_t const handleGen = handle.handle >> Handle_GenerationBitShift32;
+	return (handleGen == map->generations[index]);
+}
+
+AL2O3_FORCE_INLINE void *Handle_SlotMap32HandleToPtr(Handle_SlotMap32 const *map, Handle_Handle32 handle) {
+	if (!Handle_SlotMap32IsValid(map, handle)) {
+		return NULL;
+	}
+	uint32_t const index = (handle.handle & Handle_MaxHandles32);
+	return map->dense + ((size_t) map->slots[index] * map->elementSize);
+}
+
+// number of live elements, all packed at the start of Handle_SlotMap32Data
+AL2O3_FORCE_INLINE uint32_t Handle_SlotMap32Size(Handle_SlotMap32 const *map) {
+	return map->size;
+}
+
+AL2O3_FORCE_INLINE void *Handle_SlotMap32Data(Handle_SlotMap32 const *map) {
+	return map->dense;
+}
+
+// the handle that currently owns a dense element, for use when iterating
+AL2O3_FORCE_INLINE Handle_Handle32 Handle_SlotMap32DenseIndexToHandle(Handle_SlotMap32 const *map, uint32_t denseIndex) {
+	ASSERT(denseIndex < map->size);
+	uint32_t const index = map->denseToSlot[denseIndex];
+	Handle_Handle32 handle = { ((uint32_t) map->generations[index]) << Handle_GenerationBitShift32 | index };
+	return handle;
+}
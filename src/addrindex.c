@@ -0,0 +1,127 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_handle/addrindex.h"
+
+#define InitialCapacity 16u
+
+typedef struct RangeArray {
+	// the array this one replaced, freed with it
+	struct RangeArray *replaced;
+	uint32_t capacity;
+	uint32_t count;
+	Handle_AddressRange ranges[];
+} RangeArray;
+
+static RangeArray *AllocRangeArray(uint32_t capacity) {
+	RangeArray *array = (RangeArray *) MEMORY_CALLOC(1, sizeof(RangeArray) + (capacity * sizeof(Handle_AddressRange)));
+	if (!array) {
+		return NULL;
+	}
+	array->capacity = capacity;
+	return array;
+}
+
+// first range whose base is above address
+static uint32_t UpperBound(Handle_AddressRange const *ranges, uint32_t count, uintptr_t address) {
+	uint32_t lo = 0;
+	uint32_t hi = count;
+	while (lo < hi) {
+		uint32_t const mid = lo + ((hi - lo) >> 1u);
+		if (ranges[mid].base <= address) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+AL2O3_EXTERN_C bool Handle_AddressIndexInsert(Handle_AddressIndex *index, void const *base, size_t size, uint64_t firstIndex) {
+	// take the write side, spinning while another insert is in progress
+	RedoW:;
+	uint32_t const seq = Thread_AtomicLoad32Relaxed(&index->sequence);
+	if ((seq & 0x1u) || Thread_AtomicCompareExchange32Relaxed(&index->sequence, seq, seq + 1) != seq) {
+		goto RedoW;
+	}
+	Thread_AtomicThreadFenceSeqCst();
+
+	RangeArray *array = (RangeArray *) Thread_AtomicLoadPtrRelaxed(&index->ranges);
+	if (!array || array->count == array->capacity) {
+		RangeArray *grown = AllocRangeArray(array ? array->capacity * 2u : InitialCapacity);
+		if (grown) {
+			if (array) {
+				memcpy(grown->ranges, array->ranges, array->count * sizeof(Handle_AddressRange));
+				grown->count = array->count;
+			}
+			grown->replaced = array;
+			Thread_AtomicStorePtrRelaxed(&index->ranges, grown);
+		} else {
+			LOGWARNING("Out of memory!");
+		}
+		array = grown;
+	}
+
+	if (array) {
+		uintptr_t const address = (uintptr_t) base;
+		uint32_t const at = UpperBound(array->ranges, array->count, address);
+		memmove(array->ranges + at + 1, array->ranges + at, (array->count - at) * sizeof(Handle_AddressRange));
+		array->ranges[at].base = address;
+		array->ranges[at].size = size;
+		array->ranges[at].firstIndex = firstIndex;
+		array->count++;
+	}
+
+	Thread_AtomicThreadFenceRelease();
+	Thread_AtomicStore32Relaxed(&index->sequence, seq + 2);
+	return array != NULL;
+}
+
+AL2O3_EXTERN_C bool Handle_AddressIndexFind(Handle_AddressIndex *index, void const *ptr, Handle_AddressRange *range) {
+	uintptr_t const address = (uintptr_t) ptr;
+
+	RedoR:;
+	uint32_t const seq = Thread_AtomicLoad32Relaxed(&index->sequence);
+	if (seq & 0x1u) {
+		goto RedoR; // an insert is in progress
+	}
+	Thread_AtomicThreadFenceAcquire();
+
+	RangeArray const *array = (RangeArray const *) Thread_AtomicLoadPtrRelaxed(&index->ranges);
+	if (!array) {
+		return false;
+	}
+	// a torn read is caught by the sequence check, it just mustn't run off the end
+	uint32_t count = array->count;
+	if (count > array->capacity) {
+		count = array->capacity;
+	}
+	uint32_t const at = UpperBound(array->ranges, count, address);
+	Handle_AddressRange found = {0, 0, 0};
+	if (at > 0) {
+		found = array->ranges[at - 1];
+	}
+
+	Thread_AtomicThreadFenceAcquire();
+	if (Thread_AtomicLoad32Relaxed(&index->sequence) != seq) {
+		goto RedoR;
+	}
+
+	if (at == 0 || address >= found.base + found.size) {
+		return false;
+	}
+	*range = found;
+	return true;
+}
+
+AL2O3_EXTERN_C void Handle_AddressIndexDestroy(Handle_AddressIndex *index) {
+	RangeArray *array = (RangeArray *) Thread_AtomicLoadPtrRelaxed(&index->ranges);
+	while (array) {
+		RangeArray *replaced = array->replaced;
+		MEMORY_FREE(array);
+		array = replaced;
+	}
+	Thread_AtomicStorePtrRelaxed(&index->ranges, NULL);
+	Thread_AtomicStore32Relaxed(&index->sequence, 0);
+}
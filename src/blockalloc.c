@@ -0,0 +1,28 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_handle/blockalloc.h"
+
+static void *DefaultAlloc(void *context, size_t size, size_t alignment) {
+	(void) context;
+	// the system allocator is 16 byte aligned on all our 64 bit targets
+	ASSERT(alignment <= Handle_BlockAlignment);
+	(void) alignment;
+	return MEMORY_CALLOC(1, size);
+}
+
+static void DefaultFree(void *context, void *ptr, size_t size) {
+	(void) context;
+	(void) size;
+	MEMORY_FREE(ptr);
+}
+
+static Handle_BlockAllocator const DefaultAllocator = {
+	&DefaultAlloc,
+	&DefaultFree,
+	NULL
+};
+
+AL2O3_EXTERN_C Handle_BlockAllocator const *Handle_BlockAllocatorDefault(void) {
+	return &DefaultAllocator;
+}
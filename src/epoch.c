@@ -0,0 +1,122 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_handle/epoch.h"
+
+// how many retired slots a thread collects before trying to reclaim them
+#define ReclaimInterval 64u
+
+// the epoch can only move on once every pinned thread has seen the current one
+static void TryAdvance(Handle_EpochDomain *domain) {
+	uint64_t const epoch = Thread_AtomicLoad64Relaxed(&domain->globalEpoch);
+	Thread_AtomicThreadFenceSeqCst();
+
+	for (uint32_t i = 0u; i < Handle_EpochMaxThreads; ++i) {
+		Handle_EpochThread *const thread = domain->threads + i;
+		if (Thread_AtomicLoad32Relaxed(&thread->inUse) == 0) {
+			continue;
+		}
+		uint64_t const state = Thread_AtomicLoad64Relaxed(&thread->state);
+		if ((state & 0x1u) && (state >> 1u) != epoch) {
+			return;
+		}
+	}
+	// if someone else advanced it first, thats just as good
+	Thread_AtomicCompareExchange64Relaxed(&domain->globalEpoch, epoch, epoch + 1);
+}
+
+AL2O3_EXTERN_C Handle_EpochDomain *Handle_EpochDomainCreate(void) {
+	return (Handle_EpochDomain *) MEMORY_CALLOC(1, sizeof(Handle_EpochDomain));
+}
+
+AL2O3_EXTERN_C void Handle_EpochDomainDestroy(Handle_EpochDomain *domain) {
+	if (!domain) {
+		return;
+	}
+	for (uint32_t i = 0u; i < Handle_EpochMaxThreads; ++i) {
+		Handle_EpochThread *const thread = domain->threads + i;
+		ASSERT((Thread_AtomicLoad64Relaxed(&thread->state) & 0x1u) == 0);
+		for (uint32_t j = 0u; j < thread->retiredCount; ++j) {
+			Handle_Manager32Recycle(thread->retired[j].manager, thread->retired[j].index);
+		}
+		MEMORY_FREE(thread->retired);
+	}
+	MEMORY_FREE(domain);
+}
+
+AL2O3_EXTERN_C Handle_EpochThread *Handle_EpochRegisterThread(Handle_EpochDomain *domain) {
+	for (uint32_t i = 0u; i < Handle_EpochMaxThreads; ++i) {
+		Handle_EpochThread *const thread = domain->threads + i;
+		if (Thread_AtomicCompareExchange32Relaxed(&thread->inUse, 0, 1) == 0) {
+			Thread_AtomicStore64Relaxed(&thread->state, 0);
+			return thread;
+		}
+	}
+	LOGWARNING("Epoch domain already has %u threads registered", Handle_EpochMaxThreads);
+	return NULL;
+}
+
+AL2O3_EXTERN_C void Handle_EpochUnregisterThread(Handle_EpochDomain *domain, Handle_EpochThread *thread) {
+	if (!thread) {
+		return;
+	}
+	ASSERT((Thread_AtomicLoad64Relaxed(&thread->state) & 0x1u) == 0);
+	// nobody else can recycle these, so wait for the readers to move on
+	while (Handle_EpochReclaim(domain, thread) != 0) {
+	}
+	MEMORY_FREE(thread->retired);
+	thread->retired = NULL;
+	thread->retiredCapacity = 0;
+	Thread_AtomicStore32Relaxed(&thread->inUse, 0);
+}
+
+AL2O3_EXTERN_C bool Handle_EpochRelease32(Handle_EpochDomain *domain,
+																					Handle_EpochThread *thread,
+																					Handle_Manager32 *manager,
+																					Handle_Handle32 handle) {
+	// make room before retiring so a failure leaves the handle as it was
+	if (thread->retiredCount == thread->retiredCapacity) {
+		uint32_t const newCapacity = thread->retiredCapacity ? thread->retiredCapacity * 2 : ReclaimInterval;
+		Handle_EpochRetired32 *retired = (Handle_EpochRetired32 *)
+				MEMORY_REALLOC(thread->retired, newCapacity * sizeof(Handle_EpochRetired32));
+		if (!retired) {
+			LOGWARNING("Out of memory!");
+			return false;
+		}
+		thread->retired = retired;
+		thread->retiredCapacity = newCapacity;
+	}
+
+	// new lookups fail from now, existing pointers stay untouched until recycled
+	Handle_Manager32Retire(manager, handle);
+	Thread_AtomicThreadFenceSeqCst();
+
+	Handle_EpochRetired32 *const entry = thread->retired + thread->retiredCount++;
+	entry->manager = manager;
+	entry->index = handle.handle & Handle_MaxHandles32;
+	entry->epoch = Thread_AtomicLoad64Relaxed(&domain->globalEpoch);
+
+	if ((thread->retiredCount % ReclaimInterval) == 0) {
+		Handle_EpochReclaim(domain, thread);
+	}
+	return true;
+}
+
+AL2O3_EXTERN_C uint32_t Handle_EpochReclaim(Handle_EpochDomain *domain, Handle_EpochThread *thread) {
+	TryAdvance(domain);
+	uint64_t const epoch = Thread_AtomicLoad64Relaxed(&domain->globalEpoch);
+
+	// anything retired 2 epochs ago can't be seen by any pinned reader
+	uint32_t kept = 0;
+	for (uint32_t i = 0u; i < thread->retiredCount; ++i) {
+		Handle_EpochRetired32 const entry = thread->retired[i];
+		if (entry.epoch + 2 <= epoch) {
+			Handle_Manager32Recycle(entry.manager, entry.index);
+		} else {
+			thread->retired[kept++] = entry;
+		}
+	}
+	thread->retiredCount = kept;
+	return kept;
+}
@@ -0,0 +1,118 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_handle/filemap.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define HANDLE_FILEMAP_POSIX 1
+#endif
+
+#if defined(HANDLE_FILEMAP_POSIX)
+// msync and madvise want page aligned ranges
+static void PageAlignRange(Handle_FileMap *map, size_t *offset, size_t *size) {
+	size_t const pageSize = (size_t) sysconf(_SC_PAGESIZE);
+	size_t const start = *offset & ~(pageSize - 1);
+	size_t end = *offset + *size;
+	if (end > map->size) {
+		end = map->size;
+	}
+	*offset = start;
+	*size = end - start;
+}
+#endif
+
+AL2O3_EXTERN_C Handle_FileMap *Handle_FileMapOpen(char const *path, size_t size) {
+#if defined(HANDLE_FILEMAP_POSIX)
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		LOGWARNING("Unable to open %s", path);
+		return NULL;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return NULL;
+	}
+	bool const created = (info.st_size == 0);
+	if ((size_t) info.st_size < size && ftruncate(fd, (off_t) size) != 0) {
+		LOGWARNING("Unable to size %s to %zu bytes", path, size);
+		close(fd);
+		return NULL;
+	}
+	void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		LOGWARNING("Unable to map %s", path);
+		close(fd);
+		return NULL;
+	}
+
+	Handle_FileMap *map = (Handle_FileMap *) MEMORY_CALLOC(1, sizeof(Handle_FileMap));
+	if (!map) {
+		munmap(base, size);
+		close(fd);
+		return NULL;
+	}
+	map->base = (uint8_t *) base;
+	map->size = size;
+	map->fd = fd;
+	map->created = created;
+	return map;
+#else
+	(void) path;
+	(void) size;
+	LOGWARNING("File backed handle storage isn't supported on this platform");
+	return NULL;
+#endif
+}
+
+AL2O3_EXTERN_C void Handle_FileMapClose(Handle_FileMap *map) {
+	if (!map) {
+		return;
+	}
+#if defined(HANDLE_FILEMAP_POSIX)
+	munmap(map->base, map->size);
+	close(map->fd);
+#endif
+	MEMORY_FREE(map);
+}
+
+AL2O3_EXTERN_C bool Handle_FileMapFlush(Handle_FileMap *map, size_t offset, size_t size, bool sync) {
+#if defined(HANDLE_FILEMAP_POSIX)
+	PageAlignRange(map, &offset, &size);
+	return msync(map->base + offset, size, sync ? MS_SYNC : MS_ASYNC) == 0;
+#else
+	(void) map;
+	(void) offset;
+	(void) size;
+	(void) sync;
+	return false;
+#endif
+}
+
+AL2O3_EXTERN_C void Handle_FileMapAdvise(Handle_FileMap *map, size_t offset, size_t size, Handle_FileAdvice advice) {
+#if defined(HANDLE_FILEMAP_POSIX)
+	PageAlignRange(map, &offset, &size);
+	int flag = MADV_NORMAL;
+	switch (advice) {
+		case Handle_FileAdviceSequential: flag = MADV_SEQUENTIAL;
+			break;
+		case Handle_FileAdviceRandom: flag = MADV_RANDOM;
+			break;
+		case Handle_FileAdviceWillNeed: flag = MADV_WILLNEED;
+			break;
+		case Handle_FileAdviceDontNeed: flag = MADV_DONTNEED;
+			break;
+		default: break;
+	}
+	madvise(map->base + offset, size, flag);
+#else
+	(void) map;
+	(void) offset;
+	(void) size;
+	(void) advice;
+#endif
+}
@@ -2,6 +2,7 @@
 #include "al2o3_platform/platform.h"
 #include "al2o3_memory/memory.h"
 #include "al2o3_thread/atomic.h"
+#include "al2o3_thread/thread.h"
 #include "al2o3_handle/fixed.h"
 
 AL2O3_EXTERN_C Handle_FixedManager32* Handle_FixedManager32Create(uint32_t elementSize, uint32_t totalHandleCount) {
@@ -22,25 +23,34 @@ AL2O3_EXTERN_C Handle_FixedManager32* Handle_FixedManager32Create(uint32_t eleme
 
 	uint8_t* elementMem = (uint8_t *) (manager+1);
 
-	// init free list for new block
-	for (uint32_t i = 0u; i < totalHandleCount; ++i) {
-		uint32_t const index = i;
-		void* addr = elementMem + (index * manager->elementSize);
-		*((uint32_t *)addr) = 0xFF000000u | (index + 1);
-	}
-
 	// index zero is born generation 1
 	*(elementMem + (totalHandleCount * manager->elementSize)) = 1;
 
-	// fix last index to point to the invalid marker
-	*((uint32_t*)(elementMem + ((totalHandleCount - 1) * manager->elementSize))) = 0;
+	// no free list to build, fresh slots are bumped from the cursor and only
+	// released ones are linked, so no element is touched before its first alloc
+	Thread_AtomicStore64Relaxed(&manager->freeListHeads, 0);
+	manager->resetLimit = totalHandleCount;
+	Thread_AtomicStore32Relaxed(&manager->resetCursor, 0);
 
-	// repoint heads to start of the free list with an empty deferred list
-	Thread_AtomicStore64Relaxed(&manager->freeListHeads, 0xFF000000ull);
+	return manager;
+}
 
+AL2O3_EXTERN_C Handle_FixedManager32* Handle_FixedManager32CreateSingleThreaded(uint32_t elementSize, uint32_t totalHandleCount) {
+	Handle_FixedManager32* manager = Handle_FixedManager32Create(elementSize, totalHandleCount);
+	if(!manager) {
+		return NULL;
+	}
+	manager->singleThreaded = true;
+	manager->ownerThread = (uint64_t) Thread_GetCurrentThreadID();
 	return manager;
 }
 
+AL2O3_EXTERN_C void Handle_FixedManager32SetOwner(Handle_FixedManager32* manager) {
+	ASSERT(manager->singleThreaded);
+	manager->ownerThread = (uint64_t) Thread_GetCurrentThreadID();
+	Thread_AtomicThreadFenceSeqCst();
+}
+
 AL2O3_EXTERN_C void Handle_FixedManager32Destroy(Handle_FixedManager32* manager) {
 	if (!manager) {
 		return;
@@ -49,7 +59,53 @@ AL2O3_EXTERN_C void Handle_FixedManager32Destroy(Handle_FixedManager32* manager)
 }
 
 
-AL2O3_EXTERN_C Handle_FixedHandle32 Handle_FixedManager32Alloc(Handle_FixedManager32* manager) {
+// takes the next index not handed out since creation or the last Reset
+static Handle_FixedHandle32 AllocReset(Handle_FixedManager32* manager, void** element) {
+RedoC:;
+	uint32_t const index = Thread_AtomicLoad32Relaxed(&manager->resetCursor);
+	if (index >= manager->resetLimit) {
+		return Handle_InvalidFixedHandle32;
+	}
+	if (Thread_AtomicCompareExchange32Relaxed(&manager->resetCursor, index, index + 1) != index) {
+		goto RedoC;
+	}
+
+	*element = ((uint8_t*)(manager+1)) + (index * manager->elementSize);
+	uint8_t *gen = ((uint8_t*)(manager+1)) + (manager->totalHandleCount * manager->elementSize) + index;
+	return index | ((uint32_t) *gen) << 24u;
+}
+
+// single threaded managers, the same as below with plain loads and stores
+static Handle_FixedHandle32 AllocSingle(Handle_FixedManager32* manager, void** element) {
+	ASSERT(manager->ownerThread == (uint64_t) Thread_GetCurrentThreadID());
+	uint64_t heads = manager->freeListHeads.nonatomic;
+	if ((uint32_t)(heads & 0xFFFFFFFFull) == Handle_InvalidFixedHandle32) {
+		// fresh slots go before released ones
+		Handle_FixedHandle32 const fresh = AllocReset(manager, element);
+		if (fresh != Handle_InvalidFixedHandle32) {
+			return fresh;
+		}
+		// nobody else can be releasing, so when both are empty that's it
+		heads = heads >> 32u;
+		if (heads == Handle_InvalidFixedHandle32) {
+			LOGWARNING("Manager has run out of handles");
+			return Handle_InvalidFixedHandle32;
+		}
+	}
+	uint32_t const index = (uint32_t)(heads & 0x00FFFFFF); // clean up the marker
+	uint32_t *item = (uint32_t *) (((uint8_t*)(manager+1)) + (index * manager->elementSize));
+	manager->freeListHeads.nonatomic = (heads & ~0xFFFFFFFFull) | *item;
+
+	*element = item;
+	uint8_t *gen = ((uint8_t*)(manager+1)) + (manager->totalHandleCount * manager->elementSize) + index;
+	return index | ((uint32_t) *gen) << 24u;
+}
+
+// pops a free slot, the element is left for the init policy
+static Handle_FixedHandle32 AllocNoInit(Handle_FixedManager32* manager, void** element) {
+	if (manager->singleThreaded) {
+		return AllocSingle(manager, element);
+	}
 	uint32_t noFreeCount = 0;
 
 RedoD0:;
@@ -61,6 +117,11 @@ RedoD0:;
 
 	// check to see if the free list is empty
 	if (headsFreePart == Handle_InvalidFixedHandle32) {
+		// slots never handed out (since creation or a Reset) go before released ones
+		Handle_FixedHandle32 const fresh = AllocReset(manager, element);
+		if (fresh != Handle_InvalidFixedHandle32) {
+			return fresh;
+		}
 		// we need to swap the deferred into the free list as free list is empty
 		if (headsDeferFreePart == (uint64_t)Handle_InvalidFixedHandle32) {
 			// the deferred list is empty, so we have no free handles
@@ -90,14 +151,60 @@ RedoD0:;
 	}
 
 	// the item is now ours to abuse
-	// clear it out ready for its new life
-	memset(item, 0, manager->elementSize);
+	*element = item;
 
 	// now make the handle and return it
 	uint8_t *gen = ((uint8_t*)(manager+1)) + (manager->totalHandleCount * manager->elementSize) + index;
 	return index | ((uint32_t) *gen) << 24u;
 }
 
+AL2O3_EXTERN_C Handle_FixedHandle32 Handle_FixedManager32Alloc(Handle_FixedManager32* manager) {
+	void* element = NULL;
+	Handle_FixedHandle32 const handle = AllocNoInit(manager, &element);
+	if (handle != Handle_InvalidFixedHandle32) {
+		// clear it out ready for its new life
+		Handle_InitElements(&manager->init, element, manager->elementSize, 1);
+		Handle_InitFence(&manager->init);
+	}
+	return handle;
+}
+
+AL2O3_EXTERN_C uint32_t Handle_FixedManager32AllocBatch(Handle_FixedManager32* manager, Handle_FixedHandle32* handles, uint32_t count) {
+	uint8_t* runStart = NULL;
+	uint32_t runCount = 0;
+	uint32_t allocated = 0;
+	for (; allocated < count; ++allocated) {
+		void* element = NULL;
+		Handle_FixedHandle32 const handle = AllocNoInit(manager, &element);
+		if (handle == Handle_InvalidFixedHandle32) {
+			break;
+		}
+		handles[allocated] = handle;
+		// fresh and recently released slots tend to be next to each other
+		if (runStart && (uint8_t*) element == runStart + (runCount * manager->elementSize)) {
+			runCount++;
+			continue;
+		}
+		if (runStart) {
+			Handle_InitElements(&manager->init, runStart, manager->elementSize, runCount);
+		}
+		runStart = (uint8_t*) element;
+		runCount = 1;
+	}
+	if (runStart) {
+		Handle_InitElements(&manager->init, runStart, manager->elementSize, runCount);
+	}
+	Handle_InitFence(&manager->init);
+	return allocated;
+}
+
+AL2O3_EXTERN_C void Handle_FixedManager32SetInitPolicy(Handle_FixedManager32* manager, Handle_InitPolicy policy, Handle_InitFunc func, void* userData) {
+	ASSERT(policy != Handle_InitPolicyCallback || func != NULL);
+	manager->init.policy = policy;
+	manager->init.func = func;
+	manager->init.userData = userData;
+}
+
 AL2O3_EXTERN_C void Handle_FixedManager32Release(Handle_FixedManager32* manager, Handle_FixedHandle32 handle) {
 	ASSERT((handle & Handle_MaxFixedHandles32) < manager->totalHandleCount);
 	ASSERT(Handle_FixedManager32IsValid(manager, handle));
@@ -116,6 +223,14 @@ AL2O3_EXTERN_C void Handle_FixedManager32Release(Handle_FixedManager32* manager,
 
 	uint64_t markerIndex = ((uint64_t)index | 0xFF000000ull) << 32ull; // marker
 
+	if (manager->singleThreaded) {
+		ASSERT(manager->ownerThread == (uint64_t) Thread_GetCurrentThreadID());
+		uint64_t const heads = manager->freeListHeads.nonatomic;
+		*item = (uint32_t)(heads >> 32ull);
+		manager->freeListHeads.nonatomic = markerIndex | (heads & 0xFFFFFFFFull);
+		return;
+	}
+
 RedoF:;
 	// add it to the deferred list without changing the free list
 	// repeat until we get a transaction okay response from CAS
@@ -130,3 +245,19 @@ RedoF:;
 	}
 
 }
+
+AL2O3_EXTERN_C void Handle_FixedManager32Reset(Handle_FixedManager32* manager) {
+	uint8_t *gens = ((uint8_t*)(manager+1)) + (manager->totalHandleCount * manager->elementSize);
+	// one pass, intentional 8 bit integer overflow and no branches so it vectorises
+	for (uint32_t i = 0u; i < manager->totalHandleCount; ++i) {
+		gens[i] = (uint8_t) (gens[i] + 1);
+	}
+	if (gens[0] == 0) {
+		gens[0] = 1;
+	}
+
+	// every slot whether free, deferred or live is now reissued via the cursor
+	Thread_AtomicStore64Relaxed(&manager->freeListHeads, 0);
+	manager->resetLimit = manager->totalHandleCount;
+	Thread_AtomicStore32Relaxed(&manager->resetCursor, 0);
+}
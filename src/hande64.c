@@ -2,34 +2,143 @@
 #include "al2o3_platform/platform.h"
 #include "al2o3_memory/memory.h"
 #include "al2o3_thread/atomic.h"
+#include "al2o3_thread/thread.h"
 #include "al2o3_handle/handle.h"
+#include "internal.h"
 
-AL2O3_FORCE_INLINE bool IsPow2(uint32_t num) {
-	return ((num & (num - 1)) == 0);
+// each block has space for the data, the generations and optionally the sequences
+static size_t BlockSize64(uint64_t elementSize, uint64_t handlesPerBlock, bool seqLocked) {
+	return (handlesPerBlock * elementSize) +
+			(handlesPerBlock * Handle_GenerationSize64) +
+			(seqLocked ? (handlesPerBlock * Handle_SequenceSize64) : 0);
 }
 
-AL2O3_FORCE_INLINE uint32_t NextPow2(uint32_t num) {
-	num -= 1;
-	num |= num >> 16u;
-	num |= num >> 8u;
-	num |= num >> 4u;
-	num |= num >> 2u;
-	num |= num >> 1u;
+// size of the header allocation, includes the embedded first block
+static size_t HeaderAllocSize64(uint64_t elementSize, uint32_t handlesPerBlock, uint64_t maxBlocks, bool seqLocked) {
+	return sizeof(Handle_Manager64)
+			+ BlockSize64(elementSize, handlesPerBlock, seqLocked) +
+			8 + // padding to ensure atomics are at least 8 byte aligned
+			(maxBlocks * sizeof(Thread_AtomicPtr_t)) +
+			(maxBlocks * sizeof(uint8_t)); // block nodes
+}
 
-	return num + 1;
+// start of a file backed manager, the manager header allocation follows it
+// and blocks 1 onwards follow that at blocksOffset
+#define Handle_FileMagic64 0x34364648u // 'HF64'
+#define Handle_FileVersion64 5u
+#define Handle_FileHeaderSize64 64u
+typedef struct Handle_FileHeader64 {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t elementSize;
+	uint32_t handlesPerBlock;
+	uint64_t maxBlocks;
+	uint32_t neverReissueOldHandles;
+	uint32_t flags;
+	uint64_t blocksOffset;
+	uint64_t blockStride;
+} Handle_FileHeader64;
+
+static uint8_t *FileBlock64(Handle_Manager64 *manager, uint64_t blockIndex) {
+	ASSERT(blockIndex > 0);
+	Handle_FileHeader64 const *header = (Handle_FileHeader64 const *) manager->fileMap->base;
+	return manager->fileMap->base + header->blocksOffset + ((blockIndex - 1) * header->blockStride);
 }
 
-// assumes power of 2
-AL2O3_FORCE_INLINE uint32_t SlowLog2(uint32_t num) {
-	if (num == 0) {
-		return 0;
+// file backed blocks are at fixed offsets, returns false if ptr isn't in an element of one
+static bool FilePtrToIndex64(Handle_Manager64 *manager, void const *ptr, uint64_t *actualIndex) {
+	uintptr_t const address = (uintptr_t) ptr;
+	size_t const dataSize = (size_t) (manager->handlesPerBlockMask + 1) * manager->elementSize;
+	Handle_FileHeader64 const *header = (Handle_FileHeader64 const *) manager->fileMap->base;
+	uintptr_t const block0 = (uintptr_t) (manager + 1);
+	uintptr_t const blocks = (uintptr_t) manager->fileMap->base + header->blocksOffset;
+
+	uint64_t blockIndex;
+	size_t offset;
+	if (address >= block0 && address < block0 + dataSize) {
+		blockIndex = 0;
+		offset = address - block0;
+	} else if (address >= blocks) {
+		blockIndex = ((address - blocks) / header->blockStride) + 1;
+		offset = (address - blocks) % header->blockStride;
+		if (blockIndex >= manager->maxBlocks || offset >= dataSize ||
+				!Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex])) {
+			return false;
+		}
+	} else {
+		return false;
+	}
+	*actualIndex = (blockIndex << manager->handlesPerBlockShift) | (offset / manager->elementSize);
+	return true;
+}
+
+// adds a block's elements to the address index for PtrToHandle
+static void IndexBlock64(Handle_Manager64 *manager, uint64_t blockIndex, uint8_t const *base) {
+	if (manager->fileMap) {
+		return; // found from the file offset instead
+	}
+	Handle_AddressIndexInsert(&manager->addressIndex,
+														base,
+														(size_t) (manager->handlesPerBlockMask + 1) * manager->elementSize,
+														blockIndex << manager->handlesPerBlockShift);
+}
+
+// returns zero'ed memory for a block, placed on the managers NUMA node if it has one
+static void *AllocBlockMemory64(Handle_Manager64 *manager, size_t size, uint64_t blockIndex) {
+	if (manager->fileMap) {
+		// already in the (sparse so zero) file, pages are placed as they are touched
+		manager->blockNodes[blockIndex] = (uint8_t) Handle_NumaBlockNodeNone;
+		return FileBlock64(manager, blockIndex);
+	}
+	if (manager->numaNode == Handle_NumaNodeNone) {
+		// not placed, first touch decides
+		manager->blockNodes[blockIndex] = (uint8_t) Handle_NumaBlockNodeNone;
+		return manager->allocator.alloc(manager->allocator.context, size, Handle_BlockAlignment);
+	}
+	uint32_t const node = Handle_NumaResolveNode(manager->numaNode);
+	manager->blockNodes[blockIndex] = (uint8_t) node;
+	return Handle_NumaAlloc(size, node);
+}
+
+static void FreeBlockMemory64(Handle_Manager64 *manager, void *ptr, size_t size) {
+	if (manager->fileMap) {
+		return; // unmapped with the file
+	}
+	if (manager->numaNode == Handle_NumaNodeNone) {
+		// copied first as ptr may be the manager itself
+		Handle_BlockAllocator const allocator = manager->allocator;
+		allocator.free(allocator.context, ptr, size);
+	} else {
+		Handle_NumaFree(ptr, size);
+	}
+}
+
+// links count adjacent fresh slots (within one block) onto the free list in one go
+static void LinkFreeRun64(Handle_Manager64 *manager, uint64_t firstIndex, uint64_t count) {
+	ASSERT(count > 0);
+	uint8_t *const base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[firstIndex >> manager->handlesPerBlockShift]);
+	uint8_t *const firstItem = base + ((firstIndex & manager->handlesPerBlockMask) * manager->elementSize);
+	for (uint64_t i = 0u; i < count - 1; ++i) {
+		uint64_t *addr = (uint64_t *) (firstItem + (i * manager->elementSize));
+		// add marker and point to next entry
+		*addr = 0xFFFFFF0000000000ull | (firstIndex + i + 1);
+	}
+
+	// link the run into the free list and attach existing free list to the end of it
+	Redo:;
+	platform_uint128_t const heads = Thread_AtomicLoad128Relaxed(&manager->freeListHeads);
+	uint64_t const headsFreePart = platform_GetLower128(heads);
+	platform_uint128_t const headsDeferFreePart = platform_ClearLower128(heads);
+	ASSERT(((platform_GetLower128(heads) & Handle_MaxHandles64) >> manager->handlesPerBlockShift) < manager->maxBlocks);
+
+	// we chain to the next entry in the free list without disturbing the deferred list
+	platform_uint128_t const newHeads = platform_Or128(headsDeferFreePart, platform_Load128From64(0xFFFFFF0000000000ull | firstIndex));
+	// point last new handle to existing free list (it might not be invalid by now)
+	*((uint64_t *) (firstItem + ((count - 1) * manager->elementSize))) = headsFreePart;
+
+	if (platform_Compare128(Thread_AtomicCompareExchange128Relaxed(&manager->freeListHeads, heads, newHeads), heads)) {
+		goto Redo; // something changed reverse the transaction
 	}
-	uint32_t count = 0;
-	do {
-		num >>= 1u;
-		count++;
-	} while ((num & 0x1u) == 0);
-	return count;
 }
 
 // return true to retry the allocation, false means no hope
@@ -50,49 +159,96 @@ static bool AllocNewBlock64(Handle_Manager64 *manager) {
 
 	ASSERT((baseIndex >> manager->handlesPerBlockShift) < manager->maxBlocks);
 
-	size_t const blockSize = ((manager->handlesPerBlockMask + 1) * manager->elementSize) +
-			((manager->handlesPerBlockMask + 1) * Handle_GenerationSize64);
+	size_t const blockSize = BlockSize64(manager->elementSize, manager->handlesPerBlockMask + 1, manager->seqLocked);
 
-	uint8_t *base = (uint8_t *) MEMORY_CALLOC(1, blockSize);
+	uint8_t *base = (uint8_t *) AllocBlockMemory64(manager, blockSize, baseIndex >> manager->handlesPerBlockShift);
 	if (!base) {
 		LOGWARNING("Out of memory!");
 		return false;
 	}
 
 	Thread_AtomicStorePtrRelaxed(manager->blocks + (baseIndex >> manager->handlesPerBlockShift), base);
-
-	// init free list for new block
-	for (uint32_t i = 0u; i < (manager->handlesPerBlockMask + 1); ++i) {
-		uint64_t const index = baseIndex + i;
-		uint64_t *addr = (uint64_t *) (base + (i * manager->elementSize));
-		// add marker and point to next entry
-		*addr = 0xFFFFFF0000000000ull | (index + 1);
+	IndexBlock64(manager, baseIndex >> manager->handlesPerBlockShift, base);
+
+	// the whole block is the fresh run, none of it is touched until handed out
+	// what was left of the old run goes on the free list
+	RedoX:;
+	uint64_t const old = Thread_AtomicLoad64Relaxed(&manager->freshRun);
+	if (Thread_AtomicCompareExchange64Relaxed(&manager->freshRun, old, baseIndex + 1) != old) {
+		goto RedoX;
+	}
+	if (old != 0) {
+		uint64_t const oldNext = old - 1;
+		LinkFreeRun64(manager, oldNext, (manager->handlesPerBlockMask + 1) - (oldNext & manager->handlesPerBlockMask));
 	}
 
-	// link the new block into the free list and attach existing free list to the
-	// end of this block
-	Redo:;
-	platform_uint128_t const heads = Thread_AtomicLoad128Relaxed(&manager->freeListHeads);
-	uint64_t const headsFreePart = platform_GetLower128(heads);
-	platform_uint128_t const headsDeferFreePart = platform_ClearLower128(heads);
-	ASSERT(((platform_GetLower128(heads) & Handle_MaxHandles64) >> manager->handlesPerBlockShift) < manager->maxBlocks);
+	return true;
+}
 
-	// we chain to the next entry in the free list without disturbing the deferred list
-	platform_uint128_t const newHeads = platform_Or128(headsDeferFreePart, platform_Load128From64(baseIndex));
-	// point last new handle to existing free list (it might not be invalid by now)
-	*((uint64_t *) (base + (manager->handlesPerBlockMask * manager->elementSize))) = headsFreePart;
+// points the blocks and blockNodes arrays into the header allocation
+static void AttachArrays64(Handle_Manager64 *manager) {
+	size_t const blockSize = BlockSize64(manager->elementSize, manager->handlesPerBlockMask + 1, manager->seqLocked);
+	uint8_t *base = (uint8_t *) (manager + 1);
+	// get to blocks space with 8 byte alignment guarenteed
+	manager->blocks = (Thread_AtomicPtr_t *) (((uintptr_t) base + blockSize + 0x8ull) & ~0x7ull);
+	manager->blockNodes = (uint8_t *) (manager->blocks + manager->maxBlocks);
+}
 
-	if (platform_Compare128(Thread_AtomicCompareExchange128Relaxed(&manager->freeListHeads, heads, newHeads), heads)) {
-		goto Redo; // something changed reverse the transaction
-	}
+// sets up a zero'ed header allocation with the embedded first block
+static void InitManager64(Handle_Manager64 *manager,
+													uint32_t elementSize,
+													uint32_t handlesPerBlock,
+													uint32_t maxBlocks,
+													bool neverReissueOldHandles,
+													uint32_t flags) {
+	manager->elementSize = elementSize;
+	manager->handlesPerBlockMask = handlesPerBlock - 1;
+	manager->handlesPerBlockShift = SlowLog2(handlesPerBlock);
+	manager->neverReissueOldHandles = neverReissueOldHandles;
+	manager->seqLocked = (flags & Handle_Manager64FlagSeqLock) != 0;
+	manager->singleThreaded = (flags & Handle_Manager64FlagSingleThreaded) != 0;
+	manager->ownerThread = (uint64_t) Thread_GetCurrentThreadID();
+	manager->maxBlocks = maxBlocks;
+	manager->numaNode = Handle_NumaNodeNone;
+	manager->allocator = *Handle_BlockAllocatorDefault();
 
-	return true;
+	uint8_t *base = (uint8_t *) (manager + 1);
+	AttachArrays64(manager);
+	Thread_AtomicStorePtrRelaxed(manager->blocks + 0, base);
+	Thread_AtomicStore64Relaxed(&manager->totalHandlesAllocated, handlesPerBlock);
+
+	// index zero is born generation 1
+	*(Handle_GenerationType64 *) ((base + (handlesPerBlock * manager->elementSize))) = 1;
+
+	// nothing is linked up front, the first block is the fresh run and only
+	// released slots go on the free lists, so creation doesn't touch the elements
+	Thread_AtomicStore128Relaxed(&manager->freeListHeads, platform_Load128From64(0));
+	Thread_AtomicStore64Relaxed(&manager->freshRun, 1);
 }
 
 AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64Create(uint32_t elementSize,
 																												uint32_t handlesPerBlock,
 																												uint32_t maxBlocks,
 																												bool neverReissueOldHandles) {
+	return Handle_Manager64CreateEx(elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles, Handle_NumaNodeNone, 0);
+}
+
+AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64CreateNuma(uint32_t elementSize,
+																														uint32_t handlesPerBlock,
+																														uint32_t maxBlocks,
+																														bool neverReissueOldHandles,
+																														int32_t numaNode) {
+	return Handle_Manager64CreateEx(elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles, numaNode, 0);
+}
+
+// allocator NULL is the default allocator, it isn't used for NUMA placed managers
+static Handle_Manager64 *CreateManager64(uint32_t elementSize,
+																				 uint32_t handlesPerBlock,
+																				 uint32_t maxBlocks,
+																				 bool neverReissueOldHandles,
+																				 int32_t numaNode,
+																				 uint32_t flags,
+																				 Handle_BlockAllocator const *allocator) {
 	ASSERT(elementSize >= sizeof(uint64_t));
 
 	if (!IsPow2(handlesPerBlock)) {
@@ -100,70 +256,169 @@ AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64Create(uint32_t elementSize,
 		handlesPerBlock = NextPow2(handlesPerBlock);
 	}
 
-	// each block has space for the data, the generation and the index into blocks for the base pointer
-	size_t const blockSize = (handlesPerBlock * elementSize) +
-			(handlesPerBlock * Handle_GenerationSize64);
+	bool const seqLocked = (flags & Handle_Manager64FlagSeqLock) != 0;
+
+	// a single node machine has nothing to gain, so degrade to the normal path
+	if (Handle_NumaNodeCount() <= 1) {
+		numaNode = Handle_NumaNodeNone;
+	}
 
 	// first block is attached directly to the header
-	size_t const allocSize = sizeof(Handle_Manager64)
-			+ blockSize +
-			8 + // padding to ensure atomics are at least 8 byte aligned
-			(maxBlocks * sizeof(Thread_AtomicPtr_t));
+	size_t const allocSize = HeaderAllocSize64(elementSize, handlesPerBlock, maxBlocks, seqLocked);
 
-	Handle_Manager64 *manager = (Handle_Manager64 *) MEMORY_CALLOC(1, allocSize);
+	if (!allocator) {
+		allocator = Handle_BlockAllocatorDefault();
+	}
+	uint32_t const headerNode = Handle_NumaResolveNode(numaNode);
+	Handle_Manager64 *manager = (numaNode == Handle_NumaNodeNone) ?
+			(Handle_Manager64 *) allocator->alloc(allocator->context, allocSize, Handle_BlockAlignment) :
+			(Handle_Manager64 *) Handle_NumaAlloc(allocSize, headerNode);
 	if (!manager) {
 		return NULL;
 	}
-	manager->elementSize = elementSize;
-	manager->handlesPerBlockMask = handlesPerBlock - 1;
-	manager->handlesPerBlockShift = SlowLog2(handlesPerBlock);
-	manager->neverReissueOldHandles = neverReissueOldHandles;
-	manager->maxBlocks = maxBlocks;
+	InitManager64(manager, elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles, flags);
+	manager->numaNode = numaNode;
+	manager->allocator = *allocator;
+	manager->blockNodes[0] = (uint8_t) ((numaNode == Handle_NumaNodeNone) ? Handle_NumaBlockNodeNone : headerNode);
+	IndexBlock64(manager, 0, (uint8_t const *) (manager + 1));
 
-	uint8_t *base = (uint8_t *) (manager + 1);
-	if (!base) {
-		MEMORY_FREE(manager);
-		return NULL;
-	}
-	// get to blocks space with 8 byte alignment guarenteed
-	manager->blocks = (Thread_AtomicPtr_t *) (((uintptr_t) base + blockSize + 0x8ull) & ~0x7ull);
-	Thread_AtomicStorePtrRelaxed(manager->blocks + 0, base);
-	Thread_AtomicStore64Relaxed(&manager->totalHandlesAllocated, handlesPerBlock);
+	return manager;
+}
+
+AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64CreateEx(uint32_t elementSize,
+																													uint32_t handlesPerBlock,
+																													uint32_t maxBlocks,
+																													bool neverReissueOldHandles,
+																													int32_t numaNode,
+																													uint32_t flags) {
+	return CreateManager64(elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles, numaNode, flags, NULL);
+}
+
+AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64CreateWithAllocator(uint32_t elementSize,
+																																		 uint32_t handlesPerBlock,
+																																		 uint32_t maxBlocks,
+																																		 bool neverReissueOldHandles,
+																																		 uint32_t flags,
+																																		 Handle_BlockAllocator const *allocator) {
+	return CreateManager64(elementSize,
+												 handlesPerBlock,
+												 maxBlocks,
+												 neverReissueOldHandles,
+												 Handle_NumaNodeNone,
+												 flags,
+												 allocator);
+}
+
+AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64CreateFile(char const *path,
+																														uint32_t elementSize,
+																														uint32_t handlesPerBlock,
+																														uint32_t maxBlocks,
+																														bool neverReissueOldHandles,
+																														uint32_t flags) {
+	ASSERT(elementSize >= sizeof(uint64_t));
 
-	// init free list for new block
-	// both gen and block index are zero'ed via calloc
-	for (uint32_t i = 0u; i < handlesPerBlock; ++i) {
-		uint64_t const index = i;
-		void *addr = base + (i * manager->elementSize);
-		*((uint64_t *) addr) = 0xFFFFFF0000000000ull | (index + 1);
+	if (!IsPow2(handlesPerBlock)) {
+		LOGWARNING("handlesPerBlock (%u) should be a power of 2, using %u", handlesPerBlock, NextPow2(handlesPerBlock));
+		handlesPerBlock = NextPow2(handlesPerBlock);
 	}
+	bool const seqLocked = (flags & Handle_Manager64FlagSeqLock) != 0;
 
-	// index zero is born generation 1
-	*(Handle_GenerationType64 *) ((base + (handlesPerBlock * manager->elementSize))) = 1;
+	// header, manager (with block 0) then the other blocks each 64 byte aligned
+	size_t const headerAllocSize = HeaderAllocSize64(elementSize, handlesPerBlock, maxBlocks, seqLocked);
+	uint64_t const blocksOffset = (Handle_FileHeaderSize64 + headerAllocSize + 0x3Full) & ~0x3Full;
+	uint64_t const blockStride = (BlockSize64(elementSize, handlesPerBlock, seqLocked) + 0x3Full) & ~0x3Full;
+	size_t const fileSize = (size_t) (blocksOffset + (blockStride * (maxBlocks - 1)));
 
-	// fix last index to point to the invalid marker
-	*((uint64_t *) (base + ((handlesPerBlock - 1) * manager->elementSize))) = 0;
+	Handle_FileMap *fileMap = Handle_FileMapOpen(path, fileSize);
+	if (!fileMap) {
+		return NULL;
+	}
+	Handle_FileHeader64 *header = (Handle_FileHeader64 *) fileMap->base;
+	Handle_Manager64 *manager = (Handle_Manager64 *) (fileMap->base + Handle_FileHeaderSize64);
+
+	if (fileMap->created) {
+		InitManager64(manager, elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles, flags);
+		manager->fileMap = fileMap;
+		manager->blockNodes[0] = (uint8_t) Handle_NumaBlockNodeNone;
+
+		header->version = Handle_FileVersion64;
+		header->elementSize = elementSize;
+		header->handlesPerBlock = handlesPerBlock;
+		header->maxBlocks = maxBlocks;
+		header->neverReissueOldHandles = neverReissueOldHandles;
+		header->flags = flags;
+		header->blocksOffset = blocksOffset;
+		header->blockStride = blockStride;
+		// magic last so a half made file is never reopened
+		header->magic = Handle_FileMagic64;
+		return manager;
+	}
+
+	if (header->magic != Handle_FileMagic64 ||
+			header->version != Handle_FileVersion64 ||
+			header->elementSize != elementSize ||
+			header->handlesPerBlock != handlesPerBlock ||
+			header->maxBlocks != maxBlocks ||
+			header->neverReissueOldHandles != (uint32_t) neverReissueOldHandles ||
+			header->flags != flags) {
+		LOGWARNING("%s is not a handle manager with matching parameters", path);
+		Handle_FileMapClose(fileMap);
+		return NULL;
+	}
 
-	// repoint heads to start of the free list with an empty deferred list
-	Thread_AtomicStore128Relaxed(&manager->freeListHeads, platform_Load128From64(0xFFFFFF0000000000ull));
+	// everything but the pointers is as it was, they are fixed up for the new mapping
+	manager->fileMap = fileMap;
+	manager->ownerThread = (uint64_t) Thread_GetCurrentThreadID();
+	memset(&manager->init, 0x0, sizeof(Handle_ElementInit));
+	memset(&manager->addressIndex, 0x0, sizeof(Handle_AddressIndex));
+	manager->numaNode = Handle_NumaNodeNone;
+	manager->allocator = *Handle_BlockAllocatorDefault();
+	AttachArrays64(manager);
+	uint64_t const blocksInUse =
+			(Thread_AtomicLoad64Relaxed(&manager->totalHandlesAllocated) + handlesPerBlock - 1) / handlesPerBlock;
+	Thread_AtomicStorePtrRelaxed(manager->blocks + 0, manager + 1);
+	for (uint64_t i = 1u; i < maxBlocks; ++i) {
+		Thread_AtomicStorePtrRelaxed(manager->blocks + i, (i < blocksInUse) ? FileBlock64(manager, i) : NULL);
+	}
 
 	return manager;
 }
 
+AL2O3_EXTERN_C void Handle_Manager64SetOwner(Handle_Manager64 *manager) {
+	ASSERT(manager->singleThreaded);
+	manager->ownerThread = (uint64_t) Thread_GetCurrentThreadID();
+	Thread_AtomicThreadFenceSeqCst();
+}
+
 AL2O3_EXTERN_C void Handle_Manager64Destroy(Handle_Manager64 *manager) {
 	if (!manager) {
 		return;
 	}
+	if (manager->fileMap) {
+		// the manager lives in the file so is unmapped with it
+		Handle_FileMap *fileMap = manager->fileMap;
+		Handle_FileMapFlush(fileMap, 0, fileMap->size, true);
+		Handle_FileMapClose(fileMap);
+		return;
+	}
+
+	size_t const blockSize = BlockSize64(manager->elementSize, manager->handlesPerBlockMask + 1, manager->seqLocked);
 
 	// 0th block is embedded
 	for (uint32_t i = 1u; i < manager->maxBlocks; ++i) {
 		void *ptr = Thread_AtomicLoadPtrRelaxed(&manager->blocks[i]);
 		if (ptr) {
-			MEMORY_FREE(ptr);
+			FreeBlockMemory64(manager, ptr, blockSize);
 		}
 	}
 
-	MEMORY_FREE(manager);
+	Handle_AddressIndexDestroy(&manager->addressIndex);
+	FreeBlockMemory64(manager,
+										manager,
+										HeaderAllocSize64(manager->elementSize,
+																		manager->handlesPerBlockMask + 1,
+																		manager->maxBlocks,
+																		manager->seqLocked));
 }
 
 
@@ -171,33 +426,152 @@ AL2O3_EXTERN_C Handle_Manager64 *Handle_Manager64Clone(Handle_Manager64 *src) {
 	if (!src) {
 		return NULL;
 	}
-	Handle_Manager64 *manager = Handle_Manager64Create(src->elementSize,
-																										 src->handlesPerBlockMask + 1,
-																										 src->maxBlocks,
-																										 src->neverReissueOldHandles);
+	Handle_Manager64 *manager = CreateManager64((uint32_t) src->elementSize,
+																							src->handlesPerBlockMask + 1,
+																							(uint32_t) src->maxBlocks,
+																							src->neverReissueOldHandles,
+																							src->numaNode,
+																							(src->seqLocked ? Handle_Manager64FlagSeqLock : 0) |
+																									(src->singleThreaded ? Handle_Manager64FlagSingleThreaded : 0),
+																							&src->allocator);
 	if(!manager) {
 		return NULL;
 	}
-	size_t const blockSize = ((src->handlesPerBlockMask + 1) * src->elementSize) +
-														((src->handlesPerBlockMask + 1) * Handle_GenerationSize64);
+	size_t const blockSize = BlockSize64(src->elementSize, src->handlesPerBlockMask + 1, src->seqLocked);
 
 	// copy over the 1st embedded block
 	memcpy(manager->blocks[0].nonatomic, src->blocks[0].nonatomic, blockSize);
 	for (uint32_t i = 1u; i < src->maxBlocks; ++i) {
 		void *ptr = Thread_AtomicLoadPtrRelaxed(&src->blocks[i]);
 		if (ptr) {
-			manager->blocks[i].nonatomic = MEMORY_MALLOC(blockSize);
+			manager->blocks[i].nonatomic = AllocBlockMemory64(manager, blockSize, i);
 			memcpy(manager->blocks[i].nonatomic, src->blocks[i].nonatomic, blockSize);
+			IndexBlock64(manager, i, (uint8_t const *) manager->blocks[i].nonatomic);
 		}
 	}
 
 	manager->totalHandlesAllocated = src->totalHandlesAllocated;
 	manager->freeListHeads = src->freeListHeads;
+	manager->freshRun = src->freshRun;
+	manager->init = src->init;
+	manager->resetCursor = src->resetCursor;
+	manager->resetLimit = src->resetLimit;
 
 	return manager;
 }
 
-AL2O3_EXTERN_C Handle_Handle64 Handle_Manager64Alloc(Handle_Manager64 *manager) {
+// after a Reset, takes the next index that hasn't been reissued yet
+static Handle_Handle64 AllocReset64(Handle_Manager64 *manager, void **element) {
+	RedoC:;
+	uint64_t const actualIndex = Thread_AtomicLoad64Relaxed(&manager->resetCursor);
+	if (actualIndex >= manager->resetLimit) {
+		Handle_Handle64 invalid = {0};
+		return invalid;
+	}
+	if (Thread_AtomicCompareExchange64Relaxed(&manager->resetCursor, actualIndex, actualIndex + 1) != actualIndex) {
+		goto RedoC;
+	}
+
+	uint8_t *const base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[actualIndex >> manager->handlesPerBlockShift]);
+	ASSERT(base != NULL);
+	uint64_t const index = actualIndex & manager->handlesPerBlockMask;
+	Handle_GenerationType64 *gen = (Handle_GenerationType64 *) (base +
+			((manager->handlesPerBlockMask + 1) * manager->elementSize) +
+			(index * Handle_GenerationSize64));
+	if (*gen & Handle_GenerationFlagsLeaked64) {
+		goto RedoC; // lost for good
+	}
+	*gen = *gen | Handle_GenerationFlagsAlloced64;
+
+	*element = base + (index * manager->elementSize);
+	Handle_Handle64 handle = HANDLE_MANAGER64_MAKEHANDLE(gen, actualIndex);
+	return handle;
+}
+
+// bumps the next never issued slot off the fresh run, invalid once it is used up
+static Handle_Handle64 AllocFresh64(Handle_Manager64 *manager, void **element) {
+	RedoN:;
+	uint64_t const run = Thread_AtomicLoad64Relaxed(&manager->freshRun);
+	if (run == 0) {
+		Handle_Handle64 invalid = {0};
+		return invalid;
+	}
+	uint64_t const actualIndex = run - 1;
+	// the run ends with its block
+	uint64_t const newRun = ((actualIndex + 1) & manager->handlesPerBlockMask) ? run + 1 : 0;
+	if (manager->singleThreaded) {
+		manager->freshRun.nonatomic = newRun;
+	} else if (Thread_AtomicCompareExchange64Relaxed(&manager->freshRun, run, newRun) != run) {
+		goto RedoN;
+	}
+
+	uint8_t *const base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[actualIndex >> manager->handlesPerBlockShift]);
+	ASSERT(base != NULL);
+	uint64_t const index = actualIndex & manager->handlesPerBlockMask;
+	Handle_GenerationType64 *gen = (Handle_GenerationType64 *) (base +
+			((manager->handlesPerBlockMask + 1) * manager->elementSize) +
+			(index * Handle_GenerationSize64));
+	*gen = *gen | Handle_GenerationFlagsAlloced64;
+
+	*element = base + (index * manager->elementSize);
+	Handle_Handle64 handle = HANDLE_MANAGER64_MAKEHANDLE(gen, actualIndex);
+	return handle;
+}
+
+// single threaded managers, the same as below with plain loads and stores
+static Handle_Handle64 AllocSingle64(Handle_Manager64 *manager, void **element) {
+	ASSERT(manager->ownerThread == (uint64_t) Thread_GetCurrentThreadID());
+	uint32_t noFreeCount = 0;
+	Redo:;
+	platform_uint128_t const heads = manager->freeListHeads.nonatomic;
+	uint64_t const headsFreePart = platform_GetLower128(heads);
+	platform_uint128_t const headsDeferFreePart = platform_ClearLower128(heads);
+	if (headsFreePart == 0) {
+		// never issued slots go before released ones
+		Handle_Handle64 const fresh = AllocFresh64(manager, element);
+		if (fresh.handle != 0) {
+			return fresh;
+		}
+		if (!platform_CompareToZero128(headsDeferFreePart)) {
+			manager->freeListHeads.nonatomic = platform_ShiftUpperToLower128(headsDeferFreePart);
+			goto Redo;
+		}
+		Handle_Handle64 const reset = AllocReset64(manager, element);
+		if (reset.handle != 0) {
+			return reset;
+		}
+		bool retry = AllocNewBlock64(manager);
+		if (retry == false || noFreeCount >= 1000) {
+			LOGWARNING("Manager has run out of handles");
+			Handle_Handle64 invalid = {0}; // fail
+			return invalid;
+		}
+		noFreeCount++;
+		goto Redo;
+	}
+
+	uint64_t const actualIndex = headsFreePart & Handle_MaxHandles64;
+	uint8_t *const base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[actualIndex >> manager->handlesPerBlockShift]);
+	ASSERT(base != NULL);
+	uint64_t index = actualIndex & manager->handlesPerBlockMask;
+	uint64_t *const item = (uint64_t *) (base + (index * manager->elementSize));
+	manager->freeListHeads.nonatomic = platform_Or128(headsDeferFreePart, platform_Load128From64(*item));
+
+	*element = item;
+	Handle_GenerationType64 *gen = (Handle_GenerationType64 *) (base +
+			((manager->handlesPerBlockMask + 1) * manager->elementSize) +
+			(index * Handle_GenerationSize64));
+	*gen = *gen | Handle_GenerationFlagsAlloced64; // add in the alloced flag
+
+	Handle_Handle64 handle = HANDLE_MANAGER64_MAKEHANDLE(gen, actualIndex);
+	return handle;
+}
+
+// pops a free slot, the element is left for the init policy
+static Handle_Handle64 AllocNoInit(Handle_Manager64 *manager, void **element) {
+	if (manager->singleThreaded) {
+		return AllocSingle64(manager, element);
+	}
 	uint32_t noFreeCount = 0;
 	Redo:;
 	// heads has 2 linked list packed in a 128 bit location. Its our transaction backout test as well
@@ -208,11 +582,21 @@ AL2O3_EXTERN_C Handle_Handle64 Handle_Manager64Alloc(Handle_Manager64 *manager)
 
 	// check to see if the free list is empty
 	if (headsFreePart == 0) {
+		// never issued slots go before released ones
+		Handle_Handle64 const fresh = AllocFresh64(manager, element);
+		if (fresh.handle != 0) {
+			return fresh;
+		}
 		// we need to swap the deferred into the free list as free list is empty
 		if (platform_CompareToZero128(headsDeferFreePart)) {
 			// the deferred list is empty, so we have no free handles
 			// we now do the tricky part of allocating a new block in a lock free
 			// way *gulp*
+			// unless a Reset has left slots to reissue
+			Handle_Handle64 const reset = AllocReset64(manager, element);
+			if (reset.handle != 0) {
+				return reset;
+			}
 			bool retry = AllocNewBlock64(manager);
 			if (retry == false || noFreeCount >= 1000) {
 				LOGWARNING("Manager has run out of handles");
@@ -248,8 +632,7 @@ AL2O3_EXTERN_C Handle_Handle64 Handle_Manager64Alloc(Handle_Manager64 *manager)
 	}
 
 	// the item is now ours to abuse
-	// clear it out ready for its new life
-	memset(item, 0x0, manager->elementSize);
+	*element = item;
 
 	// now make the handle and return it
 	// point to generation data for this index
@@ -262,6 +645,53 @@ AL2O3_EXTERN_C Handle_Handle64 Handle_Manager64Alloc(Handle_Manager64 *manager)
 	return handle;
 }
 
+AL2O3_EXTERN_C Handle_Handle64 Handle_Manager64Alloc(Handle_Manager64 *manager) {
+	void *element = NULL;
+	Handle_Handle64 const handle = AllocNoInit(manager, &element);
+	if (handle.handle != 0) {
+		// clear it out ready for its new life
+		Handle_InitElements(&manager->init, element, manager->elementSize, 1);
+		Handle_InitFence(&manager->init);
+	}
+	return handle;
+}
+
+AL2O3_EXTERN_C uint64_t Handle_Manager64AllocBatch(Handle_Manager64 *manager, Handle_Handle64 *handles, uint64_t count) {
+	uint8_t *runStart = NULL;
+	uint32_t runCount = 0;
+	uint64_t allocated = 0;
+	for (; allocated < count; ++allocated) {
+		void *element = NULL;
+		Handle_Handle64 const handle = AllocNoInit(manager, &element);
+		if (handle.handle == 0) {
+			break;
+		}
+		handles[allocated] = handle;
+		// fresh and recently released slots tend to be next to each other
+		if (runStart && (uint8_t *) element == runStart + (runCount * manager->elementSize)) {
+			runCount++;
+			continue;
+		}
+		if (runStart) {
+			Handle_InitElements(&manager->init, runStart, manager->elementSize, runCount);
+		}
+		runStart = (uint8_t *) element;
+		runCount = 1;
+	}
+	if (runStart) {
+		Handle_InitElements(&manager->init, runStart, manager->elementSize, runCount);
+	}
+	Handle_InitFence(&manager->init);
+	return allocated;
+}
+
+AL2O3_EXTERN_C void Handle_Manager64SetInitPolicy(Handle_Manager64 *manager, Handle_InitPolicy policy, Handle_InitFunc func, void *userData) {
+	ASSERT(policy != Handle_InitPolicyCallback || func != NULL);
+	manager->init.policy = policy;
+	manager->init.func = func;
+	manager->init.userData = userData;
+}
+
 AL2O3_EXTERN_C void Handle_Manager64Release(Handle_Manager64 *manager, Handle_Handle64 handle) {
 	ASSERT((handle.handle & Handle_MaxHandles64) < Thread_AtomicLoad64Relaxed(&manager->totalHandlesAllocated));
 	ASSERT(Handle_Manager64IsValid(manager, handle));
@@ -306,6 +736,14 @@ AL2O3_EXTERN_C void Handle_Manager64Release(Handle_Manager64 *manager, Handle_Ha
 
 	platform_uint128_t indexInUpper = platform_LoadUpper128From64(handle.handle | 0xFFFFFF0000000000ull);
 
+	if (manager->singleThreaded) {
+		ASSERT(manager->ownerThread == (uint64_t) Thread_GetCurrentThreadID());
+		platform_uint128_t const heads = manager->freeListHeads.nonatomic;
+		*item = platform_GetUpper128(heads);
+		manager->freeListHeads.nonatomic = platform_Or128(indexInUpper, platform_ClearUpper128(heads));
+		return;
+	}
+
 	RedoF:;
 	// add it to the deferred list without changing the free list
 	// repeat until we get a transaction okay response from CAS
@@ -321,3 +759,120 @@ AL2O3_EXTERN_C void Handle_Manager64Release(Handle_Manager64 *manager, Handle_Ha
 	}
 
 }
+
+AL2O3_EXTERN_C uint64_t Handle_Manager64NumaBlockCount(Handle_Manager64 *manager, uint32_t node) {
+	uint64_t count = 0;
+	for (uint64_t i = 0u; i < manager->maxBlocks; ++i) {
+		if (Thread_AtomicLoadPtrRelaxed(&manager->blocks[i]) && manager->blockNodes[i] == node) {
+			count++;
+		}
+	}
+	return count;
+}
+
+AL2O3_EXTERN_C Handle_Handle64 Handle_Manager64PtrToHandle(Handle_Manager64 *manager, void const *ptr) {
+	Handle_Handle64 invalid = {0};
+	uint64_t actualIndex;
+	if (manager->fileMap) {
+		if (!FilePtrToIndex64(manager, ptr, &actualIndex)) {
+			return invalid;
+		}
+	} else {
+		Handle_AddressRange range;
+		if (!Handle_AddressIndexFind(&manager->addressIndex, ptr, &range)) {
+			return invalid;
+		}
+		actualIndex = range.firstIndex + (((uintptr_t) ptr - range.base) / manager->elementSize);
+	}
+	// the current generation if alloced, invalid if released
+	return Handle_Manager64IndexToHandle(manager, actualIndex);
+}
+
+// one pass over a block's generations, no data dependent branches so it vectorises
+static void BumpGenerations64(Handle_GenerationType64 *gens, uint64_t count, bool neverReissueOldHandles) {
+	uint32_t const wrapLeaks = neverReissueOldHandles ? Handle_GenerationFlagsLeaked64 : 0u;
+	for (uint64_t i = 0u; i < count; ++i) {
+		uint32_t const gen = gens[i];
+		uint32_t const gene = (gen + 1u) & 0x00FFFFFFu;
+		// leaked stays leaked, the alloced flag goes
+		uint32_t const leaked = (gen & Handle_GenerationFlagsLeaked64) | (gene == 0 ? wrapLeaks : 0u);
+		gens[i] = leaked ? Handle_GenerationFlagsLeaked64 : gene;
+	}
+}
+
+AL2O3_EXTERN_C void Handle_Manager64Reset(Handle_Manager64 *manager) {
+	uint64_t const blockHandles = manager->handlesPerBlockMask + 1;
+	for (uint64_t i = 0u; i < manager->maxBlocks; ++i) {
+		uint8_t *base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[i]);
+		if (!base) {
+			continue;
+		}
+		BumpGenerations64((Handle_GenerationType64 *) (base + (blockHandles * manager->elementSize)),
+											blockHandles,
+											manager->neverReissueOldHandles);
+	}
+
+	// handle 0 special case (a wrap when never reissuing has leaked it instead)
+	Handle_GenerationType64 *gen0 = (Handle_GenerationType64 *) (
+			(uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[0]) + (blockHandles * manager->elementSize));
+	if (*gen0 == 0) {
+		*gen0 = 1;
+	}
+
+	// every slot whether free, deferred or live is now reissued via the cursor
+	Thread_AtomicStore128Relaxed(&manager->freeListHeads, platform_Load128From64(0));
+	Thread_AtomicStore64Relaxed(&manager->freshRun, 0);
+	manager->resetLimit = Thread_AtomicLoad64Relaxed(&manager->totalHandlesAllocated);
+	Thread_AtomicStore64Relaxed(&manager->resetCursor, 0);
+}
+
+AL2O3_EXTERN_C bool Handle_Manager64FileFlush(Handle_Manager64 *manager, bool sync) {
+	if (!manager->fileMap) {
+		return false;
+	}
+	return Handle_FileMapFlush(manager->fileMap, 0, manager->fileMap->size, sync);
+}
+
+AL2O3_EXTERN_C void Handle_Manager64FileAdvise(Handle_Manager64 *manager, Handle_FileAdvice advice) {
+	if (!manager->fileMap) {
+		return;
+	}
+	Handle_FileMapAdvise(manager->fileMap, 0, manager->fileMap->size, advice);
+}
+
+AL2O3_EXTERN_C bool Handle_Manager64ReadConsistent(Handle_Manager64 *manager,
+																									 Handle_Handle64 handle,
+																									 void *dst,
+																									 size_t size) {
+	ASSERT(size <= manager->elementSize);
+	if (!Handle_Manager64IsValid(manager, handle)) {
+		return false;
+	}
+	Thread_Atomic32_t const *seq = Handle_Manager64HandleToSequence(manager, handle);
+	// not via HandleToPtr, the handle can die at any point and we find out below
+	uint64_t const actualIndex = (handle.handle & Handle_MaxHandles64);
+	uint8_t const *const base = (uint8_t const *) Thread_AtomicLoadPtrRelaxed(
+			&manager->blocks[actualIndex >> manager->handlesPerBlockShift]);
+	uint8_t const *const src = base + ((actualIndex & manager->handlesPerBlockMask) * manager->elementSize);
+
+	Redo:;
+	uint32_t const before = Thread_AtomicLoad32Relaxed((Thread_Atomic32_t *) seq);
+	if (before & 0x1u) {
+		goto Redo; // writer in progress
+	}
+	// the element reads must not start before we have the sequence
+	Thread_AtomicThreadFenceAcquire();
+	memcpy(dst, src, size);
+	// and must be done before we check it again
+	Thread_AtomicThreadFenceAcquire();
+	uint32_t const after = Thread_AtomicLoad32Relaxed((Thread_Atomic32_t *) seq);
+
+	// a release (and possible realloc) during the copy changes the generation
+	if (!Handle_Manager64IsValid(manager, handle)) {
+		return false;
+	}
+	if (before != after) {
+		goto Redo; // torn read
+	}
+	return true;
+}
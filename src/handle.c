@@ -2,97 +2,395 @@
 #include "al2o3_platform/platform.h"
 #include "al2o3_memory/memory.h"
 #include "al2o3_thread/atomic.h"
+#include "al2o3_thread/thread.h"
 #include "al2o3_handle/handle.h"
+#include "internal.h"
 
-AL2O3_FORCE_INLINE bool IsPow2(uint32_t num) {
-	return ((num & (num - 1)) == 0);
+// tracked blocks have a dirty bit per slot after the generations, 4 byte aligned
+static size_t DirtyOffset32(uint32_t elementSize, size_t blockHandles) {
+	return ((blockHandles * elementSize) + (blockHandles * sizeof(uint8_t)) + 0x3ull) & ~0x3ull;
 }
 
-AL2O3_FORCE_INLINE uint32_t NextPow2(uint32_t num) {
-	num -= 1;
-	num |= num >> 16u;
-	num |= num >> 8u;
-	num |= num >> 4u;
-	num |= num >> 2u;
-	num |= num >> 1u;
+// bytes of a block with blockHandles slots, the data, the generations and any dirty bits
+static size_t BlockBytes32(uint32_t elementSize, size_t blockHandles, bool dirtyTracked) {
+	if (dirtyTracked) {
+		return DirtyOffset32(elementSize, blockHandles) + (((blockHandles + 31u) / 32u) * sizeof(uint32_t));
+	}
+	return (blockHandles * elementSize) + (blockHandles * sizeof(uint8_t));
+}
 
-	return num + 1;
+// size of the header allocation, includes the embedded first block
+// growable managers have no blocks array (maxBlocks 0) but a directory root
+static size_t HeaderAllocSize32(uint32_t elementSize,
+																uint32_t handlesPerBlock,
+																uint32_t maxBlocks,
+																uint32_t rootSize,
+																bool dirtyTracked) {
+	size_t const blockSize = BlockBytes32(elementSize, handlesPerBlock, dirtyTracked);
+	return sizeof(Handle_Manager32)
+			+ blockSize +
+			8 + // padding to ensure atomics are at least 8 byte aligned
+			(rootSize * sizeof(Thread_AtomicPtr_t)) +
+			(maxBlocks * sizeof(Thread_AtomicPtr_t)) +
+			(maxBlocks * sizeof(uint8_t)); // block nodes
 }
 
-// assumes power of 2
-AL2O3_FORCE_INLINE uint32_t SlowLog2(uint32_t num) {
-	if (num == 0) {
-		return 0;
+static size_t HeaderSize32(Handle_Manager32 const *manager) {
+	if (manager->directory) {
+		uint32_t const rootSize = manager->maxBlocks >> manager->directoryPageShift;
+		return HeaderAllocSize32(manager->elementSize, manager->handlesPerBlockMask + 1, 0, rootSize, manager->dirtyTracked);
 	}
-	uint32_t count = 0;
-	do {
-		num >>= 1u;
-		count++;
-	} while ((num & 0x1u) == 0);
-	return count;
+	return HeaderAllocSize32(manager->elementSize,
+													 manager->handlesPerBlockMask + 1,
+													 manager->maxBlocks,
+													 0,
+													 manager->dirtyTracked);
 }
 
-// return true to retry the allocation, false means no hope
-static bool AllocNewBlock32(Handle_Manager32 *manager) {
+static size_t DirectoryPageSize32(Handle_Manager32 const *manager) {
+	return ((size_t) 1u << manager->directoryPageShift) * (sizeof(Thread_AtomicPtr_t) + sizeof(uint8_t));
+}
+
+// the pointer slot for a block, growable managers allocate its directory page on first use
+static Thread_AtomicPtr_t *BlockEntry32(Handle_Manager32 *manager, uint32_t blockIndex) {
+	if (!manager->directory) {
+		return manager->blocks + blockIndex;
+	}
+	Thread_AtomicPtr_t *root = manager->directory + (blockIndex >> manager->directoryPageShift);
+	Thread_AtomicPtr_t *page = (Thread_AtomicPtr_t *) Thread_AtomicLoadPtrRelaxed(root);
+	if (!page) {
+		size_t const pageSize = DirectoryPageSize32(manager);
+		page = (Thread_AtomicPtr_t *) manager->allocator.alloc(manager->allocator.context, pageSize, Handle_BlockAlignment);
+		if (!page) {
+			return NULL;
+		}
+		// another thread may have beaten us to it, use theirs
+		void *const existing = Thread_AtomicCompareExchangePtrRelaxed(root, NULL, page);
+		if (existing != NULL) {
+			manager->allocator.free(manager->allocator.context, page, pageSize);
+			page = (Thread_AtomicPtr_t *) existing;
+		}
+	}
+	return page + (blockIndex & ((1u << manager->directoryPageShift) - 1u));
+}
+
+// upper bound of blocks to visit, growable managers only look at claimed ones
+static uint32_t BlockLimit32(Handle_Manager32 *manager) {
+	if (!manager->directory) {
+		return manager->maxBlocks;
+	}
+	uint32_t const claimed = (Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) + manager->handlesPerBlockMask) >>
+			manager->handlesPerBlockShift;
+	return claimed < manager->maxBlocks ? claimed : manager->maxBlocks;
+}
+
+// where the node of a block is recorded, its pointer slot must exist
+static uint8_t *BlockNode32(Handle_Manager32 *manager, uint32_t blockIndex) {
+	if (!manager->directory) {
+		return manager->blockNodes + blockIndex;
+	}
+	uint32_t const pageSize = 1u << manager->directoryPageShift;
+	uint8_t *page = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->directory[blockIndex >> manager->directoryPageShift]);
+	ASSERT(page);
+	return page + (pageSize * sizeof(Thread_AtomicPtr_t)) + (blockIndex & (pageSize - 1u));
+}
+
+// bytes of a block, the data and the generations (and dirty bits if tracked)
+static size_t BlockSize32(Handle_Manager32 const *manager, uint32_t blockIndex) {
+	size_t const blockHandles = manager->geometric ?
+			((size_t) manager->handlesPerBlockMask + 1) << blockIndex :
+			(size_t) manager->handlesPerBlockMask + 1;
+	return BlockBytes32(manager->elementSize, blockHandles, manager->dirtyTracked);
+}
+
+// adds a block's elements to the address index for PtrToHandle
+static void IndexBlock32(Handle_Manager32 *manager, uint32_t blockIndex, uint8_t const *base) {
+	uint32_t const blockHandles = manager->geometric ?
+			(manager->handlesPerBlockMask + 1) << blockIndex :
+			manager->handlesPerBlockMask + 1;
+	// geometric block k starts at base * (2^k - 1)
+	uint32_t const firstIndex = manager->geometric ?
+			blockHandles - (manager->handlesPerBlockMask + 1) :
+			blockIndex << manager->handlesPerBlockShift;
+	Handle_AddressIndexInsert(&manager->addressIndex, base, (size_t) blockHandles * manager->elementSize, firstIndex);
+}
+
+static Thread_Atomic32_t *DirtyBits32(Handle_Manager32 const *manager, uint8_t *base, uint32_t blockHandles) {
+	ASSERT(manager->dirtyTracked);
+	return (Thread_Atomic32_t *) (base + DirtyOffset32(manager->elementSize, blockHandles));
+}
+
+// the whole block is dirty, only when nothing else can touch it (new or under Reset)
+static void MarkAllDirty32(Handle_Manager32 const *manager, uint8_t *base, uint32_t blockHandles) {
+	if (!manager->dirtyTracked) {
+		return;
+	}
+	Thread_Atomic32_t *bits = DirtyBits32(manager, base, blockHandles);
+	for (uint32_t i = 0u; i < blockHandles; i += 32u) {
+		uint32_t const count = blockHandles - i;
+		Thread_AtomicStore32Relaxed(bits + (i / 32u), count >= 32u ? 0xFFFFFFFFu : (1u << count) - 1u);
+	}
+}
+
+static void MarkDirty32(Handle_Manager32 const *manager, uint8_t *base, uint32_t blockHandles, uint32_t index) {
+	if (!manager->dirtyTracked) {
+		return;
+	}
+	Thread_Atomic32_t *word = DirtyBits32(manager, base, blockHandles) + (index / 32u);
+	uint32_t const bit = 1u << (index & 31u);
+	RedoM:;
+	uint32_t const old = Thread_AtomicLoad32Relaxed(word);
+	if (old & bit) {
+		return; // the common case for hot slots, no write needed
+	}
+	if (Thread_AtomicCompareExchange32Relaxed(word, old, old | bit) != old) {
+		goto RedoM;
+	}
+}
+
+static void MarkDirtyIndex32(Handle_Manager32 *manager, uint32_t actualIndex) {
+	if (!manager->dirtyTracked) {
+		return;
+	}
+	uint32_t blockIndex;
+	uint32_t index;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &index);
+	MarkDirty32(manager, Handle_Manager32BlockBase(manager, blockIndex), blockHandles, index);
+}
+
+// returns zero'ed memory for a block, placed on the managers NUMA node if it has one
+static void *AllocBlockMemory32(Handle_Manager32 *manager, size_t size, uint32_t blockIndex) {
+	if (manager->numaNode == Handle_NumaNodeNone) {
+		// not placed, first touch decides
+		*BlockNode32(manager, blockIndex) = (uint8_t) Handle_NumaBlockNodeNone;
+		return manager->allocator.alloc(manager->allocator.context, size, Handle_BlockAlignment);
+	}
+	uint32_t const node = Handle_NumaResolveNode(manager->numaNode);
+	*BlockNode32(manager, blockIndex) = (uint8_t) node;
+	return Handle_NumaAlloc(size, node);
+}
+
+static void FreeBlockMemory32(Handle_Manager32 *manager, void *ptr, size_t size) {
+	if (manager->numaNode == Handle_NumaNodeNone) {
+		// copied first as ptr may be the manager itself
+		Handle_BlockAllocator const allocator = manager->allocator;
+		allocator.free(allocator.context, ptr, size);
+	} else {
+		Handle_NumaFree(ptr, size);
+	}
+}
+
+// claims and allocates the next block, its slots are on no list yet. NULL on
+// failure, with retry set if it is worth trying again
+static uint8_t *ClaimNewBlock32(Handle_Manager32 *manager, uint32_t *outBaseIndex, uint32_t *outBlockHandles, bool *retry) {
+	*retry = false;
 	if (Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) >= Handle_MaxHandles32) {
 		LOGWARNING("Allocated all 16.7 million handles already!");
-		return false;
+		return NULL;
 	}
-	// first thing we need to do is claim our new index range
-	uint32_t baseIndex =
-			Thread_AtomicFetchAdd32Relaxed(&manager->totalHandlesAllocated, (manager->handlesPerBlockMask + 1));
+	uint32_t baseIndex;
+	uint32_t blockHandles;
+	if (manager->geometric) {
+		// the next block is as big as all before it plus the first, claim it whole
+		baseIndex = Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated);
+		blockHandles = baseIndex + manager->handlesPerBlockMask + 1;
+		if ((SlowLog2(blockHandles) - manager->handlesPerBlockShift) >= manager->maxBlocks ||
+				(uint64_t) baseIndex + blockHandles > (uint64_t) Handle_MaxHandles32 + 1) {
+			LOGWARNING("Trying to allocate more than %i blocks! Increase block size or max blocks", manager->maxBlocks);
+			return NULL;
+		}
+		if (Thread_AtomicCompareExchange32Relaxed(&manager->totalHandlesAllocated, baseIndex, baseIndex + blockHandles) != baseIndex) {
+			*retry = true; // someone else grew it, retry the allocation
+			return NULL;
+		}
+	} else {
+		// first thing we need to do is claim our new index range
+		blockHandles = manager->handlesPerBlockMask + 1;
+		baseIndex = Thread_AtomicFetchAdd32Relaxed(&manager->totalHandlesAllocated, blockHandles);
 
-	if (baseIndex >= (manager->handlesPerBlockMask + 1) * manager->maxBlocks) {
-		LOGWARNING("Trying to allocate more than %i blocks! Increase block size or max blocks", manager->maxBlocks);
-		Thread_AtomicFetchAdd32Relaxed(&manager->totalHandlesAllocated, -(int32_t)(manager->handlesPerBlockMask + 1));
-		return false;
+		if (baseIndex >= blockHandles * manager->maxBlocks) {
+			LOGWARNING("Trying to allocate more than %i blocks! Increase block size or max blocks", manager->maxBlocks);
+			Thread_AtomicFetchAdd32Relaxed(&manager->totalHandlesAllocated, -(int32_t) blockHandles);
+			return NULL;
+		}
 	}
 
-	ASSERT((baseIndex >> manager->handlesPerBlockShift) < manager->maxBlocks);
-
-	size_t const blockSize = ((manager->handlesPerBlockMask + 1) * manager->elementSize) +
-			((manager->handlesPerBlockMask + 1) * sizeof(uint8_t));
+	uint32_t blockIndex;
+	uint32_t slot;
+	Handle_Manager32Locate(manager, baseIndex, &blockIndex, &slot);
+	ASSERT(slot == 0);
+	ASSERT(blockIndex < manager->maxBlocks);
 
-	uint8_t *base = (uint8_t *) MEMORY_CALLOC(1, blockSize);
+	Thread_AtomicPtr_t *const entry = BlockEntry32(manager, blockIndex);
+	uint8_t *base = entry ? (uint8_t *) AllocBlockMemory32(manager, BlockSize32(manager, blockIndex), blockIndex) : NULL;
 	if (!base) {
 		LOGWARNING("Out of memory!");
-		return false;
+		return NULL;
 	}
+	MarkAllDirty32(manager, base, blockHandles);
 
-	Thread_AtomicStorePtrRelaxed(manager->blocks + (baseIndex >> manager->handlesPerBlockShift), base);
+	Thread_AtomicStorePtrRelaxed(entry, base);
+	IndexBlock32(manager, blockIndex, base);
+	*outBaseIndex = baseIndex;
+	*outBlockHandles = blockHandles;
+	return base;
+}
 
-	// init free list for new block
-	for (uint32_t i = 0u; i < (manager->handlesPerBlockMask + 1); ++i) {
-		uint32_t const index = baseIndex + i;
-		uint32_t *addr = (uint32_t *) (base + (i * manager->elementSize));
-		// add marker and point to next entry
-		*addr = 0xFF000000u | (index + 1);
+static uint32_t *ItemLink32(Handle_Manager32 *manager, uint32_t actualIndex) {
+	uint32_t blockIndex;
+	uint32_t index;
+	Handle_Manager32Locate(manager, actualIndex, &blockIndex, &index);
+	ASSERT(blockIndex < manager->maxBlocks);
+	uint8_t *base = Handle_Manager32BlockBase(manager, blockIndex);
+	return (uint32_t *) (base + (index * manager->elementSize));
+}
+
+// links count adjacent issuable slots (within one block) onto the free list in one go
+static void LinkFreeRun32(Handle_Manager32 *manager, uint8_t *firstItem, uint32_t firstIndex, uint32_t count) {
+	ASSERT(count > 0);
+	uint32_t blockIndex;
+	uint32_t slot;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, firstIndex, &blockIndex, &slot);
+	uint8_t *const gens = Handle_Manager32BlockBase(manager, blockIndex) + (blockHandles * manager->elementSize) + slot;
+	for (uint32_t i = 0u; i < count - 1; ++i) {
+		uint32_t *addr = (uint32_t *) (firstItem + (i * manager->elementSize));
+		// point to next entry
+		*addr = FreeLink32(gens[i + 1], firstIndex + i + 1);
 	}
+	uint32_t *tail = (uint32_t *) (firstItem + ((count - 1) * manager->elementSize));
 
-	// link the new block into the free list and attach existing free list to the
-	// end of this block
-	RedoD0:;
-	uint64_t const heads = Thread_AtomicLoad64Relaxed(&manager->freeListHeads);
-	uint32_t const headsFreePart = (uint32_t) (heads & 0xFFFFFFFFull);
-	uint64_t const headsDeferFreePart = heads & ~0xFFFFFFFFull;
-	ASSERT(((heads & 0x00FFFFFFull) >> manager->handlesPerBlockShift) < manager->maxBlocks);
+	// attach existing free list to the end of the run
+	Handle_FreeListPushFree32(&manager->freeListHeads, FreeLink32(gens[0], firstIndex), tail);
+	// every slot in the run now holds a link a replica needs
+	uint8_t *const base = Handle_Manager32BlockBase(manager, blockIndex);
+	for (uint32_t i = 0u; i < count; ++i) {
+		MarkDirty32(manager, base, blockHandles, slot + i);
+	}
+}
 
-	// we chain to the next entry in the free list without disturbing the deferred list
-	uint64_t const newHeads = headsDeferFreePart | baseIndex;
-	// point last new handle to existing free list (it might not be invalid by now)
-	*((uint32_t *) (base + (manager->handlesPerBlockMask * manager->elementSize))) = headsFreePart;
+// makes newRun the fresh run, what was left of the old one goes on the free list
+static void SwapFreshRun32(Handle_Manager32 *manager, uint64_t newRun) {
+	RedoX:;
+	uint64_t const old = Thread_AtomicLoad64Relaxed(&manager->freshRun);
+	if (Thread_AtomicCompareExchange64Relaxed(&manager->freshRun, old, newRun) != old) {
+		goto RedoX;
+	}
+	uint32_t const oldNext = (uint32_t) (old & 0xFFFFFFFFull);
+	uint32_t const oldEnd = (uint32_t) (old >> 32ull);
+	if (oldEnd > oldNext) {
+		if (manager->neverReissueOldHandles) {
+			// unborn rather than lost, the free list only holds slots that can be issued
+			uint32_t blockIndex;
+			uint32_t slot;
+			uint32_t const blockHandles = Handle_Manager32Locate(manager, oldNext, &blockIndex, &slot);
+			memset(Handle_Manager32BlockBase(manager, blockIndex) + (blockHandles * manager->elementSize) + slot,
+						 1,
+						 oldEnd - oldNext);
+		}
+		LinkFreeRun32(manager, (uint8_t *) ItemLink32(manager, oldNext), oldNext, oldEnd - oldNext);
+	}
+}
 
-	if (Thread_AtomicCompareExchange64Relaxed(&manager->freeListHeads, heads, newHeads) != heads) {
-		goto RedoD0; // something changed reverse the transaction
+static uint32_t FreeRunBucket32(uint32_t count) {
+	ASSERT(count >= 2);
+	return 30u - Handle_CountLeadingZeros32(count);
+}
+
+// stacks a released run whose slots all have generation gen, for AllocRange
+static void PushFreeRun32(Handle_Manager32 *manager, uint32_t firstIndex, uint32_t count, uint8_t gen) {
+	uint32_t *const item = ItemLink32(manager, firstIndex);
+	*(uint32_t *) (((uint8_t *) item) + manager->elementSize) = count;
+	Thread_Atomic32_t *const head = manager->freeRunHeads + FreeRunBucket32(count);
+	uint32_t const link = FreeLink32(gen, firstIndex);
+	RedoR:;
+	uint32_t const next = Thread_AtomicLoad32Relaxed(head);
+	*item = next;
+	if (Thread_AtomicCompareExchange32Relaxed(head, next, link) != next) {
+		goto RedoR;
+	}
+	MarkDirtyIndex32(manager, firstIndex);
+	MarkDirtyIndex32(manager, firstIndex + 1);
+}
+
+// takes a released run of at least count slots, what isn't needed is put back.
+// Every run above count's own bucket is long enough, in its own bucket only the
+// top run is tried so a short one doesn't make us search
+static bool PopFreeRun32(Handle_Manager32 *manager, uint32_t count, uint32_t *outIndex) {
+	for (uint32_t b = (count >= 2) ? FreeRunBucket32(count) : 0u; b < Handle_FreeRunBuckets32; ++b) {
+		Thread_Atomic32_t *const head = manager->freeRunHeads + b;
+		RedoR:;
+		uint32_t const link = Thread_AtomicLoad32Relaxed(head);
+		if (link == 0) {
+			continue;
+		}
+		uint32_t const actualIndex = link & Handle_MaxHandles32;
+		uint32_t *const item = ItemLink32(manager, actualIndex);
+		if (Thread_AtomicCompareExchange32Relaxed(head, link, *item) != link) {
+			goto RedoR;
+		}
+		uint8_t const gen = (uint8_t) (link >> Handle_GenerationBitShift32);
+		uint32_t const runCount = *(uint32_t *) (((uint8_t *) item) + manager->elementSize);
+		if (runCount < count) {
+			PushFreeRun32(manager, actualIndex, runCount, gen);
+			continue;
+		}
+		uint32_t const rest = runCount - count;
+		if (rest >= 2) {
+			PushFreeRun32(manager, actualIndex + count, rest, gen);
+		} else if (rest == 1) {
+			LinkFreeRun32(manager, (uint8_t *) ItemLink32(manager, actualIndex + count), actualIndex + count, 1);
+		}
+		*outIndex = actualIndex;
+		return true;
 	}
+	return false;
+}
 
+// hands every released run to the free list, true if there were any
+static bool DrainFreeRuns32(Handle_Manager32 *manager) {
+	bool drained = false;
+	for (uint32_t b = 0u; b < Handle_FreeRunBuckets32; ++b) {
+		uint32_t link = Thread_AtomicExchange32Relaxed(manager->freeRunHeads + b, 0);
+		while (link != 0) {
+			uint32_t const actualIndex = link & Handle_MaxHandles32;
+			uint32_t *const item = ItemLink32(manager, actualIndex);
+			uint32_t const runCount = *(uint32_t *) (((uint8_t *) item) + manager->elementSize);
+			link = *item;
+			LinkFreeRun32(manager, (uint8_t *) item, actualIndex, runCount);
+			drained = true;
+		}
+	}
+	return drained;
+}
+
+// return true to retry the allocation, false means no hope
+static bool AllocNewBlock32(Handle_Manager32 *manager) {
+	// released ranges are cheaper than a new block
+	if (DrainFreeRuns32(manager)) {
+		return true;
+	}
+	uint32_t baseIndex;
+	uint32_t blockHandles;
+	bool retry;
+	uint8_t *base = ClaimNewBlock32(manager, &baseIndex, &blockHandles, &retry);
+	if (!base) {
+		return retry;
+	}
+	// the whole block is the fresh run, none of it is touched until handed out
+	SwapFreshRun32(manager, (((uint64_t) (baseIndex + blockHandles)) << 32ull) | baseIndex);
 	return true;
 }
 
-AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32Create(uint32_t elementSize,
-																																			uint32_t handlesPerBlock,
-																																			uint32_t maxBlocks,
-																																			bool neverReissueOldHandles) {
+// allocator NULL is the default allocator, it isn't used for NUMA placed managers
+static Handle_Manager32 *CreateManager32(uint32_t elementSize,
+																				 uint32_t handlesPerBlock,
+																				 uint32_t maxBlocks,
+																				 bool neverReissueOldHandles,
+																				 int32_t numaNode,
+																				 bool geometric,
+																				 bool growable,
+																				 bool dirtyTracked,
+																				 Handle_BlockAllocator const *allocator) {
 	ASSERT(elementSize >= sizeof(uint32_t));
 	ASSERT(handlesPerBlock <= Handle_MaxHandles32);
 
@@ -102,101 +400,502 @@ AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32Create(uint32_t elementSize,
 	}
 
 	// each block has space for the data, the generation and the index into blocks for the base pointer
-	size_t const blockSize = (handlesPerBlock * elementSize) + (handlesPerBlock * sizeof(uint8_t));
+	size_t const blockSize = BlockBytes32(elementSize, handlesPerBlock, dirtyTracked);
+
+	// a single node machine has nothing to gain, so degrade to the normal path
+	if (Handle_NumaNodeCount() <= 1) {
+		numaNode = Handle_NumaNodeNone;
+	}
+
+	// growable covers the whole index range, split between root and pages so
+	// neither is big, the root is embedded and the pages allocated on demand
+	uint32_t directoryPageShift = 0;
+	uint32_t rootSize = 0;
+	if (growable) {
+		uint32_t const blockBits = 24u - SlowLog2(handlesPerBlock);
+		directoryPageShift = blockBits - (blockBits / 2u);
+		rootSize = 1u << (blockBits / 2u);
+		maxBlocks = 1u << blockBits;
+	}
 
 	// first block is attached directly to the header
-	size_t const allocSize = sizeof(Handle_Manager32)
-			+ blockSize +
-			8 + // padding to ensure atomics are at least 8 byte aligned
-			(maxBlocks * sizeof(Thread_AtomicPtr_t));
+	size_t const allocSize =
+			HeaderAllocSize32(elementSize, handlesPerBlock, growable ? 0 : maxBlocks, rootSize, dirtyTracked);
 
-	Handle_Manager32 *manager = (Handle_Manager32 *) MEMORY_CALLOC(1, allocSize);
+	if (!allocator) {
+		allocator = Handle_BlockAllocatorDefault();
+	}
+	uint32_t const headerNode = Handle_NumaResolveNode(numaNode);
+	Handle_Manager32 *manager = (numaNode == Handle_NumaNodeNone) ?
+			(Handle_Manager32 *) allocator->alloc(allocator->context, allocSize, Handle_BlockAlignment) :
+			(Handle_Manager32 *) Handle_NumaAlloc(allocSize, headerNode);
 	if (!manager) {
 		return NULL;
 	}
+	manager->allocator = *allocator;
 	manager->elementSize = elementSize;
 	manager->handlesPerBlockMask = handlesPerBlock - 1;
 	manager->handlesPerBlockShift = SlowLog2(handlesPerBlock);
 	manager->neverReissueOldHandles = neverReissueOldHandles;
+	manager->geometric = geometric;
+	manager->dirtyTracked = dirtyTracked;
 	manager->maxBlocks = maxBlocks;
+	manager->numaNode = numaNode;
 
 	uint8_t *base = (uint8_t *) (manager + 1);
-	if (!base) {
-		MEMORY_FREE(manager);
+	// get to blocks space with 8 byte alignment guarenteed
+	Thread_AtomicPtr_t *arrays = (Thread_AtomicPtr_t *) (((uintptr_t) base + blockSize + 0x8ull) & ~0x7ull);
+	if (growable) {
+		manager->directory = arrays;
+		manager->directoryPageShift = directoryPageShift;
+	} else {
+		manager->blocks = arrays;
+		manager->blockNodes = (uint8_t *) (manager->blocks + maxBlocks);
+	}
+	Thread_AtomicPtr_t *const entry = BlockEntry32(manager, 0);
+	if (!entry) {
+		FreeBlockMemory32(manager, manager, allocSize);
 		return NULL;
 	}
-	// get to blocks space with 8 byte alignment guarenteed
-	manager->blocks = (Thread_AtomicPtr_t*)(((uintptr_t)base + blockSize + 0x8ull) & ~0x7ull);
-	Thread_AtomicStorePtrRelaxed(manager->blocks + 0, base);
+	*BlockNode32(manager, 0) = (uint8_t) ((numaNode == Handle_NumaNodeNone) ? Handle_NumaBlockNodeNone : headerNode);
+	Thread_AtomicStorePtrRelaxed(entry, base);
+	IndexBlock32(manager, 0, base);
 	Thread_AtomicStore32Relaxed(&manager->totalHandlesAllocated, handlesPerBlock);
 
-	// init free list for new block
-	// both gen and block index are zero'ed via calloc
-	for (uint32_t i = 0u; i < handlesPerBlock; ++i) {
-		uint32_t const index = i;
-		void *addr = base + (i * manager->elementSize);
-		*((uint32_t *) addr) = 0xFF000000u | (index + 1);
-	}
-
 	// index zero is born generation 1
 	*(base + (handlesPerBlock * manager->elementSize)) = 1;
+	MarkAllDirty32(manager, base, handlesPerBlock);
+
+	// nothing is linked up front, the first block is the fresh run and only
+	// released slots go on the free lists, so creation doesn't touch the elements
+	Thread_AtomicStore64Relaxed(&manager->freeListHeads, 0);
+	Thread_AtomicStore64Relaxed(&manager->freshRun, ((uint64_t) handlesPerBlock) << 32ull);
+
+	return manager;
+}
+
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32Create(uint32_t elementSize,
+																																			uint32_t handlesPerBlock,
+																																			uint32_t maxBlocks,
+																																			bool neverReissueOldHandles) {
+	return Handle_Manager32CreateNuma(elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles, Handle_NumaNodeNone);
+}
 
-	// fix last index to point to the invalid marker
-	*((uint32_t *) (base + ((handlesPerBlock - 1) * manager->elementSize))) = 0;
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateNuma(uint32_t elementSize,
+																														uint32_t handlesPerBlock,
+																														uint32_t maxBlocks,
+																														bool neverReissueOldHandles,
+																														int32_t numaNode) {
+	return CreateManager32(elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles, numaNode, false, false, false, NULL);
+}
+
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateGeometric(uint32_t elementSize,
+																																 uint32_t firstBlockSize,
+																																 uint32_t maxBlocks,
+																																 bool neverReissueOldHandles) {
+	return CreateManager32(elementSize, firstBlockSize, maxBlocks, neverReissueOldHandles, Handle_NumaNodeNone, true, false, false, NULL);
+}
+
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateGrowable(uint32_t elementSize,
+																																uint32_t handlesPerBlock,
+																																bool neverReissueOldHandles) {
+	return CreateManager32(elementSize, handlesPerBlock, 0, neverReissueOldHandles, Handle_NumaNodeNone, false, true, false, NULL);
+}
+
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateWithAllocator(uint32_t elementSize,
+																																		 uint32_t handlesPerBlock,
+																																		 uint32_t maxBlocks,
+																																		 bool neverReissueOldHandles,
+																																		 Handle_BlockAllocator const *allocator) {
+	return CreateManager32(elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles, Handle_NumaNodeNone, false, false, false, allocator);
+}
+
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateTracked(uint32_t elementSize,
+																															 uint32_t handlesPerBlock,
+																															 uint32_t maxBlocks,
+																															 bool neverReissueOldHandles) {
+	return CreateManager32(elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles, Handle_NumaNodeNone, false, false, true, NULL);
+}
 
-	// repoint heads to start of the free list with an empty deferred list
-	Thread_AtomicStore64Relaxed(&manager->freeListHeads, 0xFF000000ull);
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateOwned(uint32_t elementSize,
+																														 uint32_t handlesPerBlock,
+																														 uint32_t maxBlocks,
+																														 bool neverReissueOldHandles) {
+	Handle_Manager32 *manager = Handle_Manager32Create(elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles);
+	if (!manager) {
+		return NULL;
+	}
+	manager->owned = true;
+	manager->ownerThread = (uint64_t) Thread_GetCurrentThreadID();
+	return manager;
+}
 
+AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32CreateSingleThreaded(uint32_t elementSize,
+																																			uint32_t handlesPerBlock,
+																																			uint32_t maxBlocks,
+																																			bool neverReissueOldHandles) {
+	Handle_Manager32 *manager = Handle_Manager32CreateOwned(elementSize, handlesPerBlock, maxBlocks, neverReissueOldHandles);
+	if (!manager) {
+		return NULL;
+	}
+	manager->singleThreaded = true;
 	return manager;
 }
 
+AL2O3_EXTERN_C void Handle_Manager32SetOwner(Handle_Manager32 *manager) {
+	ASSERT(manager->owned);
+	manager->ownerThread = (uint64_t) Thread_GetCurrentThreadID();
+	Thread_AtomicThreadFenceSeqCst();
+}
+
+// grows a deferred frame's index array to hold at least count, false if out of memory
+static bool ReserveDeferred32(Handle_DeferredFrame32 *deferred, uint32_t count) {
+	if (count <= deferred->capacity) {
+		return true;
+	}
+	uint32_t capacity = deferred->capacity ? deferred->capacity : 16u;
+	while (capacity < count) {
+		capacity *= 2u;
+	}
+	uint32_t *indices = (uint32_t *) MEMORY_REALLOC(deferred->indices, capacity * sizeof(uint32_t));
+	if (!indices) {
+		return false;
+	}
+	deferred->indices = indices;
+	deferred->capacity = capacity;
+	return true;
+}
+
 AL2O3_EXTERN_C void Handle_Manager32Destroy(Handle_Manager32 *manager) {
 	if (!manager) {
 		return;
 	}
 
 	// 0th block is embedded
-	for (uint32_t i = 1u; i < manager->maxBlocks; ++i) {
-		void *ptr = Thread_AtomicLoadPtrRelaxed(&manager->blocks[i]);
+	uint32_t const blockLimit = BlockLimit32(manager);
+	for (uint32_t i = 1u; i < blockLimit; ++i) {
+		void *ptr = Handle_Manager32BlockBase(manager, i);
 		if (ptr) {
-			MEMORY_FREE(ptr);
+			FreeBlockMemory32(manager, ptr, BlockSize32(manager, i));
 		}
 	}
 
-	MEMORY_FREE(manager);
+	if (manager->directory) {
+		uint32_t const rootSize = manager->maxBlocks >> manager->directoryPageShift;
+		for (uint32_t i = 0u; i < rootSize; ++i) {
+			void *page = Thread_AtomicLoadPtrRelaxed(&manager->directory[i]);
+			if (page) {
+				manager->allocator.free(manager->allocator.context, page, DirectoryPageSize32(manager));
+			}
+		}
+	}
+
+	for (uint32_t i = 0u; i < Handle_MaxDeferredFrames32; ++i) {
+		MEMORY_FREE(manager->deferredFrames[i].indices);
+	}
+	Handle_AddressIndexDestroy(&manager->addressIndex);
+	FreeBlockMemory32(manager, manager, HeaderSize32(manager));
 }
 
 AL2O3_EXTERN_C Handle_Manager32 *Handle_Manager32Clone(Handle_Manager32 *src) {
 	if (!src) {
 		return NULL;
 	}
-	Handle_Manager32 *manager = Handle_Manager32Create(src->elementSize,
-																										 src->handlesPerBlockMask + 1,
-																										 src->maxBlocks,
-																										 src->neverReissueOldHandles);
+	Handle_Manager32 *manager = CreateManager32(src->elementSize,
+																							src->handlesPerBlockMask + 1,
+																							src->maxBlocks,
+																							src->neverReissueOldHandles,
+																							src->numaNode,
+																							src->geometric,
+																							src->directory != NULL,
+																							src->dirtyTracked,
+																							&src->allocator);
 	if(!manager) {
 		return NULL;
 	}
-	size_t const blockSize = ((src->handlesPerBlockMask + 1) * src->elementSize) + ((src->handlesPerBlockMask + 1) * sizeof(uint8_t));
-
 	// copy over the 1st embedded block
-	memcpy(manager->blocks[0].nonatomic, src->blocks[0].nonatomic, blockSize);
-	for (uint32_t i = 1u; i < src->maxBlocks; ++i) {
-		void *ptr = Thread_AtomicLoadPtrRelaxed(&src->blocks[i]);
+	memcpy(Handle_Manager32BlockBase(manager, 0), Handle_Manager32BlockBase(src, 0), BlockSize32(src, 0));
+	uint32_t const blockLimit = BlockLimit32(src);
+	for (uint32_t i = 1u; i < blockLimit; ++i) {
+		void *ptr = Handle_Manager32BlockBase(src, i);
 		if (ptr) {
-			manager->blocks[i].nonatomic = MEMORY_MALLOC(blockSize);
-			memcpy(manager->blocks[i].nonatomic, src->blocks[i].nonatomic, blockSize);
+			size_t const blockSize = BlockSize32(src, i);
+			Thread_AtomicPtr_t *const entry = BlockEntry32(manager, i);
+			void *block = entry ? AllocBlockMemory32(manager, blockSize, i) : NULL;
+			if (!block) {
+				Handle_Manager32Destroy(manager);
+				return NULL;
+			}
+			memcpy(block, ptr, blockSize);
+			Thread_AtomicStorePtrRelaxed(entry, block);
+			IndexBlock32(manager, i, (uint8_t const *) block);
 		}
 	}
 
 	manager->totalHandlesAllocated = src->totalHandlesAllocated;
 	manager->freeListHeads = src->freeListHeads;
+	manager->init = src->init;
+	manager->owned = src->owned;
+	manager->singleThreaded = src->singleThreaded;
+	manager->ownerThread = src->ownerThread;
+	manager->remoteFreeHead = src->remoteFreeHead;
+	manager->resetCursor = src->resetCursor;
+	manager->resetLimit = src->resetLimit;
+	manager->freshRun = src->freshRun;
+	memcpy(manager->freeRunHeads, src->freeRunHeads, sizeof(manager->freeRunHeads));
+	manager->pendingFrame = src->pendingFrame;
+	for (uint32_t i = 0u; i < Handle_MaxDeferredFrames32; ++i) {
+		Handle_DeferredFrame32 const *from = src->deferredFrames + i;
+		Handle_DeferredFrame32 *to = manager->deferredFrames + i;
+		if (!ReserveDeferred32(to, from->count)) {
+			LOGWARNING("Out of memory!");
+			Handle_Manager32Destroy(manager);
+			return NULL;
+		}
+		if (from->count) {
+			memcpy(to->indices, from->indices, from->count * sizeof(uint32_t));
+		}
+		to->count = from->count;
+		to->frame = from->frame;
+	}
 
 	return manager;
 }
 
 
-AL2O3_EXTERN_C Handle_Handle32 Handle_Manager32Alloc(Handle_Manager32 *manager) {
+// pushes a chain of indices (linked through their first 4 bytes) onto the remote stack
+static void PushRemote32(Handle_Manager32 *manager, uint32_t chainHead, uint32_t tailIndex) {
+	uint32_t *const tailItem = ItemLink32(manager, tailIndex);
+	RedoR:;
+	uint32_t const head = Thread_AtomicLoad32Relaxed(&manager->remoteFreeHead);
+	*tailItem = head;
+	// the link has to be visible before the owner can take it
+	Thread_AtomicThreadFenceRelease();
+	if (Thread_AtomicCompareExchange32Relaxed(&manager->remoteFreeHead, head, chainHead) != head) {
+		goto RedoR;
+	}
+	MarkDirtyIndex32(manager, tailIndex);
+}
+
+// splices a chain of indices (linked through their first 4 bytes) onto the
+// deferred list without changing the free list. The rest of the chain must
+// already be marked dirty, the tail is marked here once its link is final
+static void SpliceDeferred32(Handle_Manager32 *manager, uint32_t chainHead, uint32_t tailIndex) {
+	uint32_t *const tailItem = ItemLink32(manager, tailIndex);
+	if (manager->owned) {
+		ASSERT(!manager->singleThreaded || manager->ownerThread == (uint64_t) Thread_GetCurrentThreadID());
+		if (manager->singleThreaded || manager->ownerThread == (uint64_t) Thread_GetCurrentThreadID()) {
+			uint64_t const heads = manager->freeListHeads.nonatomic;
+			*tailItem = (uint32_t) (heads >> 32ull);
+			manager->freeListHeads.nonatomic = (((uint64_t) chainHead) << 32ull) | (heads & 0xFFFFFFFFull);
+			MarkDirtyIndex32(manager, tailIndex);
+		} else {
+			PushRemote32(manager, chainHead, tailIndex);
+		}
+		return;
+	}
+
+	Handle_FreeListPushDeferred32(&manager->freeListHeads, chainHead, tailItem);
+	MarkDirtyIndex32(manager, tailIndex);
+}
+
+// after a Reset, takes the next index that hasn't been reissued yet
+static Handle_Handle32 AllocReset32(Handle_Manager32 *manager, void **element) {
+	RedoC:;
+	uint32_t const actualIndex = Thread_AtomicLoad32Relaxed(&manager->resetCursor);
+	if (actualIndex >= manager->resetLimit) {
+		Handle_Handle32 invalid = {0};
+		return invalid;
+	}
+	if (Thread_AtomicCompareExchange32Relaxed(&manager->resetCursor, actualIndex, actualIndex + 1) != actualIndex) {
+		goto RedoC;
+	}
+
+	uint32_t blockIndex;
+	uint32_t index;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &index);
+	uint8_t *const base = Handle_Manager32BlockBase(manager, blockIndex);
+	ASSERT(base != NULL);
+	uint8_t const *gen = base + (blockHandles * manager->elementSize) + index;
+	if (*gen == 0 && manager->neverReissueOldHandles) {
+		goto RedoC; // lost for good
+	}
+
+	*element = base + (index * manager->elementSize);
+	Handle_Handle32 handle = {
+		.handle = ((uint32_t) *gen) << Handle_GenerationBitShift32 | actualIndex
+	};
+	return handle;
+}
+
+// after a Reset, cuts a range from the indices not yet reissued. Their
+// generations differ so they are all raised to the newest, which only skips
+// generations no handle has. Slots that can't be part of it (past a block
+// boundary, lost or too many generations apart to share one without a wrap)
+// are recycled one at a time and we go again
+static bool AllocResetRange32(Handle_Manager32 *manager, uint32_t count, uint32_t *outIndex) {
+	RedoC:;
+	uint32_t const actualIndex = Thread_AtomicLoad32Relaxed(&manager->resetCursor);
+	if (actualIndex >= manager->resetLimit) {
+		return false;
+	}
+	uint32_t blockIndex;
+	uint32_t slot;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &slot);
+	uint8_t *const gens = Handle_Manager32BlockBase(manager, blockIndex) + (blockHandles * manager->elementSize) + slot;
+	uint32_t const avail = (manager->resetLimit - actualIndex) < (blockHandles - slot) ?
+			(manager->resetLimit - actualIndex) : (blockHandles - slot);
+
+	// generations relative to the first, wrapping unless never reissue
+	int32_t lowest = 0;
+	int32_t highest = 0;
+	uint32_t usable = 0u;
+	while (usable < count && usable < avail) {
+		uint8_t const gen = gens[usable];
+		if (gen == 0 && manager->neverReissueOldHandles) {
+			break; // lost
+		}
+		int32_t const offset = manager->neverReissueOldHandles ?
+				(int32_t) gen - (int32_t) gens[0] :
+				(int32_t) (int8_t) (uint8_t) (gen - gens[0]);
+		int32_t const newLowest = offset < lowest ? offset : lowest;
+		int32_t const newHighest = offset > highest ? offset : highest;
+		// room for handle 0's bump below
+		if (!manager->neverReissueOldHandles && newHighest - newLowest > 126) {
+			break;
+		}
+		lowest = newLowest;
+		highest = newHighest;
+		usable++;
+	}
+
+	if (usable == count) {
+		if (Thread_AtomicCompareExchange32Relaxed(&manager->resetCursor, actualIndex, actualIndex + count) != actualIndex) {
+			goto RedoC;
+		}
+		uint8_t shared = (uint8_t) (gens[0] + highest);
+		if (shared == 0 && actualIndex == 0) {
+			shared = 1; // handle 0 special case
+		}
+		memset(gens, shared, count);
+		*outIndex = actualIndex;
+		return true;
+	}
+
+	// step past everything in the way including the slot that stopped us
+	uint32_t const skip = (usable < avail) ? usable + 1 : avail;
+	if (Thread_AtomicCompareExchange32Relaxed(&manager->resetCursor, actualIndex, actualIndex + skip) != actualIndex) {
+		goto RedoC;
+	}
+	for (uint32_t i = 0u; i < skip; ++i) {
+		Handle_Manager32Recycle(manager, actualIndex + i);
+	}
+	goto RedoC;
+}
+
+// bumps the next never issued slot off the fresh run, invalid once it is used up
+static Handle_Handle32 AllocFresh32(Handle_Manager32 *manager, void **element) {
+	uint32_t actualIndex;
+	if (manager->owned) {
+		// AllocRange is owner only too, so nothing else moves the run
+		uint64_t const run = manager->freshRun.nonatomic;
+		actualIndex = (uint32_t) (run & 0xFFFFFFFFull);
+		if (actualIndex >= (uint32_t) (run >> 32ull)) {
+			Handle_Handle32 invalid = {0};
+			return invalid;
+		}
+		manager->freshRun.nonatomic = run + 1;
+	} else {
+		RedoN:;
+		uint64_t const run = Thread_AtomicLoad64Relaxed(&manager->freshRun);
+		actualIndex = (uint32_t) (run & 0xFFFFFFFFull);
+		if (actualIndex >= (uint32_t) (run >> 32ull)) {
+			Handle_Handle32 invalid = {0};
+			return invalid;
+		}
+		if (Thread_AtomicCompareExchange64Relaxed(&manager->freshRun, run, run + 1) != run) {
+			goto RedoN;
+		}
+	}
+
+	uint32_t blockIndex;
+	uint32_t index;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &index);
+	uint8_t *const base = Handle_Manager32BlockBase(manager, blockIndex);
+	ASSERT(base != NULL);
+	uint8_t *gen = base + (blockHandles * manager->elementSize) + index;
+	if (*gen == 0 && manager->neverReissueOldHandles) {
+		*gen = 1; // unborn not lost, generation 0 only ever means lost once issued
+	}
+
+	*element = base + (index * manager->elementSize);
+	Handle_Handle32 handle = {
+		.handle = ((uint32_t) *gen) << Handle_GenerationBitShift32 | actualIndex
+	};
+	return handle;
+}
+
+// the owner thread is the only one touching the free lists so no CAS is needed
+static Handle_Handle32 AllocOwned(Handle_Manager32 *manager, void **element) {
+	ASSERT(manager->ownerThread == (uint64_t) Thread_GetCurrentThreadID());
+	uint32_t noFreeCount = 0;
+	Redo:;
+	uint64_t const heads = manager->freeListHeads.nonatomic;
+	uint32_t const headsFreePart = (uint32_t) (heads & 0xFFFFFFFFull);
+	if (headsFreePart == 0) {
+		// never issued slots go before released ones
+		Handle_Handle32 const fresh = AllocFresh32(manager, element);
+		if (fresh.handle != 0) {
+			return fresh;
+		}
+		uint32_t const headsDeferFreePart = (uint32_t) (heads >> 32ull);
+		if (headsDeferFreePart != 0) {
+			manager->freeListHeads.nonatomic = headsDeferFreePart;
+			goto Redo;
+		}
+		// take everything other threads have released in one go
+		uint32_t const remote = Thread_AtomicExchange32Relaxed(&manager->remoteFreeHead, 0);
+		if (remote != 0) {
+			Thread_AtomicThreadFenceAcquire();
+			manager->freeListHeads.nonatomic = remote;
+			goto Redo;
+		}
+		Handle_Handle32 const reset = AllocReset32(manager, element);
+		if (reset.handle != 0) {
+			return reset;
+		}
+		bool retry = AllocNewBlock32(manager);
+		if (retry == false || noFreeCount >= 1000) {
+			LOGWARNING("Manager has run out of handles");
+			Handle_Handle32 invalid = {0}; // fail
+			return invalid;
+		}
+		noFreeCount++;
+		goto Redo;
+	}
+
+	uint32_t const actualIndex = headsFreePart & Handle_MaxHandles32;
+	uint32_t blockIndex;
+	uint32_t index;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &index);
+	uint8_t *const base = Handle_Manager32BlockBase(manager, blockIndex);
+	ASSERT(base != NULL);
+	uint32_t *const item = (uint32_t *) (base + (index * manager->elementSize));
+	manager->freeListHeads.nonatomic = (heads & ~0xFFFFFFFFull) | *item;
+
+	*element = item;
+	uint8_t *gen = base + (blockHandles * manager->elementSize) + index;
+	Handle_Handle32 handle = {
+		.handle = ((uint32_t) *gen) << Handle_GenerationBitShift32 | actualIndex
+	};
+	return handle;
+}
+
+// pops a free slot, the element is left for the init policy
+static Handle_Handle32 AllocNoInit(Handle_Manager32 *manager, void **element) {
+	if (manager->owned) {
+		return AllocOwned(manager, element);
+	}
 	uint32_t noFreeCount = 0;
 	RedoD0:;
 	// heads has 2 linked list packed in a 64 bit location. Its our transaction
@@ -204,15 +903,25 @@ AL2O3_EXTERN_C Handle_Handle32 Handle_Manager32Alloc(Handle_Manager32 *manager)
 	uint64_t const heads = Thread_AtomicLoad64Relaxed(&manager->freeListHeads);
 	uint32_t const headsFreePart = (uint32_t) (heads & 0xFFFFFFFFull);
 	uint64_t const headsDeferFreePart = heads & ~0xFFFFFFFFull;
-	ASSERT(((heads & 0x00FFFFFFull) >> manager->handlesPerBlockShift) < manager->maxBlocks);
+	ASSERT((heads & 0x00FFFFFFull) < Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated));
 
 	// check to see if the free list is empty
 	if (headsFreePart == 0) {
+		// never issued slots go before released ones
+		Handle_Handle32 const fresh = AllocFresh32(manager, element);
+		if (fresh.handle != 0) {
+			return fresh;
+		}
 		// we need to swap the deferred into the free list as free list is empty
 		if (headsDeferFreePart == (uint64_t) 0) {
 			// the deferred list is empty, so we have no free handles
 			// we now do the tricky part of allocating a new block in a lock free
 			// way *gulp*
+			// unless a Reset has left slots to reissue
+			Handle_Handle32 const reset = AllocReset32(manager, element);
+			if (reset.handle != 0) {
+				return reset;
+			}
 			bool retry = AllocNewBlock32(manager);
 			if (retry == false || noFreeCount >= 1000) {
 				LOGWARNING("Manager has run out of handles");
@@ -233,13 +942,14 @@ AL2O3_EXTERN_C Handle_Handle32 Handle_Manager32Alloc(Handle_Manager32 *manager)
 	// we chain to the next entry in the free list without disturbing the deferred list
 	uint32_t const actualIndex = headsFreePart & Handle_MaxHandles32;
 	// fetch the base memory block for this index
-	uint32_t const baseIndex = actualIndex >> manager->handlesPerBlockShift;
+	uint32_t baseIndex;
+	uint32_t index;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &baseIndex, &index);
 	ASSERT(baseIndex < manager->maxBlocks);
-	uint8_t *const base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[baseIndex]);
+	uint8_t *const base = Handle_Manager32BlockBase(manager, baseIndex);
 	ASSERT(base != NULL);
-	uint32_t index = actualIndex & manager->handlesPerBlockMask;
 	uint32_t *const item = (uint32_t *) (base + (index * manager->elementSize));
-	ASSERT((uint8_t *) item < (base + ((manager->handlesPerBlockMask + 1) * manager->elementSize)));
+	ASSERT((uint8_t *) item < (base + (blockHandles * manager->elementSize)));
 
 	uint64_t const newHeads = headsDeferFreePart | *item;
 
@@ -248,36 +958,180 @@ AL2O3_EXTERN_C Handle_Handle32 Handle_Manager32Alloc(Handle_Manager32 *manager)
 	}
 
 	// the item is now ours to abuse
-	// clear it out ready for its new life
-	memset(item, 0x0, manager->elementSize);
+	*element = item;
 
 	// now make the handle and return it
 	// point to generation data for this index
-	uint8_t *gen = base + ((manager->handlesPerBlockMask + 1) * manager->elementSize) + index;
+	uint8_t *gen = base + (blockHandles * manager->elementSize) + index;
 	Handle_Handle32 handle = {
 		.handle = ((uint32_t) *gen) << Handle_GenerationBitShift32 | actualIndex
 	};
 	return handle;
 }
 
+AL2O3_EXTERN_C Handle_Handle32 Handle_Manager32Alloc(Handle_Manager32 *manager) {
+	void *element = NULL;
+	Handle_Handle32 const handle = AllocNoInit(manager, &element);
+	if (handle.handle != 0) {
+		// clear it out ready for its new life
+		Handle_InitElements(&manager->init, element, manager->elementSize, 1);
+		Handle_InitFence(&manager->init);
+		MarkDirtyIndex32(manager, handle.handle & Handle_MaxHandles32);
+	}
+	return handle;
+}
+
+AL2O3_EXTERN_C uint32_t Handle_Manager32AllocBatch(Handle_Manager32 *manager, Handle_Handle32 *handles, uint32_t count) {
+	uint8_t *runStart = NULL;
+	uint32_t runCount = 0;
+	uint32_t allocated = 0;
+	for (; allocated < count; ++allocated) {
+		void *element = NULL;
+		Handle_Handle32 const handle = AllocNoInit(manager, &element);
+		if (handle.handle == 0) {
+			break;
+		}
+		handles[allocated] = handle;
+		MarkDirtyIndex32(manager, handle.handle & Handle_MaxHandles32);
+		// fresh and recently released slots tend to be next to each other
+		if (runStart && (uint8_t *) element == runStart + (runCount * manager->elementSize)) {
+			runCount++;
+			continue;
+		}
+		if (runStart) {
+			Handle_InitElements(&manager->init, runStart, manager->elementSize, runCount);
+		}
+		runStart = (uint8_t *) element;
+		runCount = 1;
+	}
+	if (runStart) {
+		Handle_InitElements(&manager->init, runStart, manager->elementSize, runCount);
+	}
+	Handle_InitFence(&manager->init);
+	return allocated;
+}
+
+AL2O3_EXTERN_C void Handle_Manager32SetInitPolicy(Handle_Manager32 *manager, Handle_InitPolicy policy, Handle_InitFunc func, void *userData) {
+	ASSERT(policy != Handle_InitPolicyCallback || func != NULL);
+	manager->init.policy = policy;
+	manager->init.func = func;
+	manager->init.userData = userData;
+}
+
+AL2O3_EXTERN_C bool Handle_Manager32AllocRange(Handle_Manager32 *manager, uint32_t count, Handle_Handle32 *firstHandle) {
+	ASSERT(count > 0);
+	ASSERT(!manager->owned || manager->ownerThread == (uint64_t) Thread_GetCurrentThreadID());
+	if (!manager->geometric && count > manager->handlesPerBlockMask + 1) {
+		LOGWARNING("A range of %u handles won't fit in a block of %u", count, manager->handlesPerBlockMask + 1);
+		return false;
+	}
+
+	uint32_t firstIndex;
+	bool fresh = true;
+	RedoS:;
+	// ranges come from the fresh run, the untouched tail of the newest block
+	uint64_t const run = Thread_AtomicLoad64Relaxed(&manager->freshRun);
+	uint32_t const runNext = (uint32_t) (run & 0xFFFFFFFFull);
+	uint32_t const runEnd = (uint32_t) (run >> 32ull);
+	if (runEnd - runNext >= count) {
+		uint64_t const newRun = (((uint64_t) runEnd) << 32ull) | (runNext + count);
+		if (Thread_AtomicCompareExchange64Relaxed(&manager->freshRun, run, newRun) != run) {
+			goto RedoS;
+		}
+		firstIndex = runNext;
+	} else if (PopFreeRun32(manager, count, &firstIndex) || AllocResetRange32(manager, count, &firstIndex)) {
+		// then ones released whole or left by a Reset, already sharing a generation
+		fresh = false;
+	} else {
+		uint32_t baseIndex;
+		uint32_t blockHandles;
+		bool retry;
+		uint8_t *base = ClaimNewBlock32(manager, &baseIndex, &blockHandles, &retry);
+		if (!base) {
+			if (retry) {
+				goto RedoS;
+			}
+			LOGWARNING("Manager has run out of handles");
+			return false;
+		}
+		if (count > blockHandles) {
+			LOGWARNING("A range of %u handles won't fit in a block of %u", count, blockHandles);
+			SwapFreshRun32(manager, (((uint64_t) (baseIndex + blockHandles)) << 32ull) | baseIndex);
+			return false;
+		}
+		firstIndex = baseIndex;
+
+		// the rest of the new block is the fresh run now
+		SwapFreshRun32(manager, (((uint64_t) (baseIndex + blockHandles)) << 32ull) | (baseIndex + count));
+	}
+
+	uint32_t blockIndex;
+	uint32_t slot;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, firstIndex, &blockIndex, &slot);
+	ASSERT(slot + count <= blockHandles);
+	uint8_t *const base = Handle_Manager32BlockBase(manager, blockIndex);
+	uint8_t *gen = base + (blockHandles * manager->elementSize) + slot;
+	if (fresh) {
+		// born generation 1 like index 0 (which the first block's run starts
+		// with) so they all share a generation and none look lost
+		memset(gen, 1, count);
+	}
+	firstHandle->handle = ((uint32_t) *gen) << Handle_GenerationBitShift32 | firstIndex;
+
+	Handle_InitElements(&manager->init, base + (slot * manager->elementSize), manager->elementSize, count);
+	Handle_InitFence(&manager->init);
+	for (uint32_t i = 0u; i < count; ++i) {
+		ASSERT(gen[i] == *gen);
+		MarkDirty32(manager, base, blockHandles, slot + i);
+	}
+	return true;
+}
+
 AL2O3_EXTERN_C void Handle_Manager32Release(Handle_Manager32 *manager, Handle_Handle32 handle) {
+	Handle_Manager32Retire(manager, handle);
+	Handle_Manager32Recycle(manager, handle.handle & Handle_MaxHandles32);
+}
+
+AL2O3_EXTERN_C void Handle_Manager32Retire(Handle_Manager32 *manager, Handle_Handle32 handle) {
 	ASSERT((handle.handle & Handle_MaxHandles32) < Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated));
-	ASSERT(Handle_Manager32IsValid(manager, handle));
+	ASSERT(Handle_Manager32IsValidAny(manager, handle));
 
 	uint32_t const actualIndex = handle.handle & Handle_MaxHandles32; // clean out the current generation
-	uint32_t const blockIndex = actualIndex >> manager->handlesPerBlockShift;
-	uint32_t const index = actualIndex & manager->handlesPerBlockMask;
+	uint32_t blockIndex;
+	uint32_t index;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &index);
 	ASSERT(blockIndex < manager->maxBlocks);
 
 	// fetch the base memory block for this index
-	uint8_t *base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex]);
+	uint8_t *base = Handle_Manager32BlockBase(manager, blockIndex);
 	// point to generation data for this index
-	uint8_t *gen = base + ((manager->handlesPerBlockMask + 1) * manager->elementSize) + index;
-	uint32_t *item = (uint32_t *) (base + (index * manager->elementSize));
+	uint8_t *gen = base + (blockHandles * manager->elementSize) + index;
 
 	// update the generation of this index
 	// intentional 8 bit integer overflow
 	*gen = *gen + 1;
+	// handle 0 special case (unless it is about to be lost by never reissue)
+	if (*gen == 0 && actualIndex == 0 && !manager->neverReissueOldHandles) {
+		*gen = 1;
+	}
+	MarkDirty32(manager, base, blockHandles, index);
+}
+
+AL2O3_EXTERN_C void Handle_Manager32Recycle(Handle_Manager32 *manager, uint32_t actualIndex) {
+	ASSERT(actualIndex < Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated));
+
+	uint32_t blockIndex;
+	uint32_t index;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &index);
+	ASSERT(blockIndex < manager->maxBlocks);
+
+	// fetch the base memory block for this index
+	uint8_t *base = Handle_Manager32BlockBase(manager, blockIndex);
+	// point to generation data for this index
+	uint8_t *gen = base + (blockHandles * manager->elementSize) + index;
+	uint32_t *item = (uint32_t *) (base + (index * manager->elementSize));
+	MarkDirty32(manager, base, blockHandles, index);
+
 	if (*gen == 0 && manager->neverReissueOldHandles) {
 		// after generation wrap around simply lose the handle
 		// never putting it back in the free list means it never gets reused
@@ -287,25 +1141,558 @@ AL2O3_EXTERN_C void Handle_Manager32Release(Handle_Manager32 *manager, Handle_Ha
 		memset(item, 0xDC, manager->elementSize);
 		return;
 	}
-	// handle 0 special case
-	if (*gen == 0 && actualIndex == 0) {
-		*gen = 1;
-	}
 
-	uint64_t indexInUpper = ((uint64_t) handle.handle) << 32ull;
+	// tagged with the generation Retire just wrote
+	uint32_t const link = FreeLink32(*gen, actualIndex);
+	uint64_t const indexInUpper = ((uint64_t) link) << 32ull;
+
+	if (manager->owned) {
+		// single threaded managers skip asking which thread this is outside debug builds
+		ASSERT(!manager->singleThreaded || manager->ownerThread == (uint64_t) Thread_GetCurrentThreadID());
+		if (manager->singleThreaded || manager->ownerThread == (uint64_t) Thread_GetCurrentThreadID()) {
+			// onto the deferred list with plain stores, nothing else touches it
+			uint64_t const heads = manager->freeListHeads.nonatomic;
+			*item = (uint32_t) (heads >> 32ull);
+			manager->freeListHeads.nonatomic = indexInUpper | (heads & 0xFFFFFFFFull);
+		} else {
+			PushRemote32(manager, link, actualIndex);
+		}
+		return;
+	}
 
-	RedoF:;
 	// add it to the deferred list without changing the free list
-	// repeat until we get a transaction okay response from CAS
-	uint64_t const heads = Thread_AtomicLoad64Relaxed(&manager->freeListHeads);
-	uint64_t const headsFreePart = heads & 0xFFFFFFFFull;
-	uint32_t const headsDeferFreePart = (uint32_t) ((heads & ~0xFFFFFFFFull) >> 32ull);
-	ASSERT(((heads & 0x00FFFFFFull) >> manager->handlesPerBlockShift) < manager->maxBlocks);
+	Handle_FreeListPushDeferred32(&manager->freeListHeads, link, item);
+}
 
-	*item = headsDeferFreePart;
-	uint64_t const newHeads = indexInUpper | headsFreePart;
-	if (Thread_AtomicCompareExchange64Relaxed(&manager->freeListHeads, heads, newHeads) != heads) {
-		goto RedoF; // transaction fail redo inserting this index into deferred free list
+static void LockFrame32(Handle_DeferredFrame32 *deferred) {
+	while (Thread_AtomicCompareExchange32Relaxed(&deferred->lock, 0, 1) != 0) {
+		// spin on a plain load so waiting doesn't keep stealing the line
+		while (Thread_AtomicLoad32Relaxed(&deferred->lock) != 0) {
+		}
+	}
+	Thread_AtomicThreadFenceAcquire();
+}
+
+static void UnlockFrame32(Handle_DeferredFrame32 *deferred) {
+	Thread_AtomicThreadFenceRelease();
+	Thread_AtomicStore32Relaxed(&deferred->lock, 0);
+}
+
+// frame must be locked and completed, links its indices through their
+// elements (nothing can be reading them now) and splices them back in one go
+static void DrainFrameLocked32(Handle_Manager32 *manager, Handle_DeferredFrame32 *deferred) {
+	if (deferred->count == 0) {
+		return;
+	}
+	// chained back to front so they are reused in release order
+	uint32_t chainHead = 0;
+	for (uint32_t i = deferred->count; i-- > 0u;) {
+		uint32_t const actualIndex = deferred->indices[i];
+		uint32_t blockIndex;
+		uint32_t index;
+		uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &index);
+		uint8_t *base = Handle_Manager32BlockBase(manager, blockIndex);
+		uint32_t *item = (uint32_t *) (base + (index * manager->elementSize));
+		*item = chainHead;
+		MarkDirty32(manager, base, blockHandles, index);
+		chainHead = FreeLink32(base[(blockHandles * manager->elementSize) + index], actualIndex);
+	}
+	// the last index released is the tail
+	uint32_t const tailIndex = deferred->indices[deferred->count - 1];
+	deferred->count = 0;
+	SpliceDeferred32(manager, chainHead, tailIndex);
+}
+
+AL2O3_EXTERN_C bool Handle_Manager32ReleaseDeferred(Handle_Manager32 *manager, Handle_Handle32 handle, uint64_t frame) {
+	uint64_t const pending = Thread_AtomicLoad64Relaxed(&manager->pendingFrame);
+	if (frame >= pending + Handle_MaxDeferredFrames32) {
+		// it would share an index array with an earlier frame and be reused too soon
+		LOGWARNING("Release deferred to frame %llu but only %u frames past %llu can be pending",
+							 (unsigned long long) frame,
+							 Handle_MaxDeferredFrames32,
+							 (unsigned long long) pending);
+		return false;
 	}
 
+	Handle_DeferredFrame32 *deferred = manager->deferredFrames + (frame % Handle_MaxDeferredFrames32);
+	LockFrame32(deferred);
+	// AdvanceFrame moves pendingFrame before draining, so under the lock this is final
+	if (frame < Thread_AtomicLoad64Relaxed(&manager->pendingFrame)) {
+		UnlockFrame32(deferred);
+		// already completed so nothing can be using it
+		Handle_Manager32Release(manager, handle);
+		return true;
+	}
+	if (deferred->count && deferred->frame != frame) {
+		// an earlier frame sharing the array has completed but not been drained yet
+		DrainFrameLocked32(manager, deferred);
+	}
+	if (!ReserveDeferred32(deferred, deferred->count + 1)) {
+		UnlockFrame32(deferred);
+		LOGWARNING("Out of memory!");
+		return false;
+	}
+
+	Handle_Manager32Retire(manager, handle);
+	uint32_t const actualIndex = handle.handle & Handle_MaxHandles32;
+	uint32_t blockIndex;
+	uint32_t index;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &index);
+	uint8_t const *base = Handle_Manager32BlockBase(manager, blockIndex);
+	// lost for good like Release, but left alone as it may still be in use
+	if (base[(blockHandles * manager->elementSize) + index] != 0 || !manager->neverReissueOldHandles) {
+		deferred->frame = frame;
+		deferred->indices[deferred->count++] = actualIndex;
+	}
+	UnlockFrame32(deferred);
+	return true;
+}
+
+AL2O3_EXTERN_C void Handle_Manager32AdvanceFrame(Handle_Manager32 *manager, uint64_t completedFrame) {
+	// claim the frames to retire, only one thread gets each range
+	RedoP:;
+	uint64_t const pending = Thread_AtomicLoad64Relaxed(&manager->pendingFrame);
+	if (completedFrame < pending) {
+		return;
+	}
+	if (Thread_AtomicCompareExchange64Relaxed(&manager->pendingFrame, pending, completedFrame + 1) != pending) {
+		goto RedoP;
+	}
+
+	uint64_t const frameCount = completedFrame - pending + 1;
+	uint64_t const chainCount = frameCount < Handle_MaxDeferredFrames32 ? frameCount : Handle_MaxDeferredFrames32;
+	for (uint64_t i = 0u; i < chainCount; ++i) {
+		Handle_DeferredFrame32 *deferred = manager->deferredFrames + ((pending + i) % Handle_MaxDeferredFrames32);
+		LockFrame32(deferred);
+		if (deferred->frame <= completedFrame) {
+			DrainFrameLocked32(manager, deferred);
+		}
+		UnlockFrame32(deferred);
+	}
+}
+
+AL2O3_EXTERN_C uint32_t Handle_Manager32NumaBlockCount(Handle_Manager32 *manager, uint32_t node) {
+	uint32_t count = 0;
+	uint32_t const blockLimit = BlockLimit32(manager);
+	for (uint32_t i = 0u; i < blockLimit; ++i) {
+		if (Handle_Manager32BlockBase(manager, i) && *BlockNode32(manager, i) == node) {
+			count++;
+		}
+	}
+	return count;
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_Manager32PtrToHandle(Handle_Manager32 *manager, void const *ptr) {
+	Handle_Handle32 invalid = {0};
+	Handle_AddressRange range;
+	if (!Handle_AddressIndexFind(&manager->addressIndex, ptr, &range)) {
+		return invalid;
+	}
+	uint32_t const actualIndex =
+			(uint32_t) range.firstIndex + (uint32_t) (((uintptr_t) ptr - range.base) / manager->elementSize);
+
+	uint32_t blockIndex;
+	uint32_t slot;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &slot);
+	Handle_GenerationType32 const gen = *((uint8_t const *) range.base + (blockHandles * manager->elementSize) + slot);
+	if (manager->neverReissueOldHandles && gen == 0) {
+		return invalid; // lost
+	}
+	Handle_Handle32 handle = {(((uint32_t) gen) << Handle_GenerationBitShift32) | actualIndex};
+	return handle;
+}
+
+// one pass over a block's generations, no data dependent branches so it vectorises
+static void BumpGenerations32(uint8_t *gens, uint32_t count, bool neverReissueOldHandles) {
+	if (neverReissueOldHandles) {
+		// lost (0) stays lost and a wrap to 0 loses the slot
+		for (uint32_t i = 0u; i < count; ++i) {
+			gens[i] = (uint8_t) (gens[i] + (gens[i] != 0));
+		}
+	} else {
+		// intentional 8 bit integer overflow
+		for (uint32_t i = 0u; i < count; ++i) {
+			gens[i] = (uint8_t) (gens[i] + 1);
+		}
+	}
+}
+
+AL2O3_EXTERN_C void Handle_Manager32Reset(Handle_Manager32 *manager) {
+	if (manager->neverReissueOldHandles) {
+		// the fresh run's generation 0 slots are unborn not lost, so the bump mustn't lose them
+		uint64_t const run = Thread_AtomicLoad64Relaxed(&manager->freshRun);
+		uint32_t const runNext = (uint32_t) (run & 0xFFFFFFFFull);
+		uint32_t const runEnd = (uint32_t) (run >> 32ull);
+		if (runEnd > runNext) {
+			uint32_t blockIndex;
+			uint32_t slot;
+			uint32_t const blockHandles = Handle_Manager32Locate(manager, runNext, &blockIndex, &slot);
+			uint8_t *gens = Handle_Manager32BlockBase(manager, blockIndex) + (blockHandles * manager->elementSize) + slot;
+			for (uint32_t i = 0u; i < runEnd - runNext; ++i) {
+				gens[i] = (uint8_t) (gens[i] + (gens[i] == 0));
+			}
+		}
+	}
+
+	uint32_t const blockLimit = BlockLimit32(manager);
+	for (uint32_t i = 0u; i < blockLimit; ++i) {
+		uint8_t *base = Handle_Manager32BlockBase(manager, i);
+		if (!base) {
+			continue;
+		}
+		uint32_t const blockHandles = manager->geometric ?
+				(manager->handlesPerBlockMask + 1) << i :
+				manager->handlesPerBlockMask + 1;
+		BumpGenerations32(base + (blockHandles * manager->elementSize), blockHandles, manager->neverReissueOldHandles);
+		MarkAllDirty32(manager, base, blockHandles);
+	}
+
+	// handle 0 special case (unless it has just been lost by never reissue)
+	uint8_t *gen0 = Handle_Manager32BlockBase(manager, 0) + ((manager->handlesPerBlockMask + 1) * manager->elementSize);
+	if (*gen0 == 0 && !manager->neverReissueOldHandles) {
+		*gen0 = 1;
+	}
+
+	// every slot whether free, deferred or live is now reissued via the cursor
+	Thread_AtomicStore64Relaxed(&manager->freeListHeads, 0);
+	Thread_AtomicStore32Relaxed(&manager->remoteFreeHead, 0);
+	Thread_AtomicStore64Relaxed(&manager->freshRun, 0);
+	for (uint32_t i = 0u; i < Handle_FreeRunBuckets32; ++i) {
+		Thread_AtomicStore32Relaxed(manager->freeRunHeads + i, 0);
+	}
+	for (uint32_t i = 0u; i < Handle_MaxDeferredFrames32; ++i) {
+		manager->deferredFrames[i].count = 0;
+	}
+	manager->resetLimit = Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated);
+	Thread_AtomicStore32Relaxed(&manager->resetCursor, 0);
+}
+
+// clears count bits from first on, other threads may be setting bits in the same words
+static void ClearDirtyBits32(Thread_Atomic32_t *bits, uint32_t first, uint32_t count) {
+	while (count) {
+		uint32_t const shift = first & 31u;
+		uint32_t const n = (32u - shift) < count ? (32u - shift) : count;
+		uint32_t const mask = (n == 32u ? 0xFFFFFFFFu : ((1u << n) - 1u)) << shift;
+		Thread_Atomic32_t *word = bits + (first / 32u);
+		RedoC:;
+		uint32_t const old = Thread_AtomicLoad32Relaxed(word);
+		if (old & mask) {
+			if (Thread_AtomicCompareExchange32Relaxed(word, old, old & ~mask) != old) {
+				goto RedoC;
+			}
+		}
+		first += n;
+		count -= n;
+	}
+}
+
+AL2O3_EXTERN_C void Handle_Manager32MarkDirty(Handle_Manager32 *manager, Handle_Handle32 handle) {
+	ASSERT(Handle_Manager32IsValidAny(manager, handle));
+	MarkDirtyIndex32(manager, handle.handle & Handle_MaxHandles32);
+}
+
+AL2O3_EXTERN_C uint32_t Handle_Manager32CollectDirty(Handle_Manager32 *manager,
+																										 uint32_t startIndex,
+																										 Handle_DirtyRange32 *ranges,
+																										 uint32_t maxRanges) {
+	ASSERT(manager->dirtyTracked);
+	uint32_t rangeCount = 0;
+	uint32_t const total = Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated);
+	while (startIndex < total) {
+		uint32_t blockIndex;
+		uint32_t slot;
+		uint32_t const blockHandles = Handle_Manager32Locate(manager, startIndex, &blockIndex, &slot);
+		uint32_t const blockFirst = startIndex - slot;
+		startIndex = blockFirst + blockHandles;
+
+		uint8_t *base = Handle_Manager32BlockBase(manager, blockIndex);
+		if (!base) {
+			continue;
+		}
+		Thread_Atomic32_t *bits = DirtyBits32(manager, base, blockHandles);
+		// ranges never span blocks so each is one copy of data and generations
+		bool open = false;
+		while (slot < blockHandles) {
+			uint32_t const word = Thread_AtomicLoad32Relaxed(bits + (slot / 32u)) >> (slot & 31u);
+			if (word == 0) {
+				// nothing else set in this word
+				slot = (slot | 31u) + 1u;
+				open = false;
+				continue;
+			}
+			if ((word & 0x1u) == 0) {
+				slot++;
+				open = false;
+				continue;
+			}
+			if (open) {
+				ranges[rangeCount - 1].count++;
+			} else {
+				if (rangeCount == maxRanges) {
+					return rangeCount;
+				}
+				ranges[rangeCount].first = blockFirst + slot;
+				ranges[rangeCount].count = 1;
+				rangeCount++;
+				open = true;
+			}
+			slot++;
+		}
+	}
+	return rangeCount;
+}
+
+AL2O3_EXTERN_C void Handle_Manager32ClearDirty(Handle_Manager32 *manager,
+																							 Handle_DirtyRange32 const *ranges,
+																							 uint32_t rangeCount) {
+	ASSERT(manager->dirtyTracked);
+	for (uint32_t i = 0u; i < rangeCount; ++i) {
+		uint32_t actualIndex = ranges[i].first;
+		uint32_t count = ranges[i].count;
+		while (count) {
+			uint32_t blockIndex;
+			uint32_t slot;
+			uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &slot);
+			uint32_t const n = (blockHandles - slot) < count ? (blockHandles - slot) : count;
+			uint8_t *base = Handle_Manager32BlockBase(manager, blockIndex);
+			if (base) {
+				ClearDirtyBits32(DirtyBits32(manager, base, blockHandles), slot, n);
+			}
+			actualIndex += n;
+			count -= n;
+		}
+	}
+}
+
+// start of a delta, the free list state followed by rangeCount records of a
+// Handle_DirtyRange32, its generations then its elements, then each deferred
+// frame's deferredCounts indices (all unaligned)
+#define Handle_DeltaMagic32 0x34444448u // 'HDD4'
+typedef struct Handle_DeltaHeader32 {
+	uint32_t magic;
+	uint32_t elementSize;
+	uint32_t handlesPerBlock;
+	uint32_t rangeCount;
+	uint32_t totalHandlesAllocated;
+	uint32_t remoteFreeHead;
+	uint32_t resetCursor;
+	uint32_t resetLimit;
+	uint64_t freeListHeads;
+	uint64_t freshRun;
+	uint64_t pendingFrame;
+	uint32_t freeRunHeads[Handle_FreeRunBuckets32];
+	uint64_t deferredFrames[Handle_MaxDeferredFrames32];
+	uint32_t deferredCounts[Handle_MaxDeferredFrames32];
+} Handle_DeltaHeader32;
+
+AL2O3_EXTERN_C size_t Handle_Manager32SerialiseDelta(Handle_Manager32 *manager,
+																										 Handle_DirtyRange32 const *ranges,
+																										 uint32_t rangeCount,
+																										 void *dst,
+																										 size_t dstSize) {
+	// first pass sizes it, ranges are split at block boundaries
+	size_t size = sizeof(Handle_DeltaHeader32);
+	uint32_t recordCount = 0;
+	for (uint32_t i = 0u; i < rangeCount; ++i) {
+		uint32_t actualIndex = ranges[i].first;
+		uint32_t count = ranges[i].count;
+		while (count) {
+			uint32_t blockIndex;
+			uint32_t slot;
+			uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &slot);
+			uint32_t const n = (blockHandles - slot) < count ? (blockHandles - slot) : count;
+			size += sizeof(Handle_DirtyRange32) + (n * (manager->elementSize + Handle_GenerationSize32));
+			recordCount++;
+			actualIndex += n;
+			count -= n;
+		}
+	}
+	for (uint32_t i = 0u; i < Handle_MaxDeferredFrames32; ++i) {
+		size += manager->deferredFrames[i].count * sizeof(uint32_t);
+	}
+	if (!dst || dstSize < size) {
+		return size;
+	}
+
+	Handle_DeltaHeader32 header;
+	memset(&header, 0x0, sizeof(header));
+	header.magic = Handle_DeltaMagic32;
+	header.elementSize = manager->elementSize;
+	header.handlesPerBlock = manager->handlesPerBlockMask + 1;
+	header.rangeCount = recordCount;
+	header.totalHandlesAllocated = Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated);
+	header.remoteFreeHead = Thread_AtomicLoad32Relaxed(&manager->remoteFreeHead);
+	header.resetCursor = Thread_AtomicLoad32Relaxed(&manager->resetCursor);
+	header.resetLimit = manager->resetLimit;
+	header.freeListHeads = Thread_AtomicLoad64Relaxed(&manager->freeListHeads);
+	header.freshRun = Thread_AtomicLoad64Relaxed(&manager->freshRun);
+	header.pendingFrame = Thread_AtomicLoad64Relaxed(&manager->pendingFrame);
+	for (uint32_t i = 0u; i < Handle_FreeRunBuckets32; ++i) {
+		header.freeRunHeads[i] = Thread_AtomicLoad32Relaxed(manager->freeRunHeads + i);
+	}
+	for (uint32_t i = 0u; i < Handle_MaxDeferredFrames32; ++i) {
+		header.deferredFrames[i] = manager->deferredFrames[i].frame;
+		header.deferredCounts[i] = manager->deferredFrames[i].count;
+	}
+	uint8_t *out = (uint8_t *) dst;
+	memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+
+	for (uint32_t i = 0u; i < rangeCount; ++i) {
+		uint32_t actualIndex = ranges[i].first;
+		uint32_t count = ranges[i].count;
+		while (count) {
+			uint32_t blockIndex;
+			uint32_t slot;
+			uint32_t const blockHandles = Handle_Manager32Locate(manager, actualIndex, &blockIndex, &slot);
+			uint32_t const n = (blockHandles - slot) < count ? (blockHandles - slot) : count;
+			uint8_t const *base = Handle_Manager32BlockBase(manager, blockIndex);
+			ASSERT(base);
+			Handle_DirtyRange32 const record = {actualIndex, n};
+			memcpy(out, &record, sizeof(record));
+			out += sizeof(record);
+			memcpy(out, base + (blockHandles * manager->elementSize) + slot, n * Handle_GenerationSize32);
+			out += n * Handle_GenerationSize32;
+			memcpy(out, base + (slot * manager->elementSize), n * manager->elementSize);
+			out += n * manager->elementSize;
+			actualIndex += n;
+			count -= n;
+		}
+	}
+	for (uint32_t i = 0u; i < Handle_MaxDeferredFrames32; ++i) {
+		if (header.deferredCounts[i]) {
+			memcpy(out, manager->deferredFrames[i].indices, header.deferredCounts[i] * sizeof(uint32_t));
+			out += header.deferredCounts[i] * sizeof(uint32_t);
+		}
+	}
+	ASSERT((size_t) (out - (uint8_t *) dst) == size);
+	return size;
+}
+
+AL2O3_EXTERN_C bool Handle_Manager32ApplyDelta(Handle_Manager32 *manager, void const *src, size_t size) {
+	Handle_DeltaHeader32 header;
+	if (size < sizeof(header)) {
+		LOGWARNING("Delta is too small");
+		return false;
+	}
+	memcpy(&header, src, sizeof(header));
+	if (header.magic != Handle_DeltaMagic32 ||
+			header.elementSize != manager->elementSize ||
+			header.handlesPerBlock != manager->handlesPerBlockMask + 1) {
+		LOGWARNING("Delta is not from a handle manager with matching parameters");
+		return false;
+	}
+
+	uint8_t const *in = (uint8_t const *) src + sizeof(header);
+	uint8_t const *const end = (uint8_t const *) src + size;
+	for (uint32_t i = 0u; i < header.rangeCount; ++i) {
+		Handle_DirtyRange32 record;
+		if ((size_t) (end - in) < sizeof(record)) {
+			LOGWARNING("Delta is truncated");
+			return false;
+		}
+		memcpy(&record, in, sizeof(record));
+		in += sizeof(record);
+
+		uint32_t blockIndex;
+		uint32_t slot;
+		uint32_t const blockHandles = Handle_Manager32Locate(manager, record.first, &blockIndex, &slot);
+		if (blockIndex >= manager->maxBlocks || record.count > blockHandles - slot ||
+				(size_t) (end - in) < (size_t) record.count * (manager->elementSize + Handle_GenerationSize32)) {
+			LOGWARNING("Delta range %u + %u doesn't fit", record.first, record.count);
+			return false;
+		}
+		uint8_t *base = Handle_Manager32BlockBase(manager, blockIndex);
+		if (!base) {
+			// the source grew since the last delta
+			Thread_AtomicPtr_t *const entry = BlockEntry32(manager, blockIndex);
+			base = entry ? (uint8_t *) AllocBlockMemory32(manager, BlockSize32(manager, blockIndex), blockIndex) : NULL;
+			if (!base) {
+				LOGWARNING("Out of memory!");
+				return false;
+			}
+			Thread_AtomicStorePtrRelaxed(entry, base);
+			IndexBlock32(manager, blockIndex, base);
+		}
+		memcpy(base + (blockHandles * manager->elementSize) + slot, in, record.count * Handle_GenerationSize32);
+		in += record.count * Handle_GenerationSize32;
+		memcpy(base + (slot * manager->elementSize), in, record.count * manager->elementSize);
+		in += record.count * manager->elementSize;
+	}
+	for (uint32_t i = 0u; i < Handle_MaxDeferredFrames32; ++i) {
+		Handle_DeferredFrame32 *deferred = manager->deferredFrames + i;
+		size_t const bytes = header.deferredCounts[i] * sizeof(uint32_t);
+		if ((size_t) (end - in) < bytes) {
+			LOGWARNING("Delta is truncated");
+			return false;
+		}
+		if (!ReserveDeferred32(deferred, header.deferredCounts[i])) {
+			LOGWARNING("Out of memory!");
+			return false;
+		}
+		if (bytes) {
+			memcpy(deferred->indices, in, bytes);
+		}
+		in += bytes;
+		deferred->count = header.deferredCounts[i];
+		deferred->frame = header.deferredFrames[i];
+	}
+
+	Thread_AtomicStore32Relaxed(&manager->totalHandlesAllocated, header.totalHandlesAllocated);
+	Thread_AtomicStore32Relaxed(&manager->remoteFreeHead, header.remoteFreeHead);
+	Thread_AtomicStore32Relaxed(&manager->resetCursor, header.resetCursor);
+	manager->resetLimit = header.resetLimit;
+	Thread_AtomicStore64Relaxed(&manager->freeListHeads, header.freeListHeads);
+	Thread_AtomicStore64Relaxed(&manager->freshRun, header.freshRun);
+	Thread_AtomicStore64Relaxed(&manager->pendingFrame, header.pendingFrame);
+	for (uint32_t i = 0u; i < Handle_FreeRunBuckets32; ++i) {
+		Thread_AtomicStore32Relaxed(manager->freeRunHeads + i, header.freeRunHeads[i]);
+	}
+	return true;
+}
+
+AL2O3_EXTERN_C void Handle_Manager32ReleaseRange(Handle_Manager32 *manager, Handle_Handle32 firstHandle, uint32_t count) {
+	uint32_t const firstIndex = firstHandle.handle & Handle_MaxHandles32;
+	uint32_t blockIndex;
+	uint32_t slot;
+	uint32_t const blockHandles = Handle_Manager32Locate(manager, firstIndex, &blockIndex, &slot);
+	ASSERT(slot + count <= blockHandles);
+	uint8_t *const base = Handle_Manager32BlockBase(manager, blockIndex);
+	uint8_t *gens = base + (blockHandles * manager->elementSize) + slot;
+	uint8_t *items = base + (slot * manager->elementSize);
+
+	// retire each (checking it)
+	for (uint32_t i = 0u; i < count; ++i) {
+		Handle_Manager32Retire(manager, Handle_Manager32RangeHandle(firstHandle, i));
+	}
+	// handle 0 skips generation 0, the rest of its range skips it too so they still share one
+	if (firstIndex == 0 && !manager->neverReissueOldHandles) {
+		memset(gens, gens[0], count);
+	}
+	// unless lost, it goes back whole for the next AllocRange
+	if (count >= 2 && !(gens[0] == 0 && manager->neverReissueOldHandles)) {
+		PushFreeRun32(manager, firstIndex, count, gens[0]);
+		return;
+	}
+
+	// otherwise chain them back to front so they are reused in order
+	uint32_t chainHead = 0;
+	uint32_t tailIndex = 0;
+	for (uint32_t i = count; i-- > 0u;) {
+		uint32_t *item = (uint32_t *) (items + (i * manager->elementSize));
+		if (gens[i] == 0 && manager->neverReissueOldHandles) {
+			memset(item, 0xDC, manager->elementSize); // lost like Release
+			continue;
+		}
+		*item = chainHead;
+		MarkDirty32(manager, base, blockHandles, slot + i);
+		if (chainHead == 0) {
+			tailIndex = firstIndex + i;
+		}
+		chainHead = FreeLink32(gens[i], firstIndex + i);
+	}
+	// then back in one go
+	if (chainHead) {
+		SpliceDeferred32(manager, chainHead, tailIndex);
+	}
 }
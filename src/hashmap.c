@@ -0,0 +1,304 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_handle/hashmap.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HANDLE_HASHMAP_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define CtrlEmpty 0x80u
+#define CtrlDeleted 0xFEu
+#define NotFound (~0ull)
+
+// max load (including tombstones) is 7/8
+#define MaxLoad(capacity) ((capacity) - ((capacity) >> 3u))
+
+AL2O3_FORCE_INLINE uint32_t CountTrailingZeros(uint32_t mask) {
+	ASSERT(mask != 0);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (uint32_t) index;
+#else
+	return (uint32_t) __builtin_ctz(mask);
+#endif
+}
+
+// returns a bit per control byte in the group that equals value
+AL2O3_FORCE_INLINE uint32_t GroupMatch(uint8_t const *group, uint8_t value) {
+#if defined(HANDLE_HASHMAP_SSE2)
+	__m128i const ctrl = _mm_loadu_si128((__m128i const *) group);
+	return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char) value)));
+#else
+	uint32_t mask = 0;
+	for (uint32_t i = 0u; i < Handle_HashMapGroupWidth; ++i) {
+		mask |= (group[i] == value) ? (1u << i) : 0u;
+	}
+	return mask;
+#endif
+}
+
+// returns a bit per control byte in the group that is empty or deleted (top bit set)
+AL2O3_FORCE_INLINE uint32_t GroupMatchEmptyOrDeleted(uint8_t const *group) {
+#if defined(HANDLE_HASHMAP_SSE2)
+	return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((__m128i const *) group));
+#else
+	uint32_t mask = 0;
+	for (uint32_t i = 0u; i < Handle_HashMapGroupWidth; ++i) {
+		mask |= (group[i] & 0x80u) ? (1u << i) : 0u;
+	}
+	return mask;
+#endif
+}
+
+AL2O3_FORCE_INLINE uint8_t Tag(Handle_HashMap const *map, uint64_t index) {
+	// the low bits pick the slot, so fold in the bits above them for the tag
+	return (uint8_t) ((index ^ (index >> map->capacityShift)) & 0x7Fu);
+}
+
+AL2O3_FORCE_INLINE uint64_t *EntryKey(Handle_HashMap const *map, uint64_t slot) {
+	return (uint64_t *) (map->entries + (slot * map->entrySize));
+}
+
+AL2O3_FORCE_INLINE void *EntryValue(Handle_HashMap const *map, uint64_t slot) {
+	return map->entries + (slot * map->entrySize) + sizeof(uint64_t);
+}
+
+// returns the slot holding this index (any generation) or NotFound
+static uint64_t FindIndex(Handle_HashMap const *map, uint64_t index, uint64_t indexMask) {
+	uint64_t const groupCount = map->capacity / Handle_HashMapGroupWidth;
+	uint64_t group = (index & (map->capacity - 1)) / Handle_HashMapGroupWidth;
+	uint8_t const tag = Tag(map, index);
+
+	for (uint64_t probe = 0; probe < groupCount; ++probe) {
+		uint8_t const *ctrl = map->ctrl + (group * Handle_HashMapGroupWidth);
+		uint32_t match = GroupMatch(ctrl, tag);
+		while (match) {
+			uint64_t const slot = (group * Handle_HashMapGroupWidth) + CountTrailingZeros(match);
+			if ((*EntryKey(map, slot) & indexMask) == index) {
+				return slot;
+			}
+			match &= match - 1;
+		}
+		// an empty (not deleted) entry means the probe chain ends here
+		if (GroupMatch(ctrl, CtrlEmpty)) {
+			return NotFound;
+		}
+		group = (group + 1) & (groupCount - 1);
+	}
+	return NotFound;
+}
+
+// returns the first empty or deleted slot on the index's probe chain
+static uint64_t FindInsertSlot(Handle_HashMap const *map, uint64_t index) {
+	uint64_t const groupCount = map->capacity / Handle_HashMapGroupWidth;
+	uint64_t group = (index & (map->capacity - 1)) / Handle_HashMapGroupWidth;
+	for (;;) {
+		uint32_t const match = GroupMatchEmptyOrDeleted(map->ctrl + (group * Handle_HashMapGroupWidth));
+		if (match) {
+			return (group * Handle_HashMapGroupWidth) + CountTrailingZeros(match);
+		}
+		// load factor guarantees we will find one
+		group = (group + 1) & (groupCount - 1);
+	}
+}
+
+static bool AllocStorage(Handle_HashMap *map, uint64_t capacity) {
+	uint32_t shift = 0;
+	while ((1ull << shift) < capacity) {
+		shift++;
+	}
+	uint8_t *ctrl = (uint8_t *) MEMORY_MALLOC(capacity);
+	uint8_t *entries = (uint8_t *) MEMORY_MALLOC(capacity * map->entrySize);
+	if (!ctrl || !entries) {
+		LOGWARNING("Out of memory!");
+		MEMORY_FREE(ctrl);
+		MEMORY_FREE(entries);
+		return false;
+	}
+	memset(ctrl, CtrlEmpty, capacity);
+	map->ctrl = ctrl;
+	map->entries = entries;
+	map->capacity = capacity;
+	map->capacityShift = shift;
+	map->tombstones = 0;
+	return true;
+}
+
+// rebuilds the table, also the only time tombstones are reclaimed
+static bool Rehash(Handle_HashMap *map, uint64_t newCapacity, uint64_t indexMask) {
+	uint8_t *const oldCtrl = map->ctrl;
+	uint8_t *const oldEntries = map->entries;
+	uint64_t const oldCapacity = map->capacity;
+
+	if (!AllocStorage(map, newCapacity)) {
+		return false;
+	}
+
+	for (uint64_t i = 0; i < oldCapacity; ++i) {
+		if (oldCtrl[i] & 0x80u) {
+			continue;
+		}
+		uint8_t const *oldEntry = oldEntries + (i * map->entrySize);
+		uint64_t const index = *(uint64_t const *) oldEntry & indexMask;
+		uint64_t const slot = FindInsertSlot(map, index);
+		map->ctrl[slot] = Tag(map, index);
+		memcpy(EntryKey(map, slot), oldEntry, map->entrySize);
+	}
+
+	MEMORY_FREE(oldCtrl);
+	MEMORY_FREE(oldEntries);
+	return true;
+}
+
+static void *Insert(Handle_HashMap *map, uint64_t handle, uint64_t indexMask) {
+	ASSERT(handle != 0);
+	uint64_t const index = handle & indexMask;
+
+	uint64_t slot = FindIndex(map, index, indexMask);
+	if (slot != NotFound) {
+		uint64_t *key = EntryKey(map, slot);
+		if (*key != handle) {
+			// only one generation of an index can be alive, so the old one is dead
+			*key = handle;
+			memset(EntryValue(map, slot), 0x0, map->valueSize);
+		}
+		return EntryValue(map, slot);
+	}
+
+	if (map->count + map->tombstones + 1 > MaxLoad(map->capacity)) {
+		// if mostly tombstones, rebuilding at the same size is enough
+		uint64_t const newCapacity = (map->count + 1 > (map->capacity >> 1u)) ? map->capacity * 2 : map->capacity;
+		if (!Rehash(map, newCapacity, indexMask)) {
+			return NULL;
+		}
+	}
+
+	slot = FindInsertSlot(map, index);
+	if (map->ctrl[slot] == CtrlDeleted) {
+		map->tombstones--;
+	}
+	map->ctrl[slot] = Tag(map, index);
+	map->count++;
+	*EntryKey(map, slot) = handle;
+	memset(EntryValue(map, slot), 0x0, map->valueSize);
+	return EntryValue(map, slot);
+}
+
+static void *Lookup(Handle_HashMap *map, uint64_t handle, uint64_t indexMask) {
+	if (handle == 0) {
+		return NULL;
+	}
+	uint64_t const slot = FindIndex(map, handle & indexMask, indexMask);
+	if (slot == NotFound || *EntryKey(map, slot) != handle) {
+		return NULL;
+	}
+	return EntryValue(map, slot);
+}
+
+static void RemoveSlot(Handle_HashMap *map, uint64_t slot) {
+	map->ctrl[slot] = CtrlDeleted;
+	map->count--;
+	map->tombstones++;
+}
+
+static bool Remove(Handle_HashMap *map, uint64_t handle, uint64_t indexMask) {
+	if (handle == 0) {
+		return false;
+	}
+	uint64_t const slot = FindIndex(map, handle & indexMask, indexMask);
+	if (slot == NotFound || *EntryKey(map, slot) != handle) {
+		return false;
+	}
+	RemoveSlot(map, slot);
+	return true;
+}
+
+AL2O3_EXTERN_C Handle_HashMap *Handle_HashMapCreate(uint32_t valueSize, uint64_t initialCapacity) {
+	Handle_HashMap *map = (Handle_HashMap *) MEMORY_CALLOC(1, sizeof(Handle_HashMap));
+	if (!map) {
+		return NULL;
+	}
+	map->valueSize = valueSize;
+	// keep keys 8 byte aligned
+	map->entrySize = (uint32_t) ((sizeof(uint64_t) + valueSize + 0x7u) & ~0x7u);
+
+	// round up to a power of 2 number of groups that can hold initial capacity
+	uint64_t capacity = Handle_HashMapGroupWidth;
+	while (MaxLoad(capacity) < initialCapacity) {
+		capacity *= 2;
+	}
+	if (!AllocStorage(map, capacity)) {
+		MEMORY_FREE(map);
+		return NULL;
+	}
+	return map;
+}
+
+AL2O3_EXTERN_C void Handle_HashMapDestroy(Handle_HashMap *map) {
+	if (!map) {
+		return;
+	}
+	MEMORY_FREE(map->ctrl);
+	MEMORY_FREE(map->entries);
+	MEMORY_FREE(map);
+}
+
+AL2O3_EXTERN_C void *Handle_HashMapInsert32(Handle_HashMap *map, Handle_Handle32 key) {
+	return Insert(map, key.handle, Handle_MaxHandles32);
+}
+
+AL2O3_EXTERN_C void *Handle_HashMapLookup32(Handle_HashMap *map, Handle_Handle32 key) {
+	return Lookup(map, key.handle, Handle_MaxHandles32);
+}
+
+AL2O3_EXTERN_C bool Handle_HashMapRemove32(Handle_HashMap *map, Handle_Handle32 key) {
+	return Remove(map, key.handle, Handle_MaxHandles32);
+}
+
+AL2O3_EXTERN_C uint64_t Handle_HashMapPurge32(Handle_HashMap *map, Handle_Manager32 *manager) {
+	uint64_t removed = 0;
+	for (uint64_t i = 0; i < map->capacity; ++i) {
+		if (map->ctrl[i] & 0x80u) {
+			continue;
+		}
+		Handle_Handle32 const handle = {(uint32_t) *EntryKey(map, i)};
+		if (!Handle_Manager32IsValidAny(manager, handle)) {
+			RemoveSlot(map, i);
+			removed++;
+		}
+	}
+	return removed;
+}
+
+AL2O3_EXTERN_C void *Handle_HashMapInsert64(Handle_HashMap *map, Handle_Handle64 key) {
+	return Insert(map, key.handle, Handle_MaxHandles64);
+}
+
+AL2O3_EXTERN_C void *Handle_HashMapLookup64(Handle_HashMap *map, Handle_Handle64 key) {
+	return Lookup(map, key.handle, Handle_MaxHandles64);
+}
+
+AL2O3_EXTERN_C bool Handle_HashMapRemove64(Handle_HashMap *map, Handle_Handle64 key) {
+	return Remove(map, key.handle, Handle_MaxHandles64);
+}
+
+AL2O3_EXTERN_C uint64_t Handle_HashMapPurge64(Handle_HashMap *map, Handle_Manager64 *manager) {
+	uint64_t removed = 0;
+	for (uint64_t i = 0; i < map->capacity; ++i) {
+		if (map->ctrl[i] & 0x80u) {
+			continue;
+		}
+		Handle_Handle64 const handle = {*EntryKey(map, i)};
+		if (!Handle_Manager64IsValid(manager, handle)) {
+			RemoveSlot(map, i);
+			removed++;
+		}
+	}
+	return removed;
+}
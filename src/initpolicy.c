@@ -0,0 +1,66 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_handle/initpolicy.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HANDLE_INIT_SSE2 1
+#endif
+
+static void StreamZero(void *dst, size_t size) {
+#if defined(HANDLE_INIT_SSE2)
+	uint8_t *ptr = (uint8_t *) dst;
+	// streaming stores need 16 byte alignment, normal stores for the ragged ends
+	size_t const head = (16u - ((uintptr_t) ptr & 0xFu)) & 0xFu;
+	if (size < head + 64u) {
+		memset(ptr, 0x0, size);
+		return;
+	}
+	memset(ptr, 0x0, head);
+	ptr += head;
+	size -= head;
+
+	__m128i const zero = _mm_setzero_si128();
+	while (size >= 64u) {
+		_mm_stream_si128((__m128i *) (ptr + 0), zero);
+		_mm_stream_si128((__m128i *) (ptr + 16), zero);
+		_mm_stream_si128((__m128i *) (ptr + 32), zero);
+		_mm_stream_si128((__m128i *) (ptr + 48), zero);
+		ptr += 64;
+		size -= 64;
+	}
+	while (size >= 16u) {
+		_mm_stream_si128((__m128i *) ptr, zero);
+		ptr += 16;
+		size -= 16;
+	}
+	memset(ptr, 0x0, size);
+#else
+	memset(dst, 0x0, size);
+#endif
+}
+
+AL2O3_EXTERN_C void Handle_InitElementsSlow(Handle_ElementInit const *init, void *elements, size_t elementSize, uint32_t count) {
+	switch (init->policy) {
+		case Handle_InitPolicyZero: memset(elements, 0x0, elementSize * count);
+			break;
+		case Handle_InitPolicyNone: break;
+		case Handle_InitPolicyCallback: {
+			ASSERT(init->func);
+			uint8_t *element = (uint8_t *) elements;
+			for (uint32_t i = 0u; i < count; ++i) {
+				init->func(init->userData, element, elementSize);
+				element += elementSize;
+			}
+			break;
+		}
+		case Handle_InitPolicyStreamZero: StreamZero(elements, elementSize * count);
+			break;
+	}
+}
+
+AL2O3_EXTERN_C void Handle_InitStreamFence(void) {
+#if defined(HANDLE_INIT_SSE2)
+	_mm_sfence();
+#endif
+}
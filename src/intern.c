@@ -0,0 +1,280 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_thread/thread.h"
+#include "al2o3_handle/intern.h"
+#include "internal.h"
+
+#define InitialBuckets 16u
+
+AL2O3_FORCE_INLINE uint64_t Mix64(uint64_t h) {
+	h ^= h >> 33u;
+	h *= 0xFF51AFD7ED558CCDull;
+	h ^= h >> 33u;
+	h *= 0xC4CEB9FE1A85EC53ull;
+	h ^= h >> 33u;
+	return h;
+}
+
+// 8 bytes a step, the tail is packed into one last word with the length
+static uint32_t HashBytes(void const *data, size_t size) {
+	uint8_t const *bytes = (uint8_t const *) data;
+	uint64_t h = 0x9E3779B97F4A7C15ull ^ (uint64_t) size;
+	while (size >= sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, bytes, sizeof(uint64_t));
+		h = (h ^ Mix64(word)) * 0x9E3779B97F4A7C15ull;
+		bytes += sizeof(uint64_t);
+		size -= sizeof(uint64_t);
+	}
+	uint64_t tail = 0;
+	memcpy(&tail, bytes, size);
+	h = Mix64(h ^ tail);
+	return (uint32_t) (h ^ (h >> 32u));
+}
+
+// the top bits pick the stripe, the low bits the bucket within it
+AL2O3_FORCE_INLINE Handle_InternStripe *HashToStripe(Handle_InternTable *table, uint32_t hash) {
+	if (table->stripeShift == 0) {
+		return table->stripes;
+	}
+	return table->stripes + (hash >> (32u - table->stripeShift));
+}
+
+static void LockStripe(Handle_InternStripe *stripe) {
+	while (Thread_AtomicCompareExchange32Relaxed(&stripe->lock, 0, 1) != 0) {
+		// spin on a plain load so waiting doesn't keep stealing the line
+		while (Thread_AtomicLoad32Relaxed(&stripe->lock) != 0) {
+		}
+	}
+	Thread_AtomicThreadFenceAcquire();
+}
+
+static void UnlockStripe(Handle_InternStripe *stripe) {
+	Thread_AtomicThreadFenceRelease();
+	Thread_AtomicStore32Relaxed(&stripe->lock, 0);
+}
+
+// chained entries are always live while the stripe is locked
+AL2O3_FORCE_INLINE Handle_InternEntry32 *ChainEntry(Handle_InternTable *table, uint32_t handle) {
+	Handle_Handle32 const h = {handle};
+	Handle_InternEntry32 *entry = (Handle_InternEntry32 *) Handle_Manager32HandleToPtr(table->entries, h);
+	ASSERT(entry);
+	return entry;
+}
+
+AL2O3_FORCE_INLINE void const *EntryBytes(Handle_InternTable *table, Handle_InternEntry32 const *entry) {
+	if (entry->size <= Handle_InternInlineSize) {
+		return entry->data.bytes;
+	}
+	return Handle_SizeClassHandleToPtr(table->blobs, entry->data.blob);
+}
+
+// stripe must be locked, returns the handle or 0
+static uint32_t FindLocked(Handle_InternTable *table,
+													 Handle_InternStripe *stripe,
+													 uint32_t hash,
+													 void const *data,
+													 size_t size) {
+	uint32_t handle = stripe->buckets[hash & stripe->bucketMask];
+	while (handle != 0) {
+		Handle_InternEntry32 const *entry = ChainEntry(table, handle);
+		if (entry->hash == hash && entry->size == size && memcmp(EntryBytes(table, entry), data, size) == 0) {
+			return handle;
+		}
+		handle = entry->next;
+	}
+	return 0;
+}
+
+// stripe must be locked, doubles the bucket array and relinks the chains
+// a failed grow leaves the old array, the chains just get longer
+static void GrowLocked(Handle_InternTable *table, Handle_InternStripe *stripe) {
+	uint32_t const oldCount = stripe->bucketMask + 1;
+	uint32_t const newCount = oldCount * 2u;
+	uint32_t *buckets = (uint32_t *) MEMORY_CALLOC(newCount, sizeof(uint32_t));
+	if (!buckets) {
+		return;
+	}
+	for (uint32_t i = 0u; i < oldCount; ++i) {
+		uint32_t handle = stripe->buckets[i];
+		while (handle != 0) {
+			Handle_InternEntry32 *entry = ChainEntry(table, handle);
+			uint32_t const next = entry->next;
+			uint32_t *head = buckets + (entry->hash & (newCount - 1));
+			entry->next = *head;
+			*head = handle;
+			handle = next;
+		}
+	}
+	MEMORY_FREE(stripe->buckets);
+	stripe->buckets = buckets;
+	stripe->bucketMask = newCount - 1;
+}
+
+AL2O3_EXTERN_C Handle_InternTable *Handle_InternTableCreate(uint32_t entriesPerBlock,
+																														uint32_t maxBlocks,
+																														uint32_t stripeCount,
+																														bool neverReissueOldHandles) {
+	if (stripeCount == 0) {
+		stripeCount = Thread_CPUCoreCount() * 4u;
+	}
+	stripeCount = NextPow2(stripeCount);
+	if (stripeCount > Handle_InternMaxStripes) {
+		stripeCount = Handle_InternMaxStripes;
+	}
+
+	size_t const allocSize = sizeof(Handle_InternTable) +
+			Handle_InternCacheLineSize + // padding to cache line align the stripes
+			(stripeCount * sizeof(Handle_InternStripe));
+
+	Handle_InternTable *table = (Handle_InternTable *) MEMORY_CALLOC(1, allocSize);
+	if (!table) {
+		return NULL;
+	}
+	table->stripeCount = stripeCount;
+	table->stripeShift = SlowLog2(stripeCount);
+
+	uintptr_t const afterHeader = (uintptr_t) (table + 1);
+	table->stripes = (Handle_InternStripe *) ((afterHeader + Handle_InternCacheLineSize - 1) &
+			~(uintptr_t) (Handle_InternCacheLineSize - 1));
+
+	table->entries =
+			Handle_Manager32Create(sizeof(Handle_InternEntry32), entriesPerBlock, maxBlocks, neverReissueOldHandles);
+	table->blobs = Handle_SizeClassAllocatorCreate(Handle_InternBlobBlockSize, maxBlocks);
+	if (!table->entries || !table->blobs) {
+		Handle_InternTableDestroy(table);
+		return NULL;
+	}
+
+	for (uint32_t i = 0u; i < stripeCount; ++i) {
+		Handle_InternStripe *stripe = table->stripes + i;
+		stripe->buckets = (uint32_t *) MEMORY_CALLOC(InitialBuckets, sizeof(uint32_t));
+		if (!stripe->buckets) {
+			Handle_InternTableDestroy(table);
+			return NULL;
+		}
+		stripe->bucketMask = InitialBuckets - 1;
+	}
+
+	return table;
+}
+
+AL2O3_EXTERN_C void Handle_InternTableDestroy(Handle_InternTable *table) {
+	if (!table) {
+		return;
+	}
+	for (uint32_t i = 0u; i < table->stripeCount; ++i) {
+		if (table->stripes[i].buckets) {
+			MEMORY_FREE(table->stripes[i].buckets);
+		}
+	}
+	// frees the blobs still interned too
+	Handle_SizeClassAllocatorDestroy(table->blobs);
+	Handle_Manager32Destroy(table->entries);
+	MEMORY_FREE(table);
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_InternTableIntern(Handle_InternTable *table, void const *data, size_t size) {
+	Handle_Handle32 invalid = {0};
+	if (size > UINT32_MAX) {
+		LOGWARNING("Intern tables can't hold blobs of 4 GiB or more");
+		return invalid;
+	}
+
+	uint32_t const hash = HashBytes(data, size);
+	Handle_InternStripe *stripe = HashToStripe(table, hash);
+
+	LockStripe(stripe);
+	uint32_t const found = FindLocked(table, stripe, hash, data, size);
+	if (found != 0) {
+		UnlockStripe(stripe);
+		Handle_Handle32 const handle = {found};
+		return handle;
+	}
+
+	// not there, so insert while still holding the lock so no one else can
+	Handle_Handle32 const handle = Handle_Manager32Alloc(table->entries);
+	if (handle.handle == 0) {
+		UnlockStripe(stripe);
+		return invalid;
+	}
+	Handle_InternEntry32 *entry = (Handle_InternEntry32 *) Handle_Manager32HandleToPtr(table->entries, handle);
+	if (size <= Handle_InternInlineSize) {
+		memcpy(entry->data.bytes, data, size);
+	} else {
+		Handle_Handle64 const blob = Handle_SizeClassAlloc(table->blobs, size);
+		if (blob.handle == 0) {
+			UnlockStripe(stripe);
+			Handle_Manager32Release(table->entries, handle);
+			return invalid;
+		}
+		memcpy(Handle_SizeClassHandleToPtr(table->blobs, blob), data, size);
+		entry->data.blob = blob;
+	}
+	entry->hash = hash;
+	entry->size = (uint32_t) size;
+
+	uint32_t *head = stripe->buckets + (hash & stripe->bucketMask);
+	entry->next = *head;
+	*head = handle.handle;
+	stripe->count++;
+	// keep the average chain at 1 or less
+	if (stripe->count > stripe->bucketMask + 1) {
+		GrowLocked(table, stripe);
+	}
+	UnlockStripe(stripe);
+
+	return handle;
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_InternTableFind(Handle_InternTable *table, void const *data, size_t size) {
+	uint32_t const hash = HashBytes(data, size);
+	Handle_InternStripe *stripe = HashToStripe(table, hash);
+
+	LockStripe(stripe);
+	Handle_Handle32 const handle = {FindLocked(table, stripe, hash, data, size)};
+	UnlockStripe(stripe);
+	return handle;
+}
+
+AL2O3_EXTERN_C bool Handle_InternTableRelease(Handle_InternTable *table, Handle_Handle32 handle) {
+	if (!Handle_Manager32IsValid(table->entries, handle)) {
+		return false;
+	}
+	Handle_InternEntry32 const *entry =
+			(Handle_InternEntry32 const *) Handle_Manager32HandleToPtr(table->entries, handle);
+	uint32_t const hash = entry->hash;
+	Handle_InternStripe *stripe = HashToStripe(table, hash);
+
+	LockStripe(stripe);
+	// another release may have won while we waited for the lock
+	if (!Handle_Manager32IsValid(table->entries, handle)) {
+		UnlockStripe(stripe);
+		return false;
+	}
+	uint32_t *link = stripe->buckets + (hash & stripe->bucketMask);
+	while (*link != handle.handle) {
+		ASSERT(*link != 0);
+		link = &ChainEntry(table, *link)->next;
+	}
+	*link = entry->next;
+	stripe->count--;
+	if (entry->size > Handle_InternInlineSize) {
+		Handle_SizeClassRelease(table->blobs, entry->data.blob);
+	}
+	// released under the lock so a racing release sees it stale
+	Handle_Manager32Release(table->entries, handle);
+	UnlockStripe(stripe);
+
+	return true;
+}
+
+AL2O3_EXTERN_C uint32_t Handle_InternTableCount(Handle_InternTable *table) {
+	uint32_t count = 0;
+	for (uint32_t i = 0u; i < table->stripeCount; ++i) {
+		count += table->stripes[i].count;
+	}
+	return count;
+}
@@ -0,0 +1,120 @@
+// License Summary: MIT see LICENSE file
+#pragma once
+// private helpers shared by the library's translation units, not installed
+
+#include "al2o3_platform/platform.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_handle/handle.h"
+
+AL2O3_FORCE_INLINE bool IsPow2(uint32_t num) {
+	return ((num & (num - 1)) == 0);
+}
+
+AL2O3_FORCE_INLINE uint32_t NextPow2(uint32_t num) {
+	num -= 1;
+	num |= num >> 16u;
+	num |= num >> 8u;
+	num |= num >> 4u;
+	num |= num >> 2u;
+	num |= num >> 1u;
+
+	return num + 1;
+}
+
+AL2O3_FORCE_INLINE bool IsPow2_64(uint64_t num) {
+	return ((num & (num - 1)) == 0);
+}
+
+AL2O3_FORCE_INLINE uint64_t NextPow2_64(uint64_t num) {
+	num -= 1;
+	num |= num >> 32u;
+	num |= num >> 16u;
+	num |= num >> 8u;
+	num |= num >> 4u;
+	num |= num >> 2u;
+	num |= num >> 1u;
+
+	return num + 1;
+}
+
+// assumes power of 2, 0 and 1 are both 0
+AL2O3_FORCE_INLINE uint32_t SlowLog2(uint32_t num) {
+	uint32_t count = 0;
+	while (num > 1u) {
+		num >>= 1u;
+		count++;
+	}
+	return count;
+}
+
+// The 32 bit free list transaction used by Manager32 and the sharded and
+// shared managers. heads packs 2 linked lists in a 64 bit location, the free
+// list in the low 32 bits and the deferred list in the high 32 bits, 0 is
+// empty. Links are the index tagged with its generation so a stale pop fails
+// its CAS (ABA), index 0 is never generation 0 while free so a link is never
+// 0. Both lists are always updated atomically together, if any
+// release or alloc has happened in between the CAS fails and we redo.
+
+AL2O3_FORCE_INLINE uint32_t FreeLink32(uint8_t gen, uint32_t actualIndex) {
+	return (((uint32_t) gen) << Handle_GenerationBitShift32) | actualIndex;
+}
+
+// where an index's link lives, for Handle_FreeListPop32
+typedef uint32_t *(*Handle_FreeListItemFunc32)(void *context, uint32_t actualIndex);
+
+// pushes an already linked chain (headLink ... tailItem) onto the free list
+// without disturbing the deferred list
+AL2O3_FORCE_INLINE void Handle_FreeListPushFree32(Thread_Atomic64_t *freeListHeads, uint32_t headLink, uint32_t *tailItem) {
+	RedoF:;
+	uint64_t const heads = Thread_AtomicLoad64Relaxed(freeListHeads);
+	// point the tail at the existing free list (it might not be valid by now)
+	*tailItem = (uint32_t) (heads & 0xFFFFFFFFull);
+	uint64_t const newHeads = (heads & ~0xFFFFFFFFull) | headLink;
+	if (Thread_AtomicCompareExchange64Relaxed(freeListHeads, heads, newHeads) != heads) {
+		goto RedoF; // something changed reverse the transaction
+	}
+}
+
+// pushes an already linked chain (headLink ... tailItem) onto the deferred list
+// without disturbing the free list, a single release is a chain of one
+AL2O3_FORCE_INLINE void Handle_FreeListPushDeferred32(Thread_Atomic64_t *freeListHeads,
+																											uint32_t headLink,
+																											uint32_t *tailItem) {
+	RedoD:;
+	uint64_t const heads = Thread_AtomicLoad64Relaxed(freeListHeads);
+	*tailItem = (uint32_t) (heads >> 32ull);
+	uint64_t const newHeads = (((uint64_t) headLink) << 32ull) | (heads & 0xFFFFFFFFull);
+	if (Thread_AtomicCompareExchange64Relaxed(freeListHeads, heads, newHeads) != heads) {
+		goto RedoD; // transaction fail redo inserting into the deferred list
+	}
+}
+
+// pops the free list head, moving the deferred list over when the free list
+// is empty. false if both are empty
+AL2O3_FORCE_INLINE bool Handle_FreeListPop32(Thread_Atomic64_t *freeListHeads,
+																						 Handle_FreeListItemFunc32 itemFunc,
+																						 void *context,
+																						 uint32_t *outIndex) {
+	RedoP:;
+	uint64_t const heads = Thread_AtomicLoad64Relaxed(freeListHeads);
+	uint32_t const headsFreePart = (uint32_t) (heads & 0xFFFFFFFFull);
+	uint64_t const headsDeferFreePart = heads & ~0xFFFFFFFFull;
+
+	if (headsFreePart == 0) {
+		if (headsDeferFreePart == 0) {
+			return false;
+		}
+		// move the deferred list into the free list, a failure is the same as a retry
+		Thread_AtomicCompareExchange64Relaxed(freeListHeads, heads, headsDeferFreePart >> 32u);
+		goto RedoP;
+	}
+
+	// we chain to the next entry in the free list without disturbing the deferred list
+	uint32_t const actualIndex = headsFreePart & Handle_MaxHandles32;
+	uint64_t const newHeads = headsDeferFreePart | *itemFunc(context, actualIndex);
+	if (Thread_AtomicCompareExchange64Relaxed(freeListHeads, heads, newHeads) != heads) {
+		goto RedoP; // something changed reverse the transaction
+	}
+	*outIndex = actualIndex;
+	return true;
+}
@@ -0,0 +1,202 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_handle/list.h"
+
+static Handle_ListLink32 *ListLink(Handle_List32 const *list, Handle_Handle32 node) {
+	ASSERT(Handle_Manager32IsValidAny(list->manager, node));
+	uint8_t *ptr = (uint8_t *) Handle_Manager32HandleToPtrAny(list->manager, node);
+	return (Handle_ListLink32 *) (ptr + list->linkOffset);
+}
+
+// neighbours are trusted, a dangling one means a node was released whilst still
+// linked which is a bug in the caller. Handle_List32Validate finds it in release builds
+static Handle_ListLink32 *NeighbourLink(Handle_List32 const *list, Handle_Handle32 neighbour) {
+	ASSERT(Handle_Manager32IsValidAny(list->manager, neighbour));
+	return ListLink(list, neighbour);
+}
+
+static Handle_QueueLink32 *QueueLink(Handle_Queue32 const *queue, Handle_Handle32 node) {
+	ASSERT(Handle_Manager32IsValidAny(queue->manager, node));
+	uint8_t *ptr = (uint8_t *) Handle_Manager32HandleToPtrAny(queue->manager, node);
+	return (Handle_QueueLink32 *) (ptr + queue->linkOffset);
+}
+
+AL2O3_EXTERN_C void Handle_List32Init(Handle_List32 *list, Handle_Manager32 *manager, uint32_t linkOffset) {
+	ASSERT(linkOffset + sizeof(Handle_ListLink32) <= manager->elementSize);
+	list->manager = manager;
+	list->linkOffset = linkOffset;
+	list->count = 0;
+	list->head.handle = 0;
+	list->tail.handle = 0;
+}
+
+AL2O3_EXTERN_C void Handle_List32PushFront(Handle_List32 *list, Handle_Handle32 node) {
+	Handle_ListLink32 *link = ListLink(list, node);
+	link->prev.handle = 0;
+	link->next = list->head;
+	if (list->head.handle) {
+		NeighbourLink(list, list->head)->prev = node;
+	} else {
+		list->tail = node;
+	}
+	list->head = node;
+	list->count++;
+}
+
+AL2O3_EXTERN_C void Handle_List32PushBack(Handle_List32 *list, Handle_Handle32 node) {
+	Handle_ListLink32 *link = ListLink(list, node);
+	link->next.handle = 0;
+	link->prev = list->tail;
+	if (list->tail.handle) {
+		NeighbourLink(list, list->tail)->next = node;
+	} else {
+		list->head = node;
+	}
+	list->tail = node;
+	list->count++;
+}
+
+AL2O3_EXTERN_C void Handle_List32InsertAfter(Handle_List32 *list, Handle_Handle32 pos, Handle_Handle32 node) {
+	Handle_ListLink32 *posLink = ListLink(list, pos);
+	if (posLink->next.handle == 0) {
+		Handle_List32PushBack(list, node);
+		return;
+	}
+	Handle_ListLink32 *link = ListLink(list, node);
+	link->prev = pos;
+	link->next = posLink->next;
+	NeighbourLink(list, posLink->next)->prev = node;
+	posLink->next = node;
+	list->count++;
+}
+
+AL2O3_EXTERN_C void Handle_List32InsertBefore(Handle_List32 *list, Handle_Handle32 pos, Handle_Handle32 node) {
+	Handle_ListLink32 *posLink = ListLink(list, pos);
+	if (posLink->prev.handle == 0) {
+		Handle_List32PushFront(list, node);
+		return;
+	}
+	Handle_ListLink32 *link = ListLink(list, node);
+	link->next = pos;
+	link->prev = posLink->prev;
+	NeighbourLink(list, posLink->prev)->next = node;
+	posLink->prev = node;
+	list->count++;
+}
+
+AL2O3_EXTERN_C void Handle_List32Remove(Handle_List32 *list, Handle_Handle32 node) {
+	ASSERT(list->count > 0);
+	Handle_ListLink32 *link = ListLink(list, node);
+	if (link->prev.handle) {
+		NeighbourLink(list, link->prev)->next = link->next;
+	} else {
+		ASSERT(Handle_HandleEqual32(list->head, node));
+		list->head = link->next;
+	}
+	if (link->next.handle) {
+		NeighbourLink(list, link->next)->prev = link->prev;
+	} else {
+		ASSERT(Handle_HandleEqual32(list->tail, node));
+		list->tail = link->prev;
+	}
+	link->next.handle = 0;
+	link->prev.handle = 0;
+	list->count--;
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_List32PopFront(Handle_List32 *list) {
+	Handle_Handle32 node = list->head;
+	if (node.handle) {
+		Handle_List32Remove(list, node);
+	}
+	return node;
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_List32PopBack(Handle_List32 *list) {
+	Handle_Handle32 node = list->tail;
+	if (node.handle) {
+		Handle_List32Remove(list, node);
+	}
+	return node;
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_List32Next(Handle_List32 const *list, Handle_Handle32 node) {
+	Handle_Handle32 next = ListLink(list, node)->next;
+	if (next.handle && !Handle_Manager32IsValidAny(list->manager, next)) {
+		LOGWARNING("Dangling list link, node was released without being removed");
+		next.handle = 0;
+	}
+	return next;
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_List32Prev(Handle_List32 const *list, Handle_Handle32 node) {
+	Handle_Handle32 prev = ListLink(list, node)->prev;
+	if (prev.handle && !Handle_Manager32IsValidAny(list->manager, prev)) {
+		LOGWARNING("Dangling list link, node was released without being removed");
+		prev.handle = 0;
+	}
+	return prev;
+}
+
+AL2O3_EXTERN_C bool Handle_List32Validate(Handle_List32 const *list) {
+	uint32_t count = 0;
+	Handle_Handle32 prev = {0};
+	Handle_Handle32 node = list->head;
+	while (node.handle) {
+		if (!Handle_Manager32IsValidAny(list->manager, node) || count >= list->count) {
+			return false;
+		}
+		Handle_ListLink32 const *link = ListLink(list, node);
+		if (!Handle_HandleEqual32(link->prev, prev)) {
+			return false;
+		}
+		prev = node;
+		node = link->next;
+		count++;
+	}
+	return (count == list->count) && Handle_HandleEqual32(prev, list->tail);
+}
+
+AL2O3_EXTERN_C void Handle_Queue32Init(Handle_Queue32 *queue, Handle_Manager32 *manager, uint32_t linkOffset) {
+	ASSERT(linkOffset + sizeof(Handle_QueueLink32) <= manager->elementSize);
+	queue->manager = manager;
+	queue->linkOffset = linkOffset;
+	queue->count = 0;
+	queue->head.handle = 0;
+	queue->tail.handle = 0;
+}
+
+AL2O3_EXTERN_C void Handle_Queue32Push(Handle_Queue32 *queue, Handle_Handle32 node) {
+	QueueLink(queue, node)->next.handle = 0;
+	if (queue->tail.handle) {
+		QueueLink(queue, queue->tail)->next = node;
+	} else {
+		queue->head = node;
+	}
+	queue->tail = node;
+	queue->count++;
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_Queue32Pop(Handle_Queue32 *queue) {
+	Handle_Handle32 node = queue->head;
+	if (node.handle == 0) {
+		return node;
+	}
+	Handle_QueueLink32 *link = QueueLink(queue, node);
+	if (link->next.handle && !Handle_Manager32IsValidAny(queue->manager, link->next)) {
+		// nothing past a dangling link is reachable, so truncate the queue here
+		LOGWARNING("Dangling queue link, node was released without being popped");
+		link->next.handle = 0;
+		queue->head.handle = 0;
+		queue->tail.handle = 0;
+		queue->count = 0;
+		return node;
+	}
+	queue->head = link->next;
+	if (queue->head.handle == 0) {
+		queue->tail.handle = 0;
+	}
+	link->next.handle = 0;
+	queue->count--;
+	return node;
+}
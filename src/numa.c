@@ -0,0 +1,110 @@
+// License Summary: MIT see LICENSE file
+// syscall needs this and must be defined before any system header
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_handle/numa.h"
+
+#if defined(__linux__)
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define HANDLE_NUMA_LINUX 1
+// from linux/mempolicy.h, preferred falls back to other nodes when full
+#define HANDLE_NUMA_MPOL_PREFERRED 1
+#endif
+
+// 0 means not yet queried, benign race as every thread computes the same value
+static uint32_t s_nodeCount = 0;
+
+AL2O3_EXTERN_C uint32_t Handle_NumaNodeCount(void) {
+	if (s_nodeCount != 0) {
+		return s_nodeCount;
+	}
+	uint32_t count = 1;
+#if defined(HANDLE_NUMA_LINUX)
+	// has_memory is a list of ranges i.e. "0" or "0-1" or "0-1,4", we want the max + 1
+	// possible would include hot plug slots that aren't there, and nodes without
+	// memory have nothing to place blocks on
+	FILE *file = fopen("/sys/devices/system/node/has_memory", "r");
+	if (file) {
+		uint32_t node = 0;
+		int c;
+		while ((c = fgetc(file)) != EOF) {
+			if (c >= '0' && c <= '9') {
+				node = (node * 10) + (uint32_t) (c - '0');
+			} else {
+				node = 0;
+			}
+			if (node + 1 > count) {
+				count = node + 1;
+			}
+		}
+		fclose(file);
+	}
+#endif
+	if (count > Handle_NumaMaxNodes) {
+		count = Handle_NumaMaxNodes;
+	}
+	s_nodeCount = count;
+	return count;
+}
+
+AL2O3_EXTERN_C uint32_t Handle_NumaCurrentNode(void) {
+#if defined(HANDLE_NUMA_LINUX) && defined(SYS_getcpu)
+	unsigned int cpu = 0;
+	unsigned int node = 0;
+	if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0 && node < Handle_NumaMaxNodes) {
+		return node;
+	}
+#endif
+	return 0;
+}
+
+AL2O3_EXTERN_C uint32_t Handle_NumaResolveNode(int32_t numaNode) {
+	if (numaNode < 0) {
+		return Handle_NumaCurrentNode();
+	}
+	ASSERT(numaNode < Handle_NumaMaxNodes);
+	return (uint32_t) numaNode;
+}
+
+AL2O3_EXTERN_C void *Handle_NumaAlloc(size_t size, uint32_t node) {
+#if defined(HANDLE_NUMA_LINUX)
+	// anonymous maps are zero'ed and have no pages until touched, so binding
+	// before first touch places every page on the preferred node
+	void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ptr == MAP_FAILED) {
+		return NULL;
+	}
+#if defined(SYS_mbind)
+	if (Handle_NumaNodeCount() > 1) {
+		unsigned long nodeMask = 1ul << node;
+		// the kernel only reads maxnode - 1 bits, so +1 to include the last node
+		if (syscall(SYS_mbind, ptr, size, HANDLE_NUMA_MPOL_PREFERRED, &nodeMask, Handle_NumaMaxNodes + 1, 0) != 0) {
+			// still usable, just wherever the kernel decides
+			LOGWARNING("mbind to NUMA node %u failed", node);
+		}
+	}
+#endif
+	return ptr;
+#else
+	(void) node;
+	return MEMORY_CALLOC(1, size);
+#endif
+}
+
+AL2O3_EXTERN_C void Handle_NumaFree(void *ptr, size_t size) {
+	if (!ptr) {
+		return;
+	}
+#if defined(HANDLE_NUMA_LINUX)
+	munmap(ptr, size);
+#else
+	(void) size;
+	MEMORY_FREE(ptr);
+#endif
+}
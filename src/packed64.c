@@ -0,0 +1,254 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_handle/packed64.h"
+#include "internal.h"
+
+// index + 1 tagged with the low bits of the generation, never 0
+AL2O3_FORCE_INLINE uint32_t PackedLink64(Handle_GenerationType64 gen, uint64_t actualIndex) {
+	return (uint32_t) ((gen << Handle_PackedLinkIndexBits64) | (actualIndex + 1));
+}
+
+// return true to retry the allocation, false means no hope
+static bool AllocNewBlockPacked64(Handle_PackedManager64 *manager) {
+	if (Thread_AtomicLoad64Relaxed(&manager->totalHandlesAllocated) >= Handle_MaxPackedHandles64) {
+		LOGWARNING("Allocated all handles already!");
+		return false;
+	}
+	// first thing we need to do is claim our new index range
+	uint64_t baseIndex =
+			Thread_AtomicFetchAdd64Relaxed(&manager->totalHandlesAllocated, (manager->handlesPerBlockMask + 1));
+
+	if (baseIndex >= (manager->handlesPerBlockMask + 1) * manager->maxBlocks ||
+			baseIndex + manager->handlesPerBlockMask >= Handle_MaxPackedHandles64) {
+		LOGWARNING("Trying to allocate more than %i blocks! Increase block size or max blocks", (int) manager->maxBlocks);
+		Thread_AtomicFetchAdd64Relaxed(&manager->totalHandlesAllocated, -(int64_t) (manager->handlesPerBlockMask + 1));
+		return false;
+	}
+
+	size_t const blockSize = ((manager->handlesPerBlockMask + 1) * manager->elementSize) +
+			((manager->handlesPerBlockMask + 1) * Handle_GenerationSize64);
+
+	uint8_t *base = (uint8_t *) MEMORY_CALLOC(1, blockSize);
+	if (!base) {
+		LOGWARNING("Out of memory!");
+		return false;
+	}
+
+	Thread_AtomicStorePtrRelaxed(manager->blocks + (baseIndex >> manager->handlesPerBlockShift), base);
+
+	// init free list for new block, the generations are all 0 so far
+	for (uint32_t i = 0u; i < (manager->handlesPerBlockMask + 1); ++i) {
+		uint32_t *addr = (uint32_t *) (base + (i * manager->elementSize));
+		*addr = PackedLink64(0, baseIndex + i + 1);
+	}
+
+	// link the new block into the free list and attach existing free list to the
+	// end of this block
+	Redo:;
+	uint64_t const heads = Thread_AtomicLoad64Relaxed(&manager->freeListHeads);
+	uint32_t const headsFreePart = (uint32_t) (heads & 0xFFFFFFFFull);
+	uint64_t const headsDeferFreePart = heads & ~0xFFFFFFFFull;
+
+	// we chain to the next entry in the free list without disturbing the deferred list
+	uint64_t const newHeads = headsDeferFreePart | PackedLink64(0, baseIndex);
+	// point last new handle to existing free list (it might not be empty by now)
+	*((uint32_t *) (base + (manager->handlesPerBlockMask * manager->elementSize))) = headsFreePart;
+
+	if (Thread_AtomicCompareExchange64Relaxed(&manager->freeListHeads, heads, newHeads) != heads) {
+		goto Redo; // something changed reverse the transaction
+	}
+
+	return true;
+}
+
+AL2O3_EXTERN_C Handle_PackedManager64 *Handle_PackedManager64Create(uint32_t elementSize,
+																																		uint32_t handlesPerBlock,
+																																		uint32_t maxBlocks,
+																																		bool neverReissueOldHandles) {
+	ASSERT(elementSize >= sizeof(uint64_t));
+	ASSERT(handlesPerBlock <= Handle_MaxPackedHandles64);
+
+	if (!IsPow2(handlesPerBlock)) {
+		LOGWARNING("handlesPerBlock (%u) should be a power of 2, using %u", handlesPerBlock, NextPow2(handlesPerBlock));
+		handlesPerBlock = NextPow2(handlesPerBlock);
+	}
+
+	// each block has space for the data and the generation
+	size_t const blockSize = (handlesPerBlock * elementSize) +
+			(handlesPerBlock * Handle_GenerationSize64);
+
+	// first block is attached directly to the header
+	size_t const allocSize = sizeof(Handle_PackedManager64)
+			+ blockSize +
+			8 + // padding to ensure atomics are at least 8 byte aligned
+			(maxBlocks * sizeof(Thread_AtomicPtr_t));
+
+	Handle_PackedManager64 *manager = (Handle_PackedManager64 *) MEMORY_CALLOC(1, allocSize);
+	if (!manager) {
+		return NULL;
+	}
+	manager->elementSize = elementSize;
+	manager->handlesPerBlockMask = handlesPerBlock - 1;
+	manager->handlesPerBlockShift = SlowLog2(handlesPerBlock);
+	manager->neverReissueOldHandles = neverReissueOldHandles;
+	manager->maxBlocks = maxBlocks;
+
+	uint8_t *base = (uint8_t *) (manager + 1);
+	// get to blocks space with 8 byte alignment guarenteed
+	manager->blocks = (Thread_AtomicPtr_t *) (((uintptr_t) base + blockSize + 0x8ull) & ~0x7ull);
+	Thread_AtomicStorePtrRelaxed(manager->blocks + 0, base);
+	Thread_AtomicStore64Relaxed(&manager->totalHandlesAllocated, handlesPerBlock);
+
+	// init free list for new block, the generations are all 0 so far
+	for (uint32_t i = 0u; i < handlesPerBlock; ++i) {
+		*((uint32_t *) (base + (i * manager->elementSize))) = PackedLink64(0, i + 1);
+	}
+
+	// index zero is born generation 1
+	*(Handle_GenerationType64 *) ((base + (handlesPerBlock * manager->elementSize))) = 1;
+
+	// fix last index to point to the empty marker
+	*((uint32_t *) (base + ((handlesPerBlock - 1) * manager->elementSize))) = 0;
+
+	// repoint heads to start of the free list (index 0, generation 1) with an empty deferred list
+	Thread_AtomicStore64Relaxed(&manager->freeListHeads, PackedLink64(1, 0));
+
+	return manager;
+}
+
+AL2O3_EXTERN_C void Handle_PackedManager64Destroy(Handle_PackedManager64 *manager) {
+	if (!manager) {
+		return;
+	}
+
+	// 0th block is embedded
+	for (uint64_t i = 1u; i < manager->maxBlocks; ++i) {
+		void *ptr = Thread_AtomicLoadPtrRelaxed(&manager->blocks[i]);
+		if (ptr) {
+			MEMORY_FREE(ptr);
+		}
+	}
+
+	MEMORY_FREE(manager);
+}
+
+AL2O3_EXTERN_C Handle_Handle64 Handle_PackedManager64Alloc(Handle_PackedManager64 *manager) {
+	uint32_t noFreeCount = 0;
+	Redo:;
+	// heads has 2 linked list packed in a 64 bit location. Its our transaction backout test as well
+	uint64_t const heads = Thread_AtomicLoad64Relaxed(&manager->freeListHeads);
+	uint32_t const headsFreePart = (uint32_t) (heads & 0xFFFFFFFFull);
+	uint64_t const headsDeferFreePart = heads & ~0xFFFFFFFFull;
+
+	// check to see if the free list is empty
+	if (headsFreePart == 0) {
+		// we need to swap the deferred into the free list as free list is empty
+		if (headsDeferFreePart == 0) {
+			// the deferred list is empty, so we have no free handles
+			bool retry = AllocNewBlockPacked64(manager);
+			if (retry == false || noFreeCount >= 1000) {
+				LOGWARNING("Manager has run out of handles");
+				Handle_Handle64 invalid = {0}; // fail
+				return invalid;
+			}
+			// try again but mark we've tried, allow a few attempts then give up
+			noFreeCount++;
+			goto Redo;
+		} else {
+			// we move the defer list into the free list position and mark the deferred as empty
+			// we don't even have to loop here as a transaction reverse is the same thing
+			Thread_AtomicCompareExchange64Relaxed(&manager->freeListHeads, heads, headsDeferFreePart >> 32ull);
+			goto Redo; // retry now
+		}
+	}
+	// we chain to the next entry in the free list without disturbing the deferred list
+	uint64_t const actualIndex = (headsFreePart & Handle_PackedLinkIndexMask64) - 1;
+	// fetch the base memory block for this index
+	uint64_t const baseIndex = actualIndex >> manager->handlesPerBlockShift;
+	ASSERT(baseIndex < manager->maxBlocks);
+	uint8_t *const base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[baseIndex]);
+	ASSERT(base != NULL);
+	uint64_t index = actualIndex & manager->handlesPerBlockMask;
+	uint32_t *const item = (uint32_t *) (base + (index * manager->elementSize));
+
+	uint64_t const newHeads = headsDeferFreePart | *item;
+
+	if (Thread_AtomicCompareExchange64Relaxed(&manager->freeListHeads, heads, newHeads) != heads) {
+		goto Redo; // something changed reverse the transaction
+	}
+
+	// the item is now ours to abuse
+	// clear it out ready for its new life
+	memset(item, 0x0, manager->elementSize);
+
+	// now make the handle and return it
+	// point to generation data for this index
+	Handle_GenerationType64 *gen = (Handle_GenerationType64 *) (base +
+			((manager->handlesPerBlockMask + 1) * manager->elementSize) +
+			(index * Handle_GenerationSize64));
+	*gen = *gen | Handle_GenerationFlagsAlloced64; // add in the alloced flag
+
+	Handle_Handle64 handle = HANDLE_MANAGER64_MAKEHANDLE(gen, actualIndex);
+	return handle;
+}
+
+AL2O3_EXTERN_C void Handle_PackedManager64Release(Handle_PackedManager64 *manager, Handle_Handle64 handle) {
+	ASSERT((handle.handle & Handle_MaxHandles64) < Thread_AtomicLoad64Relaxed(&manager->totalHandlesAllocated));
+	ASSERT(Handle_PackedManager64IsValid(manager, handle));
+
+	uint64_t const actualIndex = handle.handle & Handle_MaxHandles64; // clean out the current generation
+	uint64_t const blockIndex = actualIndex >> manager->handlesPerBlockShift;
+	uint64_t const index = actualIndex & manager->handlesPerBlockMask;
+	ASSERT(blockIndex < manager->maxBlocks);
+
+	// fetch the base memory block for this index
+	uint8_t *base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex]);
+	// point to generation data for this index
+	Handle_GenerationType64 *gen = (Handle_GenerationType64 *) (base +
+			((manager->handlesPerBlockMask + 1) * manager->elementSize) +
+			(index * Handle_GenerationSize64));
+
+	uint32_t *item = (uint32_t *) (base + (index * manager->elementSize));
+
+	// update the generation of this index
+	uint32_t flags = *gen & 0xFF000000u;
+	uint32_t gene = *gen & 0x00FFFFFFu;
+
+	gene = gene + 1;
+	gene = gene & 0x00FFFFFFu;
+	if (gene == 0 && manager->neverReissueOldHandles) {
+		// after generation wrap around simply lose the handle
+		// never putting it back in the free list means it never gets reused
+		// tho will get freed when the manager is
+
+		// mark and poison the data
+		*gen = Handle_GenerationFlagsLeaked64;
+		memset(item, 0xDC, manager->elementSize);
+		return;
+	}
+
+	// handle 0 special case
+	if (gene == 0 && actualIndex == 0) {
+		gene = 1;
+	}
+	flags = flags ^ Handle_GenerationFlagsAlloced64; // kill the alloced flag
+	*gen = flags | gene;
+
+	// tagged with the new generation
+	uint64_t const indexInUpper = ((uint64_t) PackedLink64(gene, actualIndex)) << 32ull;
+
+	RedoF:;
+	// add it to the deferred list without changing the free list
+	// repeat until we get a transaction okay response from CAS
+	uint64_t const heads = Thread_AtomicLoad64Relaxed(&manager->freeListHeads);
+	uint64_t const headsFreePart = heads & 0xFFFFFFFFull;
+	uint32_t const headsDeferFreePart = (uint32_t) ((heads & ~0xFFFFFFFFull) >> 32ull);
+
+	*item = headsDeferFreePart;
+	uint64_t const newHeads = indexInUpper | headsFreePart;
+	if (Thread_AtomicCompareExchange64Relaxed(&manager->freeListHeads, heads, newHeads) != heads) {
+		goto RedoF; // transaction fail redo inserting this index into deferred free list
+	}
+}
@@ -0,0 +1,298 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_handle/ringqueue.h"
+#include "internal.h"
+
+#define MAKECELL32(turn, handle) ((((uint64_t) (uint32_t) (turn)) << 32u) | (uint64_t) (handle))
+
+AL2O3_EXTERN_C Handle_RingQueue32 *Handle_RingQueue32Create(uint32_t capacity) {
+	if (capacity < 2) {
+		capacity = 2;
+	}
+	if (!IsPow2(capacity)) {
+		LOGWARNING("capacity (%u) should be a power of 2, using %u", capacity, NextPow2(capacity));
+		capacity = NextPow2(capacity);
+	}
+	// cells follow the header
+	size_t const allocSize = sizeof(Handle_RingQueue32) + (capacity * sizeof(Thread_Atomic64_t));
+	Handle_RingQueue32 *queue = (Handle_RingQueue32 *) MEMORY_CALLOC(1, allocSize);
+	if (!queue) {
+		return NULL;
+	}
+	queue->capacityMask = capacity - 1;
+	queue->cells = (Thread_Atomic64_t *) (queue + 1);
+
+	// each cell is ready for the producer at its position
+	for (uint32_t i = 0u; i < capacity; ++i) {
+		Thread_AtomicStore64Relaxed(queue->cells + i, MAKECELL32(i, 0));
+	}
+	Thread_AtomicStore64Relaxed(&queue->head, 0);
+	Thread_AtomicStore64Relaxed(&queue->tail, 0);
+	return queue;
+}
+
+AL2O3_EXTERN_C void Handle_RingQueue32Destroy(Handle_RingQueue32 *queue) {
+	if (!queue) {
+		return;
+	}
+	MEMORY_FREE(queue);
+}
+
+AL2O3_EXTERN_C bool Handle_RingQueue32Push(Handle_RingQueue32 *queue, Handle_Handle32 handle) {
+	ASSERT(handle.handle != 0);
+	Redo:;
+	uint64_t const pos = Thread_AtomicLoad64Relaxed(&queue->tail);
+	Thread_Atomic64_t *const cell = queue->cells + (pos & queue->capacityMask);
+	uint64_t const value = Thread_AtomicLoad64Relaxed(cell);
+	int32_t const diff = (int32_t) ((uint32_t) (value >> 32u) - (uint32_t) pos);
+
+	if (diff == 0) {
+		if (Thread_AtomicCompareExchange64Relaxed(&queue->tail, pos, pos + 1) != pos) {
+			goto Redo; // another producer got this position
+		}
+		// anything written to the element must be visible before the handle
+		Thread_AtomicThreadFenceRelease();
+		Thread_AtomicStore64Relaxed(cell, MAKECELL32(pos + 1, handle.handle));
+		return true;
+	} else if (diff < 0) {
+		// a lap behind, the consumer hasn't emptied it yet
+		return false;
+	}
+	goto Redo; // tail has moved on
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_RingQueue32Pop(Handle_RingQueue32 *queue) {
+	Redo:;
+	uint64_t const pos = Thread_AtomicLoad64Relaxed(&queue->head);
+	Thread_Atomic64_t *const cell = queue->cells + (pos & queue->capacityMask);
+	uint64_t const value = Thread_AtomicLoad64Relaxed(cell);
+	int32_t const diff = (int32_t) ((uint32_t) (value >> 32u) - (uint32_t) (pos + 1));
+
+	if (diff == 0) {
+		if (Thread_AtomicCompareExchange64Relaxed(&queue->head, pos, pos + 1) != pos) {
+			goto Redo; // another consumer got this position
+		}
+		Thread_AtomicThreadFenceAcquire();
+		// ready for the producer one lap on
+		Thread_AtomicStore64Relaxed(cell, MAKECELL32(pos + queue->capacityMask + 1, 0));
+		Handle_Handle32 handle = {(uint32_t) value};
+		return handle;
+	} else if (diff < 0) {
+		// producer hasn't filled it yet
+		Handle_Handle32 invalid = {0};
+		return invalid;
+	}
+	goto Redo; // head has moved on
+}
+
+AL2O3_EXTERN_C uint32_t Handle_RingQueue32PushBatch(Handle_RingQueue32 *queue,
+																										Handle_Handle32 const *handles,
+																										uint32_t count) {
+	Redo:;
+	uint64_t const pos = Thread_AtomicLoad64Relaxed(&queue->tail);
+	// only claim the run of cells already ready for this lap, so we never wait
+	// on a consumer still emptying one
+	uint32_t n = 0u;
+	while (n < count) {
+		uint64_t const value = Thread_AtomicLoad64Relaxed(queue->cells + ((pos + n) & queue->capacityMask));
+		if ((uint32_t) (value >> 32u) != (uint32_t) (pos + n)) {
+			break;
+		}
+		n++;
+	}
+	if (n == 0) {
+		uint64_t const value = Thread_AtomicLoad64Relaxed(queue->cells + (pos & queue->capacityMask));
+		if ((int32_t) ((uint32_t) (value >> 32u) - (uint32_t) pos) < 0) {
+			return 0; // full
+		}
+		goto Redo; // tail has moved on
+	}
+	if (Thread_AtomicCompareExchange64Relaxed(&queue->tail, pos, pos + n) != pos) {
+		goto Redo; // another producer got some of these positions
+	}
+	// anything written to the elements must be visible before the handles
+	Thread_AtomicThreadFenceRelease();
+
+	for (uint32_t i = 0u; i < n; ++i) {
+		ASSERT(handles[i].handle != 0);
+		Thread_Atomic64_t *const cell = queue->cells + ((pos + i) & queue->capacityMask);
+		Thread_AtomicStore64Relaxed(cell, MAKECELL32(pos + i + 1, handles[i].handle));
+	}
+	return n;
+}
+
+AL2O3_EXTERN_C uint32_t Handle_RingQueue32PopBatch(Handle_RingQueue32 *queue, Handle_Handle32 *handles, uint32_t count) {
+	Redo:;
+	uint64_t const pos = Thread_AtomicLoad64Relaxed(&queue->head);
+	// only claim the run of cells already filled, the handle is read with the
+	// turn so it's ours once the CAS succeeds
+	uint32_t n = 0u;
+	while (n < count) {
+		uint64_t const value = Thread_AtomicLoad64Relaxed(queue->cells + ((pos + n) & queue->capacityMask));
+		if ((uint32_t) (value >> 32u) != (uint32_t) (pos + n + 1)) {
+			break;
+		}
+		handles[n].handle = (uint32_t) value;
+		n++;
+	}
+	if (n == 0) {
+		uint64_t const value = Thread_AtomicLoad64Relaxed(queue->cells + (pos & queue->capacityMask));
+		if ((int32_t) ((uint32_t) (value >> 32u) - (uint32_t) (pos + 1)) < 0) {
+			return 0; // empty
+		}
+		goto Redo; // head has moved on
+	}
+	if (Thread_AtomicCompareExchange64Relaxed(&queue->head, pos, pos + n) != pos) {
+		goto Redo; // another consumer got some of these positions
+	}
+	Thread_AtomicThreadFenceAcquire();
+
+	for (uint32_t i = 0u; i < n; ++i) {
+		// ready for the producer one lap on
+		Thread_Atomic64_t *const cell = queue->cells + ((pos + i) & queue->capacityMask);
+		Thread_AtomicStore64Relaxed(cell, MAKECELL32(pos + i + queue->capacityMask + 1, 0));
+	}
+	return n;
+}
+
+AL2O3_EXTERN_C Handle_RingQueue64 *Handle_RingQueue64Create(uint64_t capacity) {
+	if (capacity < 2) {
+		capacity = 2;
+	}
+	if (!IsPow2_64(capacity)) {
+		LOGWARNING("capacity (%llu) should be a power of 2, using %llu",
+							 (unsigned long long) capacity,
+							 (unsigned long long) NextPow2_64(capacity));
+		capacity = NextPow2_64(capacity);
+	}
+	size_t const allocSize = sizeof(Handle_RingQueue64) + (capacity * sizeof(Handle_RingQueueCell64));
+	Handle_RingQueue64 *queue = (Handle_RingQueue64 *) MEMORY_CALLOC(1, allocSize);
+	if (!queue) {
+		return NULL;
+	}
+	queue->capacityMask = capacity - 1;
+	queue->cells = (Handle_RingQueueCell64 *) (queue + 1);
+
+	for (uint64_t i = 0u; i < capacity; ++i) {
+		Thread_AtomicStore64Relaxed(&queue->cells[i].turn, i);
+	}
+	Thread_AtomicStore64Relaxed(&queue->head, 0);
+	Thread_AtomicStore64Relaxed(&queue->tail, 0);
+	return queue;
+}
+
+AL2O3_EXTERN_C void Handle_RingQueue64Destroy(Handle_RingQueue64 *queue) {
+	if (!queue) {
+		return;
+	}
+	MEMORY_FREE(queue);
+}
+
+AL2O3_EXTERN_C bool Handle_RingQueue64Push(Handle_RingQueue64 *queue, Handle_Handle64 handle) {
+	ASSERT(handle.handle != 0);
+	Redo:;
+	uint64_t const pos = Thread_AtomicLoad64Relaxed(&queue->tail);
+	Handle_RingQueueCell64 *const cell = queue->cells + (pos & queue->capacityMask);
+	int64_t const diff = (int64_t) (Thread_AtomicLoad64Relaxed(&cell->turn) - pos);
+
+	if (diff == 0) {
+		if (Thread_AtomicCompareExchange64Relaxed(&queue->tail, pos, pos + 1) != pos) {
+			goto Redo;
+		}
+		cell->handle = handle.handle;
+		// the handle (and element) must be visible before the turn
+		Thread_AtomicThreadFenceRelease();
+		Thread_AtomicStore64Relaxed(&cell->turn, pos + 1);
+		return true;
+	} else if (diff < 0) {
+		return false;
+	}
+	goto Redo;
+}
+
+AL2O3_EXTERN_C Handle_Handle64 Handle_RingQueue64Pop(Handle_RingQueue64 *queue) {
+	Redo:;
+	uint64_t const pos = Thread_AtomicLoad64Relaxed(&queue->head);
+	Handle_RingQueueCell64 *const cell = queue->cells + (pos & queue->capacityMask);
+	int64_t const diff = (int64_t) (Thread_AtomicLoad64Relaxed(&cell->turn) - (pos + 1));
+
+	if (diff == 0) {
+		if (Thread_AtomicCompareExchange64Relaxed(&queue->head, pos, pos + 1) != pos) {
+			goto Redo;
+		}
+		Thread_AtomicThreadFenceAcquire();
+		Handle_Handle64 handle = {cell->handle};
+		// the handle read must be done before the producer can reuse the cell
+		Thread_AtomicThreadFenceRelease();
+		Thread_AtomicStore64Relaxed(&cell->turn, pos + queue->capacityMask + 1);
+		return handle;
+	} else if (diff < 0) {
+		Handle_Handle64 invalid = {0};
+		return invalid;
+	}
+	goto Redo;
+}
+
+AL2O3_EXTERN_C uint64_t Handle_RingQueue64PushBatch(Handle_RingQueue64 *queue,
+																										Handle_Handle64 const *handles,
+																										uint64_t count) {
+	Redo:;
+	uint64_t const pos = Thread_AtomicLoad64Relaxed(&queue->tail);
+	// only claim cells already ready for this lap, as the 32 bit batch
+	uint64_t n = 0u;
+	while (n < count && Thread_AtomicLoad64Relaxed(&queue->cells[(pos + n) & queue->capacityMask].turn) == pos + n) {
+		n++;
+	}
+	if (n == 0) {
+		if ((int64_t) (Thread_AtomicLoad64Relaxed(&queue->cells[pos & queue->capacityMask].turn) - pos) < 0) {
+			return 0;
+		}
+		goto Redo;
+	}
+	if (Thread_AtomicCompareExchange64Relaxed(&queue->tail, pos, pos + n) != pos) {
+		goto Redo;
+	}
+	Thread_AtomicThreadFenceAcquire();
+
+	for (uint64_t i = 0u; i < n; ++i) {
+		ASSERT(handles[i].handle != 0);
+		queue->cells[(pos + i) & queue->capacityMask].handle = handles[i].handle;
+	}
+	// the handles (and elements) must be visible before the turns
+	Thread_AtomicThreadFenceRelease();
+	for (uint64_t i = 0u; i < n; ++i) {
+		Thread_AtomicStore64Relaxed(&queue->cells[(pos + i) & queue->capacityMask].turn, pos + i + 1);
+	}
+	return n;
+}
+
+AL2O3_EXTERN_C uint64_t Handle_RingQueue64PopBatch(Handle_RingQueue64 *queue, Handle_Handle64 *handles, uint64_t count) {
+	Redo:;
+	uint64_t const pos = Thread_AtomicLoad64Relaxed(&queue->head);
+	uint64_t n = 0u;
+	while (n < count && Thread_AtomicLoad64Relaxed(&queue->cells[(pos + n) & queue->capacityMask].turn) == pos + n + 1) {
+		n++;
+	}
+	if (n == 0) {
+		if ((int64_t) (Thread_AtomicLoad64Relaxed(&queue->cells[pos & queue->capacityMask].turn) - (pos + 1)) < 0) {
+			return 0;
+		}
+		goto Redo;
+	}
+	if (Thread_AtomicCompareExchange64Relaxed(&queue->head, pos, pos + n) != pos) {
+		goto Redo;
+	}
+	Thread_AtomicThreadFenceAcquire();
+
+	for (uint64_t i = 0u; i < n; ++i) {
+		handles[i].handle = queue->cells[(pos + i) & queue->capacityMask].handle;
+	}
+	// the handle reads must be done before the producers can reuse the cells
+	Thread_AtomicThreadFenceRelease();
+	for (uint64_t i = 0u; i < n; ++i) {
+		Thread_AtomicStore64Relaxed(&queue->cells[(pos + i) & queue->capacityMask].turn, pos + i + queue->capacityMask + 1);
+	}
+	return n;
+}
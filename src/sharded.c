@@ -0,0 +1,241 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_thread/thread.h"
+#include "al2o3_handle/sharded.h"
+#include "internal.h"
+
+AL2O3_FORCE_INLINE Handle_ShardedHeads32 *ThreadShard(Handle_ShardedManager32 *manager) {
+	if (manager->shardShift == 0) {
+		return manager->shards;
+	}
+	// thread ids are often pointers, so fibonacci hash to spread them over the shards
+	uint64_t const id = (uint64_t) Thread_GetCurrentThreadID();
+	return manager->shards + ((id * 0x9E3779B97F4A7C15ull) >> (64u - manager->shardShift));
+}
+
+AL2O3_FORCE_INLINE uint32_t *IndexToItem(Handle_ShardedManager32 *manager, uint32_t actualIndex) {
+	uint32_t const blockIndex = actualIndex >> manager->handlesPerBlockShift;
+	ASSERT(blockIndex < manager->maxBlocks);
+	uint8_t *const base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex]);
+	ASSERT(base != NULL);
+	return (uint32_t *) (base + ((actualIndex & manager->handlesPerBlockMask) * manager->elementSize));
+}
+
+// free list links are the index tagged with its current generation, so a pop
+// whose slot was taken and released again in between fails its CAS (ABA)
+AL2O3_FORCE_INLINE uint32_t IndexToLink(Handle_ShardedManager32 *manager, uint32_t actualIndex) {
+	uint8_t const *const base = (uint8_t const *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[actualIndex >> manager->handlesPerBlockShift]);
+	return FreeLink32(base[((manager->handlesPerBlockMask + 1) * manager->elementSize) + (actualIndex & manager->handlesPerBlockMask)],
+										actualIndex);
+}
+
+static uint32_t *FreeListItem(void *context, uint32_t actualIndex) {
+	return IndexToItem((Handle_ShardedManager32 *) context, actualIndex);
+}
+
+// links count items starting at firstIndex into a chain and gives them to a shard
+static void GiveRange(Handle_ShardedManager32 *manager,
+											Handle_ShardedHeads32 *shard,
+											uint32_t firstIndex,
+											uint32_t count) {
+	ASSERT(count > 0);
+	for (uint32_t i = 0u; i < count - 1; ++i) {
+		uint32_t const index = firstIndex + i;
+		// point to next entry
+		*IndexToItem(manager, index) = IndexToLink(manager, index + 1);
+	}
+	Handle_FreeListPushFree32(&shard->freeListHeads,
+														IndexToLink(manager, firstIndex),
+														IndexToItem(manager, firstIndex + count - 1));
+}
+
+// pops a free index from a shard, false if both its lists are empty
+static bool PopShard(Handle_ShardedManager32 *manager, Handle_ShardedHeads32 *shard, uint32_t *outIndex) {
+	return Handle_FreeListPop32(&shard->freeListHeads, &FreeListItem, manager, outIndex);
+}
+
+// return true to retry the allocation, false means no hope
+static bool AllocNewBlock(Handle_ShardedManager32 *manager, Handle_ShardedHeads32 *shard) {
+	if (Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) >= Handle_MaxHandles32) {
+		LOGWARNING("Allocated all 16.7 million handles already!");
+		return false;
+	}
+	uint32_t const handlesPerBlock = manager->handlesPerBlockMask + 1;
+	// first thing we need to do is claim our new index range
+	uint32_t baseIndex = Thread_AtomicFetchAdd32Relaxed(&manager->totalHandlesAllocated, handlesPerBlock);
+
+	if (baseIndex >= handlesPerBlock * manager->maxBlocks) {
+		LOGWARNING("Trying to allocate more than %i blocks! Increase block size or max blocks", manager->maxBlocks);
+		Thread_AtomicFetchAdd32Relaxed(&manager->totalHandlesAllocated, -(int32_t) handlesPerBlock);
+		return false;
+	}
+
+	size_t const blockSize = (handlesPerBlock * manager->elementSize) + (handlesPerBlock * sizeof(uint8_t));
+	uint8_t *base = (uint8_t *) MEMORY_CALLOC(1, blockSize);
+	if (!base) {
+		LOGWARNING("Out of memory!");
+		return false;
+	}
+	Thread_AtomicStorePtrRelaxed(manager->blocks + (baseIndex >> manager->handlesPerBlockShift), base);
+
+	// the shard that ran dry gets the whole block
+	GiveRange(manager, shard, baseIndex, handlesPerBlock);
+	return true;
+}
+
+AL2O3_EXTERN_C Handle_ShardedManager32 *Handle_ShardedManager32Create(uint32_t elementSize,
+																																			uint32_t handlesPerBlock,
+																																			uint32_t maxBlocks,
+																																			uint32_t shardCount,
+																																			bool neverReissueOldHandles) {
+	ASSERT(elementSize >= sizeof(uint32_t));
+	ASSERT(handlesPerBlock <= Handle_MaxHandles32);
+
+	if (!IsPow2(handlesPerBlock)) {
+		LOGWARNING("handlesPerBlock (%u) should be a power of 2, using %u", handlesPerBlock, NextPow2(handlesPerBlock));
+		handlesPerBlock = NextPow2(handlesPerBlock);
+	}
+	if (shardCount == 0) {
+		shardCount = Thread_CPUCoreCount();
+	}
+	shardCount = NextPow2(shardCount);
+	if (shardCount > Handle_ShardedMaxShards) {
+		shardCount = Handle_ShardedMaxShards;
+	}
+
+	size_t const allocSize = sizeof(Handle_ShardedManager32) +
+			Handle_ShardedCacheLineSize + // padding to cache line align the shards
+			(shardCount * sizeof(Handle_ShardedHeads32)) +
+			(maxBlocks * sizeof(Thread_AtomicPtr_t));
+
+	Handle_ShardedManager32 *manager = (Handle_ShardedManager32 *) MEMORY_CALLOC(1, allocSize);
+	if (!manager) {
+		return NULL;
+	}
+	manager->elementSize = elementSize;
+	manager->handlesPerBlockMask = handlesPerBlock - 1;
+	manager->handlesPerBlockShift = SlowLog2(handlesPerBlock);
+	manager->neverReissueOldHandles = neverReissueOldHandles;
+	manager->maxBlocks = maxBlocks;
+	manager->shardCount = shardCount;
+	manager->shardShift = SlowLog2(shardCount);
+
+	uintptr_t const afterHeader = (uintptr_t) (manager + 1);
+	manager->shards = (Handle_ShardedHeads32 *) ((afterHeader + Handle_ShardedCacheLineSize - 1) &
+			~(uintptr_t) (Handle_ShardedCacheLineSize - 1));
+	manager->blocks = (Thread_AtomicPtr_t *) (manager->shards + shardCount);
+
+	size_t const blockSize = (handlesPerBlock * elementSize) + (handlesPerBlock * sizeof(uint8_t));
+	uint8_t *base = (uint8_t *) MEMORY_CALLOC(1, blockSize);
+	if (!base) {
+		MEMORY_FREE(manager);
+		return NULL;
+	}
+	Thread_AtomicStorePtrRelaxed(manager->blocks + 0, base);
+	Thread_AtomicStore32Relaxed(&manager->totalHandlesAllocated, handlesPerBlock);
+
+	// index zero is born generation 1
+	*(base + (handlesPerBlock * manager->elementSize)) = 1;
+
+	// share the first block across every shard so no one has to steal at the start
+	uint32_t const perShard = (handlesPerBlock >= shardCount) ? handlesPerBlock / shardCount : 1;
+	uint32_t index = 0;
+	for (uint32_t i = 0u; i < shardCount && index < handlesPerBlock; ++i) {
+		uint32_t const count = (i == shardCount - 1) ? handlesPerBlock - index : perShard;
+		GiveRange(manager, manager->shards + i, index, count);
+		index += count;
+	}
+
+	return manager;
+}
+
+AL2O3_EXTERN_C void Handle_ShardedManager32Destroy(Handle_ShardedManager32 *manager) {
+	if (!manager) {
+		return;
+	}
+
+	for (uint32_t i = 0u; i < manager->maxBlocks; ++i) {
+		void *ptr = Thread_AtomicLoadPtrRelaxed(&manager->blocks[i]);
+		if (ptr) {
+			MEMORY_FREE(ptr);
+		}
+	}
+
+	MEMORY_FREE(manager);
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_ShardedManager32Alloc(Handle_ShardedManager32 *manager) {
+	Handle_ShardedHeads32 *const shard = ThreadShard(manager);
+	uint32_t const shardIndex = (uint32_t) (shard - manager->shards);
+	uint32_t noFreeCount = 0;
+
+	uint32_t actualIndex;
+	Redo:;
+	if (!PopShard(manager, shard, &actualIndex)) {
+		// try and steal from the other shards before growing
+		bool stolen = false;
+		for (uint32_t i = 1u; i < manager->shardCount && !stolen; ++i) {
+			stolen = PopShard(manager, manager->shards + ((shardIndex + i) & (manager->shardCount - 1)), &actualIndex);
+		}
+		if (!stolen) {
+			bool retry = AllocNewBlock(manager, shard);
+			if (retry == false || noFreeCount >= 1000) {
+				LOGWARNING("Manager has run out of handles");
+				Handle_Handle32 invalid = {0}; // fail
+				return invalid;
+			}
+			// try again but mark we've tried, allow a few attempts then give up
+			noFreeCount++;
+			goto Redo;
+		}
+	}
+
+	// the item is now ours to abuse
+	// clear it out ready for its new life
+	uint32_t *const item = IndexToItem(manager, actualIndex);
+	memset(item, 0x0, manager->elementSize);
+
+	// now make the handle and return it
+	uint8_t *const base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[actualIndex >> manager->handlesPerBlockShift]);
+	uint8_t *gen = base + ((manager->handlesPerBlockMask + 1) * manager->elementSize) + (actualIndex & manager->handlesPerBlockMask);
+	Handle_Handle32 handle = {
+		.handle = ((uint32_t) *gen) << Handle_GenerationBitShift32 | actualIndex
+	};
+	return handle;
+}
+
+AL2O3_EXTERN_C void Handle_ShardedManager32Release(Handle_ShardedManager32 *manager, Handle_Handle32 handle) {
+	ASSERT((handle.handle & Handle_MaxHandles32) < Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated));
+	ASSERT(Handle_ShardedManager32IsValid(manager, handle));
+
+	uint32_t const actualIndex = handle.handle & Handle_MaxHandles32; // clean out the current generation
+	uint32_t const blockIndex = actualIndex >> manager->handlesPerBlockShift;
+	uint32_t const index = actualIndex & manager->handlesPerBlockMask;
+
+	// fetch the base memory block for this index
+	uint8_t *base = (uint8_t *) Thread_AtomicLoadPtrRelaxed(&manager->blocks[blockIndex]);
+	// point to generation data for this index
+	uint8_t *gen = base + ((manager->handlesPerBlockMask + 1) * manager->elementSize) + index;
+	uint32_t *item = (uint32_t *) (base + (index * manager->elementSize));
+
+	// update the generation of this index
+	// intentional 8 bit integer overflow
+	*gen = *gen + 1;
+	if (*gen == 0 && manager->neverReissueOldHandles) {
+		// after generation wrap around simply lose the handle
+		// poison the data
+		memset(item, 0xDC, manager->elementSize);
+		return;
+	}
+	// handle 0 special case
+	if (*gen == 0 && actualIndex == 0) {
+		*gen = 1;
+	}
+
+	// released items go to the releasing threads shard, which is usually the allocating one
+	Handle_ShardedHeads32 *const shard = ThreadShard(manager);
+	// tagged with the new generation
+	Handle_FreeListPushDeferred32(&shard->freeListHeads, FreeLink32(*gen, actualIndex), item);
+}
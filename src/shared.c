@@ -0,0 +1,290 @@
+// License Summary: MIT see LICENSE file
+// syscall needs this and must be defined before any system header
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_handle/shared.h"
+#include "internal.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define HANDLE_SHARED_POSIX 1
+#endif
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#if defined(HANDLE_SHARED_POSIX)
+static Handle_SharedManager32 *MapSegment(int fd, size_t size) {
+	void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED) {
+		LOGWARNING("Unable to map shared handle manager segment");
+		return NULL;
+	}
+	Handle_SharedManager32 *manager = (Handle_SharedManager32 *) MEMORY_CALLOC(1, sizeof(Handle_SharedManager32));
+	if (!manager) {
+		munmap(mapping, size);
+		return NULL;
+	}
+	manager->header = (Handle_SharedHeader32 *) mapping;
+	manager->mappedSize = size;
+	manager->fd = fd;
+	return manager;
+}
+#endif
+
+// links a newly initialised block into the free list, same transaction as Handle_Manager32
+static void LinkBlock(Handle_SharedManager32 *manager, uint32_t baseIndex) {
+	Handle_SharedHeader32 *header = manager->header;
+	uint8_t *base = Handle_SharedManager32BlockBase(manager, baseIndex >> header->handlesPerBlockShift);
+	uint8_t const *gens = base + ((header->handlesPerBlockMask + 1) * header->elementSize);
+
+	for (uint32_t i = 0u; i < header->handlesPerBlockMask; ++i) {
+		uint32_t const index = baseIndex + i;
+		uint32_t *addr = (uint32_t *) (base + (i * header->elementSize));
+		*addr = FreeLink32(gens[i + 1], index + 1);
+	}
+
+	Handle_FreeListPushFree32(&header->freeListHeads,
+														FreeLink32(gens[0], baseIndex),
+														(uint32_t *) (base + (header->handlesPerBlockMask * header->elementSize)));
+}
+
+static uint32_t *FreeListItem(void *context, uint32_t actualIndex) {
+	Handle_SharedManager32 *manager = (Handle_SharedManager32 *) context;
+	Handle_SharedHeader32 *header = manager->header;
+	uint8_t *const base = Handle_SharedManager32BlockBase(manager, actualIndex >> header->handlesPerBlockShift);
+	return (uint32_t *) (base + ((actualIndex & header->handlesPerBlockMask) * header->elementSize));
+}
+
+// return true to retry the allocation, false means no hope
+static bool AllocNewBlock(Handle_SharedManager32 *manager) {
+	Handle_SharedHeader32 *header = manager->header;
+	uint32_t const handlesPerBlock = header->handlesPerBlockMask + 1;
+
+	uint32_t const baseIndex = Thread_AtomicFetchAdd32Relaxed(&header->totalHandlesAllocated, handlesPerBlock);
+	if (baseIndex >= handlesPerBlock * header->maxBlocks) {
+		LOGWARNING("Trying to allocate more than %u blocks! Increase block size or max blocks", header->maxBlocks);
+		Thread_AtomicFetchAdd32Relaxed(&header->totalHandlesAllocated, -(int32_t) handlesPerBlock);
+		return false;
+	}
+	// the memory is already mapped (and zero) so just build its free list
+	LinkBlock(manager, baseIndex);
+	return true;
+}
+
+AL2O3_EXTERN_C Handle_SharedManager32 *Handle_SharedManager32Create(char const *name,
+																																		uint32_t elementSize,
+																																		uint32_t handlesPerBlock,
+																																		uint32_t maxBlocks,
+																																		bool neverReissueOldHandles) {
+#if defined(HANDLE_SHARED_POSIX)
+	ASSERT(elementSize >= sizeof(uint32_t));
+
+	if (!IsPow2(handlesPerBlock)) {
+		LOGWARNING("handlesPerBlock (%u) should be a power of 2, using %u", handlesPerBlock, NextPow2(handlesPerBlock));
+		handlesPerBlock = NextPow2(handlesPerBlock);
+	}
+	if ((uint64_t) handlesPerBlock * maxBlocks > Handle_MaxHandles32) {
+		LOGWARNING("Shared manager can't have more than 16.7 million handles");
+		return NULL;
+	}
+
+	uint64_t const blockSize = ((uint64_t) handlesPerBlock * elementSize) + (handlesPerBlock * Handle_GenerationSize32);
+	// keep blocks 8 byte aligned
+	uint64_t const blocksOffset = (sizeof(Handle_SharedHeader32) + 0x7ull) & ~0x7ull;
+	size_t const size = (size_t) (blocksOffset + (((blockSize + 0x7ull) & ~0x7ull) * maxBlocks));
+
+	int fd;
+	if (name) {
+		fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	} else {
+#if defined(__linux__)
+		fd = (int) syscall(SYS_memfd_create, "al2o3_handle", 0);
+#else
+		LOGWARNING("Anonymous shared handle managers need memfd (Linux)");
+		return NULL;
+#endif
+	}
+	if (fd < 0) {
+		LOGWARNING("Unable to create shared handle manager segment %s", name ? name : "(memfd)");
+		return NULL;
+	}
+	if (ftruncate(fd, (off_t) size) != 0) {
+		LOGWARNING("Unable to size shared handle manager segment");
+		close(fd);
+		if (name) {
+			shm_unlink(name);
+		}
+		return NULL;
+	}
+
+	Handle_SharedManager32 *manager = MapSegment(fd, size);
+	if (!manager) {
+		close(fd);
+		if (name) {
+			shm_unlink(name);
+		}
+		return NULL;
+	}
+
+	Handle_SharedHeader32 *header = manager->header;
+	header->elementSize = elementSize;
+	header->maxBlocks = maxBlocks;
+	header->handlesPerBlockMask = handlesPerBlock - 1;
+	header->handlesPerBlockShift = SlowLog2(handlesPerBlock);
+	header->neverReissueOldHandles = neverReissueOldHandles;
+	header->blockSize = (blockSize + 0x7ull) & ~0x7ull;
+	header->blocksOffset = blocksOffset;
+	manager->blocks = ((uint8_t *) header) + blocksOffset;
+
+	// index zero is born generation 1, before linking so its link isn't 0
+	uint8_t *base = Handle_SharedManager32BlockBase(manager, 0);
+	*(base + (handlesPerBlock * elementSize)) = 1;
+
+	Thread_AtomicStore32Relaxed(&header->totalHandlesAllocated, handlesPerBlock);
+	Thread_AtomicStore64Relaxed(&header->freeListHeads, 0);
+	LinkBlock(manager, 0);
+
+	// publish, Open checks the magic last
+	Thread_AtomicThreadFenceRelease();
+	header->magic = Handle_SharedMagic32;
+
+	return manager;
+#else
+	(void) name;
+	(void) elementSize;
+	(void) handlesPerBlock;
+	(void) maxBlocks;
+	(void) neverReissueOldHandles;
+	LOGWARNING("Shared handle managers aren't supported on this platform");
+	return NULL;
+#endif
+}
+
+AL2O3_EXTERN_C Handle_SharedManager32 *Handle_SharedManager32OpenFd(int fd) {
+#if defined(HANDLE_SHARED_POSIX)
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(Handle_SharedHeader32)) {
+		LOGWARNING("Not a shared handle manager segment");
+		return NULL;
+	}
+	Handle_SharedManager32 *manager = MapSegment(fd, (size_t) info.st_size);
+	if (!manager) {
+		return NULL;
+	}
+	Handle_SharedHeader32 *header = manager->header;
+	// magic is written last by Create, so the rest of the header is only safe to
+	// read after we've seen it and fenced
+	bool valid = header->magic == Handle_SharedMagic32;
+	if (valid) {
+		Thread_AtomicThreadFenceAcquire();
+		valid = header->blocksOffset + (header->blockSize * header->maxBlocks) <= manager->mappedSize;
+	}
+	if (!valid) {
+		LOGWARNING("Not a shared handle manager segment");
+		munmap(manager->header, manager->mappedSize);
+		MEMORY_FREE(manager);
+		return NULL;
+	}
+	manager->blocks = ((uint8_t *) header) + header->blocksOffset;
+	return manager;
+#else
+	(void) fd;
+	return NULL;
+#endif
+}
+
+AL2O3_EXTERN_C Handle_SharedManager32 *Handle_SharedManager32Open(char const *name) {
+#if defined(HANDLE_SHARED_POSIX)
+	int fd = shm_open(name, O_RDWR, 0600);
+	if (fd < 0) {
+		LOGWARNING("Unable to open shared handle manager segment %s", name);
+		return NULL;
+	}
+	Handle_SharedManager32 *manager = Handle_SharedManager32OpenFd(fd);
+	if (!manager) {
+		close(fd);
+	}
+	return manager;
+#else
+	(void) name;
+	return NULL;
+#endif
+}
+
+AL2O3_EXTERN_C void Handle_SharedManager32Close(Handle_SharedManager32 *manager) {
+	if (!manager) {
+		return;
+	}
+#if defined(HANDLE_SHARED_POSIX)
+	munmap(manager->header, manager->mappedSize);
+	close(manager->fd);
+#endif
+	MEMORY_FREE(manager);
+}
+
+AL2O3_EXTERN_C void Handle_SharedManager32Unlink(char const *name) {
+#if defined(HANDLE_SHARED_POSIX)
+	shm_unlink(name);
+#else
+	(void) name;
+#endif
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_SharedManager32Alloc(Handle_SharedManager32 *manager) {
+	Handle_SharedHeader32 *header = manager->header;
+	uint32_t noFreeCount = 0;
+	uint32_t actualIndex;
+	while (!Handle_FreeListPop32(&header->freeListHeads, &FreeListItem, manager, &actualIndex)) {
+		bool retry = AllocNewBlock(manager);
+		if (retry == false || noFreeCount >= 1000) {
+			LOGWARNING("Manager has run out of handles");
+			Handle_Handle32 invalid = {0};
+			return invalid;
+		}
+		noFreeCount++;
+	}
+
+	uint32_t const index = actualIndex & header->handlesPerBlockMask;
+	uint8_t *const base = Handle_SharedManager32BlockBase(manager, actualIndex >> header->handlesPerBlockShift);
+	uint32_t *const item = (uint32_t *) (base + (index * header->elementSize));
+	memset(item, 0x0, header->elementSize);
+
+	uint8_t const *gen = base + ((header->handlesPerBlockMask + 1) * header->elementSize) + index;
+	Handle_Handle32 handle = {
+		.handle = ((uint32_t) *gen) << Handle_GenerationBitShift32 | actualIndex
+	};
+	return handle;
+}
+
+AL2O3_EXTERN_C void Handle_SharedManager32Release(Handle_SharedManager32 *manager, Handle_Handle32 handle) {
+	ASSERT(Handle_SharedManager32IsValid(manager, handle));
+	Handle_SharedHeader32 *header = manager->header;
+
+	uint32_t const actualIndex = handle.handle & Handle_MaxHandles32;
+	uint32_t const index = actualIndex & header->handlesPerBlockMask;
+	uint8_t *base = Handle_SharedManager32BlockBase(manager, actualIndex >> header->handlesPerBlockShift);
+	uint8_t *gen = base + ((header->handlesPerBlockMask + 1) * header->elementSize) + index;
+	uint32_t *item = (uint32_t *) (base + (index * header->elementSize));
+
+	// intentional 8 bit integer overflow
+	*gen = *gen + 1;
+	if (*gen == 0 && header->neverReissueOldHandles) {
+		// lose the handle and poison the data
+		memset(item, 0xDC, header->elementSize);
+		return;
+	}
+	if (*gen == 0 && actualIndex == 0) {
+		*gen = 1;
+	}
+
+	// tagged with the new generation
+	Handle_FreeListPushDeferred32(&header->freeListHeads, FreeLink32(*gen, actualIndex), item);
+}
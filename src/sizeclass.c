@@ -0,0 +1,154 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_handle/sizeclass.h"
+
+static uint32_t SizeToClass(size_t size) {
+	uint32_t sizeClass = 0;
+	size_t classSize = Handle_SizeClassMinSize;
+	while (classSize < size) {
+		classSize <<= 1u;
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+static size_t ClassToSize(uint32_t sizeClass) {
+	return ((size_t) Handle_SizeClassMinSize) << sizeClass;
+}
+
+static Handle_Manager64 *CreateClassManager(Handle_SizeClassAllocator *allocator, uint32_t elementSize) {
+	uint32_t handlesPerBlock = allocator->blockSize / elementSize;
+	if (handlesPerBlock < 16u) {
+		handlesPerBlock = 16u;
+	}
+	// the class bits sit above the manager's own index bits
+	if (((uint64_t) handlesPerBlock * allocator->maxBlocks) > Handle_SizeClassIndexMask64) {
+		LOGWARNING("Size class manager can't have more than 2^%llu handles",
+							 (unsigned long long) Handle_SizeClassShift64);
+		return NULL;
+	}
+	return Handle_Manager64Create(elementSize, handlesPerBlock, allocator->maxBlocks, false);
+}
+
+// lock free lazy creation, if another thread beats us we use theirs
+static Handle_Manager64 *GetOrCreateManager(Handle_SizeClassAllocator *allocator,
+																						Thread_AtomicPtr_t *slot,
+																						uint32_t elementSize) {
+	Handle_Manager64 *manager = (Handle_Manager64 *) Thread_AtomicLoadPtrRelaxed(slot);
+	if (manager) {
+		return manager;
+	}
+	Handle_Manager64 *newManager = CreateClassManager(allocator, elementSize);
+	if (!newManager) {
+		return NULL;
+	}
+	Handle_Manager64 *existing = (Handle_Manager64 *) Thread_AtomicCompareExchangePtrRelaxed(slot, NULL, newManager);
+	if (existing != NULL) {
+		Handle_Manager64Destroy(newManager);
+		return existing;
+	}
+	return newManager;
+}
+
+AL2O3_EXTERN_C Handle_SizeClassAllocator *Handle_SizeClassAllocatorCreate(uint32_t blockSize, uint32_t maxBlocks) {
+	Handle_SizeClassAllocator *allocator =
+			(Handle_SizeClassAllocator *) MEMORY_CALLOC(1, sizeof(Handle_SizeClassAllocator));
+	if (!allocator) {
+		return NULL;
+	}
+	allocator->blockSize = blockSize;
+	allocator->maxBlocks = maxBlocks;
+	return allocator;
+}
+
+AL2O3_EXTERN_C void Handle_SizeClassAllocatorDestroy(Handle_SizeClassAllocator *allocator) {
+	if (!allocator) {
+		return;
+	}
+	for (uint32_t i = 0u; i < Handle_SizeClassCount; ++i) {
+		Handle_Manager64Destroy((Handle_Manager64 *) Thread_AtomicLoadPtrRelaxed(&allocator->classes[i]));
+	}
+
+	Handle_Manager64 *large = (Handle_Manager64 *) Thread_AtomicLoadPtrRelaxed(&allocator->large);
+	if (large) {
+		// large objects own memory outside the manager
+		uint64_t const total = Thread_AtomicLoad64Relaxed(&large->totalHandlesAllocated);
+		for (uint64_t i = 0u; i < total; ++i) {
+			Handle_Handle64 handle = Handle_Manager64IndexToHandle(large, i);
+			if (handle.handle != 0) {
+				Handle_SizeClassLargeEntry64 *entry = (Handle_SizeClassLargeEntry64 *) Handle_Manager64HandleToPtr(large, handle);
+				MEMORY_FREE(entry->memory);
+			}
+		}
+		Handle_Manager64Destroy(large);
+	}
+	MEMORY_FREE(allocator);
+}
+
+AL2O3_EXTERN_C Handle_Handle64 Handle_SizeClassAlloc(Handle_SizeClassAllocator *allocator, size_t size) {
+	Handle_Handle64 invalid = {0};
+
+	if (size > Handle_SizeClassMaxSize) {
+		Handle_Manager64 *large = GetOrCreateManager(allocator, &allocator->large, sizeof(Handle_SizeClassLargeEntry64));
+		if (!large) {
+			return invalid;
+		}
+		void *memory = MEMORY_CALLOC(1, size);
+		if (!memory) {
+			LOGWARNING("Out of memory!");
+			return invalid;
+		}
+		Handle_Handle64 handle = Handle_Manager64Alloc(large);
+		if (handle.handle == 0) {
+			MEMORY_FREE(memory);
+			return invalid;
+		}
+		Handle_SizeClassLargeEntry64 *entry = (Handle_SizeClassLargeEntry64 *) Handle_Manager64HandleToPtr(large, handle);
+		entry->memory = memory;
+		entry->size = size;
+		handle.handle |= ((uint64_t) Handle_SizeClassLarge) << Handle_SizeClassShift64;
+		return handle;
+	}
+
+	uint32_t const sizeClass = SizeToClass(size);
+	Handle_Manager64 *manager =
+			GetOrCreateManager(allocator, &allocator->classes[sizeClass], (uint32_t) ClassToSize(sizeClass));
+	if (!manager) {
+		return invalid;
+	}
+	Handle_Handle64 handle = Handle_Manager64Alloc(manager);
+	if (handle.handle == 0) {
+		return invalid;
+	}
+	handle.handle |= ((uint64_t) sizeClass) << Handle_SizeClassShift64;
+	return handle;
+}
+
+AL2O3_EXTERN_C void Handle_SizeClassRelease(Handle_SizeClassAllocator *allocator, Handle_Handle64 handle) {
+	ASSERT(Handle_SizeClassIsValid(allocator, handle));
+	uint32_t const sizeClass = Handle_SizeClassOf(handle);
+	Handle_Manager64 *manager = Handle_SizeClassManager(allocator, sizeClass);
+	Handle_Handle64 const managerHandle = Handle_SizeClassToManagerHandle(handle);
+
+	if (sizeClass == Handle_SizeClassLarge) {
+		Handle_SizeClassLargeEntry64 *entry = (Handle_SizeClassLargeEntry64 *) Handle_Manager64HandleToPtr(manager, managerHandle);
+		MEMORY_FREE(entry->memory);
+	}
+	Handle_Manager64Release(manager, managerHandle);
+}
+
+AL2O3_EXTERN_C size_t Handle_SizeClassHandleToSize(Handle_SizeClassAllocator *allocator, Handle_Handle64 handle) {
+	if (!Handle_SizeClassIsValid(allocator, handle)) {
+		return 0;
+	}
+	uint32_t const sizeClass = Handle_SizeClassOf(handle);
+	if (sizeClass == Handle_SizeClassLarge) {
+		Handle_Manager64 *large = Handle_SizeClassManager(allocator, sizeClass);
+		Handle_SizeClassLargeEntry64 const *entry = (Handle_SizeClassLargeEntry64 const *)
+				Handle_Manager64HandleToPtr(large, Handle_SizeClassToManagerHandle(handle));
+		return entry->size;
+	}
+	return ClassToSize(sizeClass);
+}
@@ -0,0 +1,161 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_handle/slotmap.h"
+
+#define Handle_SlotMapEndOfList32 0xFFFFFFFFu
+
+static bool Resize(Handle_SlotMap32 *map, uint32_t newCapacity) {
+	ASSERT(newCapacity > map->capacity && newCapacity <= Handle_MaxHandles32);
+
+	// each array is only replaced once its realloc succeeded, so a failure part
+	// way through leaves some arrays bigger than capacity which is harmless
+	uint32_t *slots = (uint32_t *) MEMORY_REALLOC(map->slots, newCapacity * sizeof(uint32_t));
+	if (!slots) {
+		goto OutOfMemory;
+	}
+	map->slots = slots;
+
+	Handle_GenerationType32 *generations =
+			(Handle_GenerationType32 *) MEMORY_REALLOC(map->generations, newCapacity * Handle_GenerationSize32);
+	if (!generations) {
+		goto OutOfMemory;
+	}
+	map->generations = generations;
+
+	uint32_t *denseToSlot = (uint32_t *) MEMORY_REALLOC(map->denseToSlot, newCapacity * sizeof(uint32_t));
+	if (!denseToSlot) {
+		goto OutOfMemory;
+	}
+	map->denseToSlot = denseToSlot;
+
+	uint8_t *dense = (uint8_t *) MEMORY_REALLOC(map->dense, (size_t) newCapacity * map->elementSize);
+	if (!dense) {
+		goto OutOfMemory;
+	}
+	map->dense = dense;
+
+	map->capacity = newCapacity;
+	return true;
+
+OutOfMemory:
+	LOGWARNING("Out of memory!");
+	return false;
+}
+
+static bool Grow(Handle_SlotMap32 *map) {
+	if (map->capacity >= Handle_MaxHandles32) {
+		LOGWARNING("Slot map already has all 16.7 million handles!");
+		return false;
+	}
+	uint32_t newCapacity = map->capacity ? map->capacity * 2 : 16;
+	if (newCapacity > Handle_MaxHandles32) {
+		newCapacity = Handle_MaxHandles32;
+	}
+	return Resize(map, newCapacity);
+}
+
+AL2O3_EXTERN_C Handle_SlotMap32 *Handle_SlotMap32Create(uint32_t elementSize, uint32_t initialCapacity) {
+	ASSERT(elementSize > 0);
+	ASSERT(initialCapacity <= Handle_MaxHandles32);
+
+	Handle_SlotMap32 *map = (Handle_SlotMap32 *) MEMORY_CALLOC(1, sizeof(Handle_SlotMap32));
+	if (!map) {
+		return NULL;
+	}
+	map->elementSize = elementSize;
+	map->freeListHead = Handle_SlotMapEndOfList32;
+	map->freeListTail = Handle_SlotMapEndOfList32;
+
+	if (initialCapacity) {
+		if (!Resize(map, initialCapacity)) {
+			Handle_SlotMap32Destroy(map);
+			return NULL;
+		}
+	}
+
+	return map;
+}
+
+AL2O3_EXTERN_C void Handle_SlotMap32Destroy(Handle_SlotMap32 *map) {
+	if (!map) {
+		return;
+	}
+	MEMORY_FREE(map->slots);
+	MEMORY_FREE(map->generations);
+	MEMORY_FREE(map->denseToSlot);
+	MEMORY_FREE(map->dense);
+	MEMORY_FREE(map);
+}
+
+AL2O3_EXTERN_C Handle_Handle32 Handle_SlotMap32Alloc(Handle_SlotMap32 *map) {
+	uint32_t index;
+	// like the managers, untouched slots in the current capacity are handed out
+	// before reusing released ones, this extends the time between generation overlap
+	if (map->slotCount == map->capacity && map->freeListHead != Handle_SlotMapEndOfList32) {
+		// reuse the oldest free slot
+		index = map->freeListHead;
+		map->freeListHead = map->slots[index];
+		if (map->freeListHead == Handle_SlotMapEndOfList32) {
+			map->freeListTail = Handle_SlotMapEndOfList32;
+		}
+	} else {
+		// slots are never fewer than dense elements, so only slots need checking
+		if (map->slotCount == map->capacity && !Grow(map)) {
+			LOGWARNING("Slot map has run out of handles");
+			Handle_Handle32 invalid = {0}; // fail
+			return invalid;
+		}
+		index = map->slotCount++;
+		// index zero is born generation 1
+		map->generations[index] = (index == 0) ? 1 : 0;
+	}
+
+	uint32_t const denseIndex = map->size++;
+	map->slots[index] = denseIndex;
+	map->denseToSlot[denseIndex] = index;
+
+	// clear it out ready for its new life
+	memset(map->dense + ((size_t) denseIndex * map->elementSize), 0x0, map->elementSize);
+
+	Handle_Handle32 handle = {
+		.handle = ((uint32_t) map->generations[index]) << Handle_GenerationBitShift32 | index
+	};
+	return handle;
+}
+
+AL2O3_EXTERN_C void Handle_SlotMap32Release(Handle_SlotMap32 *map, Handle_Handle32 handle) {
+	ASSERT(Handle_SlotMap32IsValid(map, handle));
+
+	uint32_t const index = handle.handle & Handle_MaxHandles32; // clean out the current generation
+	uint32_t const denseIndex = map->slots[index];
+	uint32_t const lastDenseIndex = map->size - 1;
+
+	// swap and pop, move the last element into the hole to keep the array packed
+	if (denseIndex != lastDenseIndex) {
+		uint32_t const movedIndex = map->denseToSlot[lastDenseIndex];
+		memcpy(map->dense + ((size_t) denseIndex * map->elementSize),
+					 map->dense + ((size_t) lastDenseIndex * map->elementSize),
+					 map->elementSize);
+		map->denseToSlot[denseIndex] = movedIndex;
+		map->slots[movedIndex] = denseIndex;
+	}
+	map->size--;
+
+	// update the generation of this index
+	// intentional 8 bit integer overflow
+	map->generations[index] = map->generations[index] + 1;
+	// handle 0 special case
+	if (map->generations[index] == 0 && index == 0) {
+		map->generations[index] = 1;
+	}
+
+	// append to the tail of the free list
+	map->slots[index] = Handle_SlotMapEndOfList32;
+	if (map->freeListTail == Handle_SlotMapEndOfList32) {
+		map->freeListHead = index;
+	} else {
+		map->slots[map->freeListTail] = index;
+	}
+	map->freeListTail = index;
+}
@@ -0,0 +1,78 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/handle.h"
+
+namespace {
+struct Tracker {
+	uint32_t allocCount;
+	uint32_t freeCount;
+	size_t liveBytes;
+};
+
+void *TrackedAlloc(void *context, size_t size, size_t alignment) {
+	Tracker *tracker = (Tracker *) context;
+	REQUIRE(alignment == Handle_BlockAlignment);
+	tracker->allocCount++;
+	tracker->liveBytes += size;
+	return MEMORY_CALLOC(1, size);
+}
+
+void TrackedFree(void *context, void *ptr, size_t size) {
+	Tracker *tracker = (Tracker *) context;
+	tracker->freeCount++;
+	tracker->liveBytes -= size;
+	MEMORY_FREE(ptr);
+}
+} // end anon namespace
+
+TEST_CASE("Block allocator 32", "[al2o3 handle blockalloc]") {
+	static const int AllocationBlockSize = 16;
+	Tracker tracker = {};
+	Handle_BlockAllocator const allocator = { &TrackedAlloc, &TrackedFree, &tracker };
+
+	Handle_Manager32 *manager = Handle_Manager32CreateWithAllocator(sizeof(uint64_t), AllocationBlockSize, 4, false, &allocator);
+	REQUIRE(manager);
+	// just the header with the embedded first block
+	REQUIRE(tracker.allocCount == 1);
+
+	for (int i = 0; i < AllocationBlockSize * 3; ++i) {
+		Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+		REQUIRE(handle.handle != 0);
+	}
+	REQUIRE(tracker.allocCount == 3);
+
+	// clones use the same allocator
+	Handle_Manager32 *clone = Handle_Manager32Clone(manager);
+	REQUIRE(clone);
+	REQUIRE(tracker.allocCount == 6);
+	Handle_Manager32Destroy(clone);
+	Handle_Manager32Destroy(manager);
+
+	REQUIRE(tracker.freeCount == tracker.allocCount);
+	REQUIRE(tracker.liveBytes == 0);
+}
+
+TEST_CASE("Block allocator 64", "[al2o3 handle blockalloc]") {
+	static const int AllocationBlockSize = 16;
+	Tracker tracker = {};
+	Handle_BlockAllocator const allocator = { &TrackedAlloc, &TrackedFree, &tracker };
+
+	// one allocator shared by a couple of managers
+	Handle_Manager64 *managerA = Handle_Manager64CreateWithAllocator(sizeof(uint64_t), AllocationBlockSize, 4, false, 0, &allocator);
+	Handle_Manager64 *managerB =
+			Handle_Manager64CreateWithAllocator(sizeof(uint64_t), AllocationBlockSize, 4, false, Handle_Manager64FlagSeqLock, &allocator);
+	REQUIRE(managerA);
+	REQUIRE(managerB);
+	for (int i = 0; i < AllocationBlockSize * 2; ++i) {
+		REQUIRE(Handle_Manager64Alloc(managerA).handle != 0);
+		REQUIRE(Handle_Manager64Alloc(managerB).handle != 0);
+	}
+	REQUIRE(tracker.allocCount == 4);
+
+	Handle_Manager64Destroy(managerA);
+	Handle_Manager64Destroy(managerB);
+	REQUIRE(tracker.freeCount == 4);
+	REQUIRE(tracker.liveBytes == 0);
+}
@@ -0,0 +1,114 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_thread/thread.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/handle.h"
+#include "al2o3_handle/epoch.h"
+
+TEST_CASE("Basic tests Epoch", "[al2o3 handle epoch]") {
+	Handle_Manager32 *manager = Handle_Manager32Create(sizeof(uint64_t), 16, 4, false);
+	REQUIRE(manager);
+	Handle_EpochDomain *domain = Handle_EpochDomainCreate();
+	REQUIRE(domain);
+	Handle_EpochThread *reader = Handle_EpochRegisterThread(domain);
+	Handle_EpochThread *writer = Handle_EpochRegisterThread(domain);
+	REQUIRE(reader);
+	REQUIRE(writer);
+
+	Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+	*(uint64_t *) Handle_Manager32HandleToPtr(manager, handle) = 0xDEADBEEFDEADBEEFull;
+
+	Handle_EpochEnter(domain, reader);
+	uint64_t *ptr = (uint64_t *) Handle_Manager32HandleToPtr(manager, handle);
+
+	REQUIRE(Handle_EpochRelease32(domain, writer, manager, handle));
+	// the handle is dead straight away
+	REQUIRE(!Handle_Manager32IsValid(manager, handle));
+	// but whilst the reader is pinned the memory is untouched
+	REQUIRE(Handle_EpochReclaim(domain, writer) == 1);
+	REQUIRE(Handle_EpochReclaim(domain, writer) == 1);
+	REQUIRE(*ptr == 0xDEADBEEFDEADBEEFull);
+
+	Handle_EpochLeave(domain, reader);
+	// once the reader has left the epoch can advance and the slot is recycled
+	REQUIRE(Handle_EpochReclaim(domain, writer) == 0);
+	REQUIRE(*ptr != 0xDEADBEEFDEADBEEFull);
+
+	Handle_EpochUnregisterThread(domain, reader);
+	Handle_EpochUnregisterThread(domain, writer);
+	Handle_EpochDomainDestroy(domain);
+	Handle_Manager32Destroy(manager);
+}
+
+namespace {
+struct EpochTestData {
+	Handle_Manager32 *manager;
+	Handle_EpochDomain *domain;
+	Thread_Atomic32_t current;
+	Thread_Atomic32_t done;
+	Thread_Atomic32_t failures;
+};
+}
+
+static void EpochReaderFunc(void *userPtr) {
+	EpochTestData *data = (EpochTestData *) userPtr;
+	Handle_EpochThread *thread = Handle_EpochRegisterThread(data->domain);
+	while (Thread_AtomicLoad32Relaxed(&data->done) == 0) {
+		Handle_EpochEnter(data->domain, thread);
+		Handle_Handle32 handle = {Thread_AtomicLoad32Relaxed(&data->current)};
+		if (Handle_Manager32IsValid(data->manager, handle)) {
+			uint64_t const *ptr = (uint64_t const *) Handle_Manager32HandleToPtr(data->manager, handle);
+			// every element is written as its own handle, a recycle would overwrite it
+			// (NULL if it was released between the valid check and getting the pointer)
+			for (int i = 0; ptr && i < 100; ++i) {
+				if (ptr[0] != handle.handle) {
+					Thread_AtomicFetchAdd32Relaxed(&data->failures, 1);
+				}
+			}
+		}
+		Handle_EpochLeave(data->domain, thread);
+	}
+	Handle_EpochUnregisterThread(data->domain, thread);
+}
+
+TEST_CASE("Multithreaded Epoch", "[al2o3 handle epoch]") {
+	static const uint32_t numThreads = 4;
+	EpochTestData data;
+	data.manager = Handle_Manager32Create(sizeof(uint64_t), 1024, 64, false);
+	data.domain = Handle_EpochDomainCreate();
+	REQUIRE(data.manager);
+	REQUIRE(data.domain);
+	Thread_AtomicStore32Relaxed(&data.current, 0);
+	Thread_AtomicStore32Relaxed(&data.done, 0);
+	Thread_AtomicStore32Relaxed(&data.failures, 0);
+
+	Thread_Thread *threads = (Thread_Thread *) STACK_ALLOC(sizeof(Thread_Thread) * numThreads);
+	for (auto i = 0u; i < numThreads; ++i) {
+		Thread_ThreadCreate(threads + i, &EpochReaderFunc, &data);
+	}
+
+	Handle_EpochThread *writer = Handle_EpochRegisterThread(data.domain);
+	Handle_Handle32 previous = {0};
+	for (int i = 0; i < 50000; ++i) {
+		Handle_Handle32 handle = Handle_Manager32Alloc(data.manager);
+		REQUIRE(handle.handle != 0);
+		*(uint64_t *) Handle_Manager32HandleToPtr(data.manager, handle) = handle.handle;
+		Thread_AtomicStore32Relaxed(&data.current, handle.handle);
+		if (previous.handle) {
+			REQUIRE(Handle_EpochRelease32(data.domain, writer, data.manager, previous));
+		}
+		previous = handle;
+	}
+	Thread_AtomicStore32Relaxed(&data.done, 1);
+
+	for (auto i = 0u; i < numThreads; ++i) {
+		Thread_ThreadJoin(threads + i);
+		Thread_ThreadDestroy(threads + i);
+	}
+	REQUIRE(Thread_AtomicLoad32Relaxed(&data.failures) == 0);
+
+	Handle_EpochUnregisterThread(data.domain, writer);
+	Handle_EpochDomainDestroy(data.domain);
+	Handle_Manager32Destroy(data.manager);
+}
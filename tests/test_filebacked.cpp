@@ -0,0 +1,73 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/handle.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <stdio.h>
+#include <unistd.h>
+
+TEST_CASE("File backed 64", "[al2o3 handle filebacked]") {
+	static const int AllocationBlockSize = 16;
+	static const int Count = AllocationBlockSize * 6;
+	char path[128];
+	snprintf(path, sizeof(path), "/tmp/al2o3_handle_test_%d.bin", (int) getpid());
+	remove(path);
+
+	Handle_Manager64 *manager = Handle_Manager64CreateFile(path, sizeof(uint64_t), AllocationBlockSize, 16, false, 0);
+	REQUIRE(manager);
+	Handle_Manager64FileAdvise(manager, Handle_FileAdviceRandom);
+
+	Handle_Handle64 handles[Count];
+	for (int i = 0; i < Count; ++i) {
+		handles[i] = Handle_Manager64Alloc(manager);
+		REQUIRE(handles[i].handle != 0);
+		*(uint64_t *) Handle_Manager64HandleToPtr(manager, handles[i]) = 1000 + i;
+	}
+	// release every other one
+	for (int i = 0; i < Count; i += 2) {
+		Handle_Manager64Release(manager, handles[i]);
+	}
+	REQUIRE(Handle_Manager64FileFlush(manager, true));
+	Handle_Manager64Destroy(manager);
+
+	// different parameters won't open it
+	LOGINFO("The next WARN is expected as we are testing a parameter mismatch");
+	REQUIRE(Handle_Manager64CreateFile(path, sizeof(uint64_t) * 2, AllocationBlockSize, 16, false, 0) == NULL);
+
+	// a restart just remaps the file
+	manager = Handle_Manager64CreateFile(path, sizeof(uint64_t), AllocationBlockSize, 16, false, 0);
+	REQUIRE(manager);
+	for (int i = 0; i < Count; ++i) {
+		if (i & 0x1) {
+			REQUIRE(Handle_Manager64IsValid(manager, handles[i]));
+			REQUIRE(*(uint64_t *) Handle_Manager64HandleToPtr(manager, handles[i]) == (uint64_t) (1000 + i));
+		} else {
+			REQUIRE(!Handle_Manager64IsValid(manager, handles[i]));
+		}
+	}
+	// the free list survived too, released slots are reused before growing
+	uint64_t const total = Thread_AtomicLoad64Relaxed(&manager->totalHandlesAllocated);
+	for (int i = 0; i < Count / 2; ++i) {
+		Handle_Handle64 handle = Handle_Manager64Alloc(manager);
+		REQUIRE(handle.handle != 0);
+	}
+	REQUIRE(Thread_AtomicLoad64Relaxed(&manager->totalHandlesAllocated) == total);
+	// and it can still grow into unused blocks
+	for (int i = 0; i < AllocationBlockSize * 2; ++i) {
+		Handle_Handle64 handle = Handle_Manager64Alloc(manager);
+		REQUIRE(handle.handle != 0);
+		*(uint64_t *) Handle_Manager64HandleToPtr(manager, handle) = i;
+	}
+	// blocks are found from their offset in the file
+	for (int i = 1; i < Count; i += 2) {
+		void *element = Handle_Manager64HandleToPtr(manager, handles[i]);
+		REQUIRE(Handle_Manager64PtrToHandle(manager, element).handle == handles[i].handle);
+	}
+	Handle_Manager64FileAdvise(manager, Handle_FileAdviceDontNeed);
+	REQUIRE(*(uint64_t *) Handle_Manager64HandleToPtr(manager, handles[1]) == 1001);
+
+	Handle_Manager64Destroy(manager);
+	remove(path);
+}
+#endif
@@ -37,6 +37,31 @@ TEST_CASE("Basic tests Fixed", "[al2o3 handle fixed]") {
 	Handle_FixedManager32Destroy(manager);
 }
 
+TEST_CASE("Batch alloc Fixed", "[al2o3 handle fixed]") {
+	Handle_FixedManager32* manager = Handle_FixedManager32Create(sizeof(Test), 16);
+	REQUIRE(manager);
+	Handle_FixedManager32SetInitPolicy(manager, Handle_InitPolicyStreamZero, NULL, NULL);
+
+	Handle_FixedHandle32 handles[16];
+	REQUIRE(Handle_FixedManager32AllocBatch(manager, handles, 8) == 8);
+	for(int i=0;i < 8;++i) {
+		FillTest((Test*)Handle_FixedManager32HandleToPtr(manager, handles[i]));
+	}
+	Handle_FixedManager32Release(manager, handles[3]);
+
+	// what's left, the released one is zeroed again
+	REQUIRE(Handle_FixedManager32AllocBatch(manager, handles, 16) == 9);
+	for(int i=0;i < 9;++i) {
+		REQUIRE(Handle_FixedManager32IsValid(manager, handles[i]));
+		Test* test = (Test*)Handle_FixedManager32HandleToPtr(manager, handles[i]);
+		for(int j=0;j < 256;++j) {
+			REQUIRE(test->data[j] == 0);
+		}
+	}
+
+	Handle_FixedManager32Destroy(manager);
+}
+
 TEST_CASE("generation tests Fixed", "[al2o3 handle fixed]") {
 	static const int AllocationBlockSize = 16;
 	Handle_FixedManager32* manager = Handle_FixedManager32Create(sizeof(Test), AllocationBlockSize*4);
@@ -56,6 +81,67 @@ TEST_CASE("generation tests Fixed", "[al2o3 handle fixed]") {
 
 	Handle_FixedManager32Destroy(manager);
 }
+TEST_CASE("Reset Fixed", "[al2o3 handle fixed]") {
+	static const int Count = 64;
+	Handle_FixedManager32* manager = Handle_FixedManager32Create(sizeof(Test), Count);
+	REQUIRE(manager);
+
+	Handle_FixedHandle32 handles[Count];
+	for (int i = 0; i < Count; ++i) {
+		handles[i] = Handle_FixedManager32Alloc(manager);
+	}
+	for (int i = 0; i < Count; i += 2) {
+		Handle_FixedManager32Release(manager, handles[i]);
+	}
+
+	Handle_FixedManager32Reset(manager);
+	for (int i = 0; i < Count; ++i) {
+		REQUIRE(!Handle_FixedManager32IsValid(manager, handles[i]));
+	}
+	// all of them can be had again
+	for (int i = 0; i < Count; ++i) {
+		handles[i] = Handle_FixedManager32Alloc(manager);
+		REQUIRE(Handle_FixedManager32IsValid(manager, handles[i]));
+	}
+	Handle_FixedManager32Release(manager, handles[7]);
+	REQUIRE(Handle_FixedManager32Alloc(manager) != Handle_InvalidFixedHandle32);
+
+	Handle_FixedManager32Destroy(manager);
+}
+TEST_CASE("Single threaded Fixed", "[al2o3 handle fixed]") {
+	static const int Count = 64;
+	Handle_FixedManager32* manager = Handle_FixedManager32CreateSingleThreaded(sizeof(Test), Count);
+	REQUIRE(manager);
+	Handle_FixedManager32* reference = Handle_FixedManager32Create(sizeof(Test), Count);
+	REQUIRE(reference);
+
+	Handle_FixedHandle32 handles[Count];
+	for (int pass = 0; pass < 3; ++pass) {
+		for (int i = 0; i < Count; ++i) {
+			handles[i] = Handle_FixedManager32Alloc(manager);
+			REQUIRE(handles[i] == Handle_FixedManager32Alloc(reference));
+			REQUIRE(Handle_FixedManager32IsValid(manager, handles[i]));
+		}
+		for (int i = 0; i < Count; i += 2) {
+			Handle_FixedManager32Release(manager, handles[i]);
+			Handle_FixedManager32Release(reference, handles[i]);
+		}
+		for (int i = 1; i < Count; i += 2) {
+			Handle_FixedManager32Release(manager, handles[i]);
+			Handle_FixedManager32Release(reference, handles[i]);
+		}
+	}
+	// full is reported straight away
+	for (int i = 0; i < Count; ++i) {
+		handles[i] = Handle_FixedManager32Alloc(manager);
+	}
+	LOGINFO("The next WARN is expected as we are testing the invalid value is return");
+	REQUIRE(Handle_FixedManager32Alloc(manager) == Handle_InvalidFixedHandle32);
+
+	Handle_FixedManager32Destroy(reference);
+	Handle_FixedManager32Destroy(manager);
+}
+
 TEST_CASE("Run out of handles test Fixed", "[al2o3 handle fixed]") {
 	static const int AllocationBlockSize = 16;
 	Handle_FixedManager32* manager = Handle_FixedManager32Create(sizeof(Test), AllocationBlockSize);
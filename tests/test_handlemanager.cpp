@@ -1,5 +1,6 @@
 // License Summary: MIT see LICENSE file
 #include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
 #include "al2o3_thread/atomic.h"
 #include "al2o3_catch2/catch2.hpp"
 #include "al2o3_handle/handle.h"
@@ -22,6 +23,30 @@ void FillTest(Test *test) {
 		test->data[i] = i;
 	}
 }
+
+void MarkTest(void* userData, void* element, size_t elementSize) {
+	REQUIRE(elementSize == sizeof(Test));
+	memset(element, 0xAB, elementSize);
+	(*(int*)userData)++;
+}
+
+void FillTestInit(void* userData, void* element, size_t elementSize) {
+	(void)elementSize;
+	FillTest((Test*)element);
+	(*(int*)userData)++;
+}
+
+// sends whatever is dirty in manager to replica as a delta
+void SyncReplica32(Handle_Manager32* manager, Handle_Manager32* replica) {
+	Handle_DirtyRange32 ranges[64];
+	uint32_t const rangeCount = Handle_Manager32CollectDirty(manager, 0, ranges, 64);
+	Handle_Manager32ClearDirty(manager, ranges, rangeCount);
+	size_t const deltaSize = Handle_Manager32SerialiseDelta(manager, ranges, rangeCount, NULL, 0);
+	void* delta = MEMORY_MALLOC(deltaSize);
+	REQUIRE(Handle_Manager32SerialiseDelta(manager, ranges, rangeCount, delta, deltaSize) == deltaSize);
+	REQUIRE(Handle_Manager32ApplyDelta(replica, delta, deltaSize));
+	MEMORY_FREE(delta);
+}
 } // end anon namespace
 TEST_CASE("Basic tests 32", "[al2o3 handle]") {
 	Handle_Manager32* manager = Handle_Manager32Create(sizeof(Test), 16, 1, false);
@@ -33,6 +58,9 @@ TEST_CASE("Basic tests 32", "[al2o3 handle]") {
 	Handle_Handle32 handle1 = Handle_Manager32Alloc(manager);
 	REQUIRE(handle1.handle == 1);
 	Handle_Manager32Release(manager, handle1);
+	// the deferred link carries the new generation so a stale pop's CAS fails
+	uint64_t const heads = Thread_AtomicLoad64Relaxed(&manager->freeListHeads);
+	REQUIRE((uint32_t)(heads >> 32ull) == 0x01000001);
 
 	Handle_Manager32Destroy(manager);
 }
@@ -145,6 +173,90 @@ TEST_CASE("Basic tests 64", "[al2o3 handle]") {
 }
 
 
+TEST_CASE("Geometric growth 32", "[al2o3 handle]") {
+	static const int FirstBlockSize = 4;
+	static const int MaxBlocks = 6;
+	static const int Count = FirstBlockSize * ((1 << MaxBlocks) - 1);
+	Handle_Manager32* manager = Handle_Manager32CreateGeometric(sizeof(uint32_t), FirstBlockSize, MaxBlocks, false);
+	REQUIRE(manager);
+
+	// block k starts at 4 * (2^k - 1) and holds 4 << k
+	uint32_t blockIndex;
+	uint32_t slot;
+	REQUIRE(Handle_Manager32Locate(manager, 3, &blockIndex, &slot) == 4);
+	REQUIRE((blockIndex == 0 && slot == 3));
+	REQUIRE(Handle_Manager32Locate(manager, 4, &blockIndex, &slot) == 8);
+	REQUIRE((blockIndex == 1 && slot == 0));
+	REQUIRE(Handle_Manager32Locate(manager, 27, &blockIndex, &slot) == 16);
+	REQUIRE((blockIndex == 2 && slot == 15));
+	REQUIRE(Handle_Manager32Locate(manager, 28, &blockIndex, &slot) == 32);
+	REQUIRE((blockIndex == 3 && slot == 0));
+
+	Handle_Handle32 handles[Count];
+	for (int i = 0; i < Count; ++i) {
+		handles[i] = Handle_Manager32Alloc(manager);
+		REQUIRE(handles[i].handle != 0);
+		if (i != 0) {
+			REQUIRE(handles[i].handle == (uint32_t) i);
+		}
+		*(uint32_t*)Handle_Manager32HandleToPtrGeometric(manager, handles[i]) = i;
+	}
+	for (int i = 0; i < MaxBlocks; ++i) {
+		REQUIRE(Thread_AtomicLoadPtrRelaxed(&manager->blocks[i]) != NULL);
+	}
+	SimpleLogManager_SetWarningQuiet(logger, true);
+	REQUIRE(Handle_Manager32Alloc(manager).handle == 0);
+	SimpleLogManager_SetWarningQuiet(logger, false);
+
+	Handle_Manager32* clone = Handle_Manager32Clone(manager);
+	REQUIRE(clone);
+	for (int i = 0; i < Count; ++i) {
+		REQUIRE(*(uint32_t*)Handle_Manager32HandleToPtrGeometric(manager, handles[i]) == (uint32_t) i);
+		REQUIRE(*(uint32_t*)Handle_Manager32HandleToPtrGeometric(clone, handles[i]) == (uint32_t) i);
+	}
+	Handle_Manager32Destroy(clone);
+
+	Handle_Manager32Release(manager, handles[Count - 1]);
+	REQUIRE(!Handle_Manager32IsValidGeometric(manager, handles[Count - 1]));
+	Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+	REQUIRE((handle.handle & Handle_MaxHandles32) == (uint32_t) (Count - 1));
+
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Growable directory 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	static const int Count = 100000;
+	Handle_Manager32* manager = Handle_Manager32CreateGrowable(sizeof(uint32_t), AllocationBlockSize, false);
+	REQUIRE(manager);
+	REQUIRE(manager->blocks == NULL);
+	REQUIRE(manager->directory != NULL);
+
+	// far more blocks than a single directory page covers
+	REQUIRE(Count / AllocationBlockSize > (1 << manager->directoryPageShift));
+	CADT_VectorHandle handles = CADT_VectorCreate(sizeof(Handle_Handle32));
+	for (int i = 0; i < Count; ++i) {
+		Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+		REQUIRE(handle.handle != 0);
+		*(uint32_t*)Handle_Manager32HandleToPtrGrowable(manager, handle) = i;
+		CADT_VectorPushElement(handles, &handle);
+	}
+	Handle_Manager32* clone = Handle_Manager32Clone(manager);
+	REQUIRE(clone);
+	for (int i = 0; i < Count; i += 7) {
+		Handle_Handle32 handle = *(Handle_Handle32*)CADT_VectorAt(handles, i);
+		REQUIRE(*(uint32_t*)Handle_Manager32HandleToPtrGrowable(manager, handle) == (uint32_t) i);
+		REQUIRE(*(uint32_t*)Handle_Manager32HandleToPtrGrowable(clone, handle) == (uint32_t) i);
+		Handle_Manager32Release(manager, handle);
+		REQUIRE(!Handle_Manager32IsValidGrowable(manager, handle));
+		REQUIRE(Handle_Manager32IsValidGrowable(clone, handle));
+	}
+	Handle_Manager32Destroy(clone);
+
+	CADT_VectorDestroy(handles);
+	Handle_Manager32Destroy(manager);
+}
+
 TEST_CASE("Block allocation tests 64", "[al2o3 handle]") {
 	static const int AllocationBlockSize = 16;
 	Handle_Manager64* manager = Handle_Manager64Create(sizeof(Test),
@@ -209,6 +321,671 @@ TEST_CASE("generation tests 64", "[al2o3 handle]") {
 
 
 
+TEST_CASE("Reset 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	static const int Count = AllocationBlockSize * 3;
+	Handle_Manager32* manager = Handle_Manager32Create(sizeof(Test), AllocationBlockSize, 4, false);
+	REQUIRE(manager);
+
+	Handle_Handle32 handles[Count];
+	for (int i = 0; i < Count; ++i) {
+		handles[i] = Handle_Manager32Alloc(manager);
+	}
+	for (int i = 0; i < Count; i += 3) {
+		Handle_Manager32Release(manager, handles[i]);
+	}
+	uint32_t const total = Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated);
+
+	Handle_Manager32Reset(manager);
+	for (int i = 0; i < Count; ++i) {
+		REQUIRE(!Handle_Manager32IsValid(manager, handles[i]));
+	}
+	// every existing slot comes back before the manager grows
+	for (uint32_t i = 0; i < total; ++i) {
+		Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+		REQUIRE(Handle_Manager32IsValid(manager, handle));
+		REQUIRE((handle.handle & Handle_MaxHandles32) == i);
+	}
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) == total);
+	Handle_Manager32Alloc(manager);
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) > total);
+
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Reset 32 never reissue old handles", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	Handle_Manager32* manager = Handle_Manager32Create(sizeof(Test), AllocationBlockSize, 4, true);
+	REQUIRE(manager);
+
+	Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+	// put index 5 on its last generation, the reset wraps and loses it
+	uint8_t* gens = Handle_Manager32BlockBase(manager, 0) + (AllocationBlockSize * sizeof(Test));
+	gens[5] = 0xFF;
+
+	Handle_Manager32Reset(manager);
+	REQUIRE(!Handle_Manager32IsValid(manager, handle));
+	for (uint32_t i = 0; i < AllocationBlockSize - 1; ++i) {
+		Handle_Handle32 reissued = Handle_Manager32Alloc(manager);
+		REQUIRE(Handle_Manager32IsValid(manager, reissued));
+		REQUIRE((reissued.handle & Handle_MaxHandles32) != 5);
+	}
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) == AllocationBlockSize);
+
+	// and stays lost through the next one
+	Handle_Manager32Reset(manager);
+	REQUIRE(gens[5] == 0);
+
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Reset 64", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	static const int Count = AllocationBlockSize * 3;
+	Handle_Manager64* manager = Handle_Manager64Create(sizeof(Test), AllocationBlockSize, 4, false);
+	REQUIRE(manager);
+
+	Handle_Handle64 handles[Count];
+	for (int i = 0; i < Count; ++i) {
+		handles[i] = Handle_Manager64Alloc(manager);
+	}
+	for (int i = 0; i < Count; i += 3) {
+		Handle_Manager64Release(manager, handles[i]);
+	}
+	uint64_t const total = Thread_AtomicLoad64Relaxed(&manager->totalHandlesAllocated);
+
+	Handle_Manager64Reset(manager);
+	for (int i = 0; i < Count; ++i) {
+		REQUIRE(!Handle_Manager64IsValid(manager, handles[i]));
+		REQUIRE(Handle_Manager64IndexToHandle(manager, i).handle == 0);
+	}
+	for (uint64_t i = 0; i < total; ++i) {
+		Handle_Handle64 handle = Handle_Manager64Alloc(manager);
+		REQUIRE(Handle_Manager64IsValid(manager, handle));
+		REQUIRE((handle.handle & Handle_MaxHandles64) == i);
+		REQUIRE(Handle_Manager64IndexToHandle(manager, i).handle == handle.handle);
+	}
+	REQUIRE(Thread_AtomicLoad64Relaxed(&manager->totalHandlesAllocated) == total);
+
+	Handle_Manager64Destroy(manager);
+}
+
+TEST_CASE("Dirty tracking 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	static const int MaxRanges = 64;
+	Handle_Manager32* manager = Handle_Manager32CreateTracked(sizeof(Test), AllocationBlockSize, 4, false);
+	REQUIRE(manager);
+	Handle_Manager32* replica = Handle_Manager32CreateTracked(sizeof(Test), AllocationBlockSize, 4, false);
+	REQUIRE(replica);
+
+	Handle_DirtyRange32 ranges[MaxRanges];
+	// a new block is dirty as a whole
+	REQUIRE(Handle_Manager32CollectDirty(manager, 0, ranges, MaxRanges) == 1);
+	REQUIRE(ranges[0].first == 0);
+	REQUIRE(ranges[0].count == AllocationBlockSize);
+	Handle_Manager32ClearDirty(manager, ranges, 1);
+	REQUIRE(Handle_Manager32CollectDirty(manager, 0, ranges, MaxRanges) == 0);
+
+	Handle_Handle32 handles[AllocationBlockSize + 4];
+	for (int i = 0; i < AllocationBlockSize; ++i) {
+		handles[i] = Handle_Manager32Alloc(manager);
+	}
+	Handle_Manager32ClearDirty(manager, ranges, Handle_Manager32CollectDirty(manager, 0, ranges, MaxRanges));
+
+	// only what is touched shows up
+	FillTest((Test*)Handle_Manager32HandleToPtr(manager, handles[3]));
+	Handle_Manager32MarkDirty(manager, handles[3]);
+	Handle_Manager32MarkDirty(manager, handles[4]);
+	Handle_Manager32Release(manager, handles[9]);
+	uint32_t rangeCount = Handle_Manager32CollectDirty(manager, 0, ranges, MaxRanges);
+	REQUIRE(rangeCount == 2);
+	REQUIRE(ranges[0].first == 3);
+	REQUIRE(ranges[0].count == 2);
+	REQUIRE(ranges[1].first == 9);
+	REQUIRE(ranges[1].count == 1);
+	// a short array stops early, carry on from the end of the last range
+	REQUIRE(Handle_Manager32CollectDirty(manager, 0, ranges, 1) == 1);
+	REQUIRE(Handle_Manager32CollectDirty(manager, ranges[0].first + ranges[0].count, ranges, 1) == 1);
+	REQUIRE(ranges[0].first == 9);
+
+	// growing makes a new dirty block, the delta carries it and the changed slots
+	for (int i = AllocationBlockSize; i < AllocationBlockSize + 4; ++i) {
+		handles[i] = Handle_Manager32Alloc(manager);
+	}
+	rangeCount = Handle_Manager32CollectDirty(manager, 0, ranges, MaxRanges);
+	Handle_Manager32ClearDirty(manager, ranges, rangeCount);
+	size_t const deltaSize = Handle_Manager32SerialiseDelta(manager, ranges, rangeCount, NULL, 0);
+	size_t const fullSize = Handle_Manager32SerialiseDelta(manager, NULL, 0, NULL, 0) +
+			(AllocationBlockSize * 2 * (sizeof(Test) + 1));
+	REQUIRE(deltaSize < fullSize);
+	void* delta = MEMORY_MALLOC(deltaSize);
+	REQUIRE(Handle_Manager32SerialiseDelta(manager, ranges, rangeCount, delta, deltaSize) == deltaSize);
+
+	// the replica only has the changed slots but agrees on those and on the free list
+	REQUIRE(Handle_Manager32ApplyDelta(replica, delta, deltaSize));
+	REQUIRE(Handle_Manager32IsValid(replica, handles[3]));
+	REQUIRE(!Handle_Manager32IsValid(replica, handles[9]));
+	REQUIRE(memcmp(Handle_Manager32HandleToPtr(replica, handles[3]), Handle_Manager32HandleToPtr(manager, handles[3]), sizeof(Test)) == 0);
+	for (int i = AllocationBlockSize; i < AllocationBlockSize + 4; ++i) {
+		REQUIRE(Handle_Manager32IsValid(replica, handles[i]));
+	}
+	REQUIRE(Handle_Manager32Alloc(replica).handle == Handle_Manager32Alloc(manager).handle);
+
+	// deferred releases are linked when their frame completes, those links have to reach the replica too
+	REQUIRE(Handle_Manager32ReleaseDeferred(manager, handles[5], 0));
+	REQUIRE(Handle_Manager32ReleaseDeferred(manager, handles[6], 0));
+	SyncReplica32(manager, replica);
+	Handle_Manager32AdvanceFrame(manager, 0);
+	SyncReplica32(manager, replica);
+	for (int i = 0; i < AllocationBlockSize; ++i) {
+		REQUIRE(Handle_Manager32Alloc(replica).handle == Handle_Manager32Alloc(manager).handle);
+	}
+
+	// a mismatched replica is refused
+	Handle_Manager32* other = Handle_Manager32CreateTracked(sizeof(uint64_t), AllocationBlockSize, 4, false);
+	LOGINFO("The next WARN is expected as we are testing a parameter mismatch");
+	REQUIRE(!Handle_Manager32ApplyDelta(other, delta, deltaSize));
+	REQUIRE(!Handle_Manager32ApplyDelta(replica, delta, 4));
+
+	MEMORY_FREE(delta);
+	Handle_Manager32Destroy(other);
+	Handle_Manager32Destroy(replica);
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Range alloc 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	Handle_Manager32* manager = Handle_Manager32Create(sizeof(Test), AllocationBlockSize, 8, false);
+	REQUIRE(manager);
+
+	Handle_Handle32 first;
+	REQUIRE(Handle_Manager32AllocRange(manager, 5, &first));
+	Test* span = (Test*)Handle_Manager32HandleToPtr(manager, first);
+	for (uint32_t i = 0; i < 5; ++i) {
+		Handle_Handle32 handle = Handle_Manager32RangeHandle(first, i);
+		REQUIRE(Handle_Manager32IsValid(manager, handle));
+		REQUIRE(Handle_Manager32HandleToPtr(manager, handle) == span + i);
+	}
+
+	// the next range follows on in the same block
+	Handle_Handle32 second;
+	REQUIRE(Handle_Manager32AllocRange(manager, 5, &second));
+	REQUIRE(Handle_HandleDistance32(first, second) == 5);
+	uint32_t const total = Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated);
+	// this doesn't fit in what's left so needs a block of its own
+	Handle_Handle32 third;
+	REQUIRE(Handle_Manager32AllocRange(manager, AllocationBlockSize, &third));
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) == total + AllocationBlockSize);
+	LOGINFO("The next WARN is expected as we are testing a range bigger than a block");
+	Handle_Handle32 tooBig;
+	REQUIRE(!Handle_Manager32AllocRange(manager, AllocationBlockSize + 1, &tooBig));
+
+	// elements can go on their own or as the rest of the range
+	Handle_Manager32Release(manager, Handle_Manager32RangeHandle(second, 0));
+	Handle_Manager32ReleaseRange(manager, Handle_Manager32RangeHandle(second, 1), 4);
+	Handle_Manager32ReleaseRange(manager, first, 5);
+	for (uint32_t i = 0; i < 5; ++i) {
+		REQUIRE(!Handle_Manager32IsValid(manager, Handle_Manager32RangeHandle(first, i)));
+		REQUIRE(!Handle_Manager32IsValid(manager, Handle_Manager32RangeHandle(second, i)));
+	}
+	for (uint32_t i = 0; i < AllocationBlockSize; ++i) {
+		REQUIRE(Handle_Manager32IsValid(manager, Handle_Manager32RangeHandle(third, i)));
+	}
+
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Range reuse 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	static const int MaxBlocks = 8;
+	static const uint32_t RangeSize = 12;
+	Handle_Manager32* manager = Handle_Manager32Create(64, AllocationBlockSize, MaxBlocks, false);
+	REQUIRE(manager);
+
+	// released ranges are reused whole, so this never needs a second block
+	for (int i = 0; i < MaxBlocks * 100; ++i) {
+		Handle_Handle32 first;
+		REQUIRE(Handle_Manager32AllocRange(manager, RangeSize, &first));
+		for (uint32_t j = 0; j < RangeSize; ++j) {
+			REQUIRE(Handle_Manager32IsValid(manager, Handle_Manager32RangeHandle(first, j)));
+		}
+		Handle_Manager32ReleaseRange(manager, first, RangeSize);
+		REQUIRE(!Handle_Manager32IsValid(manager, first));
+	}
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) == AllocationBlockSize);
+
+	// a shorter range splits a released one
+	Handle_Handle32 a;
+	Handle_Handle32 b;
+	REQUIRE(Handle_Manager32AllocRange(manager, RangeSize, &a));
+	Handle_Manager32ReleaseRange(manager, a, RangeSize);
+	REQUIRE(Handle_Manager32AllocRange(manager, 5, &a));
+	REQUIRE(Handle_Manager32AllocRange(manager, 5, &b));
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) == AllocationBlockSize);
+	Handle_Manager32ReleaseRange(manager, a, 5);
+	Handle_Manager32ReleaseRange(manager, b, 5);
+
+	// after a Reset ranges come from the slots waiting to be reissued (the
+	// split runs aren't joined back up so this one needs a new block)
+	Handle_Handle32 stale;
+	REQUIRE(Handle_Manager32AllocRange(manager, RangeSize, &stale));
+	uint32_t const total = Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated);
+	Handle_Manager32Reset(manager);
+	for (int i = 0; i < MaxBlocks * 100; ++i) {
+		Handle_Handle32 first;
+		REQUIRE(Handle_Manager32AllocRange(manager, RangeSize, &first));
+		for (uint32_t j = 0; j < RangeSize; ++j) {
+			REQUIRE(Handle_Manager32IsValid(manager, Handle_Manager32RangeHandle(first, j)));
+			REQUIRE(!Handle_Manager32IsValid(manager, Handle_Manager32RangeHandle(stale, j)));
+		}
+		Handle_Manager32ReleaseRange(manager, first, RangeSize);
+	}
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) == total);
+
+	// single allocs get the released runs back before making new blocks, so
+	// every slot of every block can still be handed out
+	static const int Capacity = AllocationBlockSize * MaxBlocks;
+	Handle_Handle32 handles[Capacity];
+	for (int i = 0; i < Capacity; ++i) {
+		handles[i] = Handle_Manager32Alloc(manager);
+		REQUIRE(Handle_Manager32IsValid(manager, handles[i]));
+	}
+	for (int i = 0; i < Capacity; ++i) {
+		Handle_Manager32Release(manager, handles[i]);
+	}
+
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Single threaded 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	static const int Count = AllocationBlockSize * 3;
+	Handle_Manager32* manager = Handle_Manager32CreateSingleThreaded(sizeof(Test), AllocationBlockSize, 4, false);
+	REQUIRE(manager);
+	Handle_Manager32* reference = Handle_Manager32Create(sizeof(Test), AllocationBlockSize, 4, false);
+	REQUIRE(reference);
+
+	// same handles as the atomic version for the same calls
+	Handle_Handle32 handles[Count];
+	for (int pass = 0; pass < 3; ++pass) {
+		for (int i = 0; i < Count; ++i) {
+			handles[i] = Handle_Manager32Alloc(manager);
+			REQUIRE(handles[i].handle == Handle_Manager32Alloc(reference).handle);
+			REQUIRE(Handle_Manager32IsValid(manager, handles[i]));
+		}
+		for (int i = 0; i < Count; ++i) {
+			Handle_Manager32Release(manager, handles[i]);
+			Handle_Manager32Release(reference, handles[i]);
+			REQUIRE(!Handle_Manager32IsValid(manager, handles[i]));
+		}
+	}
+
+	Handle_Manager32Destroy(reference);
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Single threaded 64", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	static const int Count = AllocationBlockSize * 3;
+	Handle_Manager64* manager = Handle_Manager64CreateEx(sizeof(Test),
+			AllocationBlockSize,
+			4,
+			false,
+			Handle_NumaNodeNone,
+			Handle_Manager64FlagSingleThreaded);
+	REQUIRE(manager);
+	Handle_Manager64* reference = Handle_Manager64Create(sizeof(Test), AllocationBlockSize, 4, false);
+	REQUIRE(reference);
+
+	Handle_Handle64 handles[Count];
+	for (int pass = 0; pass < 3; ++pass) {
+		for (int i = 0; i < Count; ++i) {
+			handles[i] = Handle_Manager64Alloc(manager);
+			REQUIRE(handles[i].handle == Handle_Manager64Alloc(reference).handle);
+			REQUIRE(Handle_Manager64IsValid(manager, handles[i]));
+		}
+		for (int i = 0; i < Count; ++i) {
+			Handle_Manager64Release(manager, handles[i]);
+			Handle_Manager64Release(reference, handles[i]);
+			REQUIRE(!Handle_Manager64IsValid(manager, handles[i]));
+		}
+	}
+	Handle_Manager64SetOwner(manager);
+
+	Handle_Manager64Destroy(reference);
+	Handle_Manager64Destroy(manager);
+}
+
+TEST_CASE("Lazy free list", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 64;
+	Handle_Manager32* manager32 = Handle_Manager32Create(sizeof(Test), AllocationBlockSize, 4, true);
+	Handle_Manager64* manager64 = Handle_Manager64Create(sizeof(Test), AllocationBlockSize, 4, false);
+	REQUIRE(manager32);
+	REQUIRE(manager64);
+
+	// creating writes no links, the elements are still as calloc left them
+	uint8_t const* base32 = Handle_Manager32BlockBase(manager32, 0);
+	uint8_t const* base64 = (uint8_t const*)Thread_AtomicLoadPtrRelaxed(&manager64->blocks[0]);
+	for (size_t i = 0; i < AllocationBlockSize * sizeof(Test); ++i) {
+		REQUIRE(base32[i] == 0);
+		REQUIRE(base64[i] == 0);
+	}
+
+	// fresh slots come out in index order across blocks
+	static const int Count = AllocationBlockSize + 8;
+	Handle_Handle32 handles32[Count];
+	Handle_Handle64 handles64[Count];
+	for (int i = 0; i < Count; ++i) {
+		handles32[i] = Handle_Manager32Alloc(manager32);
+		handles64[i] = Handle_Manager64Alloc(manager64);
+		REQUIRE((handles32[i].handle & Handle_MaxHandles32) == (uint32_t)i);
+		REQUIRE((handles64[i].handle & Handle_MaxHandles64) == (uint64_t)i);
+		REQUIRE(Handle_Manager32IsValid(manager32, handles32[i]));
+		REQUIRE(Handle_Manager64IsValid(manager64, handles64[i]));
+	}
+
+	// released ones are only reused once the fresh run is used up
+	Handle_Manager32Release(manager32, handles32[3]);
+	Handle_Manager64Release(manager64, handles64[3]);
+	Handle_Handle32 next32 = Handle_Manager32Alloc(manager32);
+	Handle_Handle64 next64 = Handle_Manager64Alloc(manager64);
+	REQUIRE((next32.handle & Handle_MaxHandles32) == Count);
+	REQUIRE((next64.handle & Handle_MaxHandles64) == Count);
+	for (int i = Count + 1; i < AllocationBlockSize * 2; ++i) {
+		REQUIRE((Handle_Manager32Alloc(manager32).handle & Handle_MaxHandles32) == (uint32_t)i);
+		REQUIRE((Handle_Manager64Alloc(manager64).handle & Handle_MaxHandles64) == (uint64_t)i);
+	}
+	Handle_Handle32 reused32 = Handle_Manager32Alloc(manager32);
+	Handle_Handle64 reused64 = Handle_Manager64Alloc(manager64);
+	REQUIRE((reused32.handle & Handle_MaxHandles32) == 3);
+	REQUIRE((reused64.handle & Handle_MaxHandles64) == 3);
+	REQUIRE(reused32.handle != handles32[3].handle);
+	REQUIRE(reused64.handle != handles64[3].handle);
+
+	Handle_Manager32Destroy(manager32);
+	Handle_Manager64Destroy(manager64);
+}
+
+TEST_CASE("Ptr to handle 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	static const int Count = AllocationBlockSize * 7;
+	Handle_Manager32* managers[2] = {
+			Handle_Manager32Create(sizeof(Test), AllocationBlockSize, 8, false),
+			Handle_Manager32CreateGeometric(sizeof(Test), AllocationBlockSize, 4, false),
+	};
+	for (Handle_Manager32* manager : managers) {
+		REQUIRE(manager);
+		Handle_Handle32 handles[Count];
+		for (int i = 0; i < Count; ++i) {
+			handles[i] = Handle_Manager32Alloc(manager);
+			REQUIRE(handles[i].handle != 0);
+		}
+		// reissue some so the generations differ
+		for (int i = 0; i < Count; i += 3) {
+			Handle_Manager32Release(manager, handles[i]);
+			handles[i] = Handle_Manager32Alloc(manager);
+		}
+		for (int i = 0; i < Count; ++i) {
+			Test* element = (Test*)Handle_Manager32HandleToPtrAny(manager, handles[i]);
+			REQUIRE(Handle_Manager32PtrToHandle(manager, element).handle == handles[i].handle);
+			// any address inside the element
+			REQUIRE(Handle_Manager32PtrToHandle(manager, (uint8_t*)element + sizeof(Test) - 1).handle == handles[i].handle);
+		}
+		Test notInAManager;
+		REQUIRE(Handle_Manager32PtrToHandle(manager, &notInAManager).handle == 0);
+
+		// a clone's own blocks are indexed
+		Handle_Manager32* clone = Handle_Manager32Clone(manager);
+		REQUIRE(clone);
+		for (int i = 0; i < Count; ++i) {
+			void* element = Handle_Manager32HandleToPtrAny(clone, handles[i]);
+			REQUIRE(Handle_Manager32PtrToHandle(clone, element).handle == handles[i].handle);
+		}
+		Handle_Manager32Destroy(clone);
+		Handle_Manager32Destroy(manager);
+	}
+}
+
+TEST_CASE("Ptr to handle 64", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	static const int Count = AllocationBlockSize * 5;
+	Handle_Manager64* manager = Handle_Manager64Create(sizeof(Test), AllocationBlockSize, 8, false);
+	REQUIRE(manager);
+
+	Handle_Handle64 handles[Count];
+	for (int i = 0; i < Count; ++i) {
+		handles[i] = Handle_Manager64Alloc(manager);
+		REQUIRE(handles[i].handle != 0);
+	}
+	for (int i = 0; i < Count; ++i) {
+		Test* element = (Test*)Handle_Manager64HandleToPtr(manager, handles[i]);
+		REQUIRE(Handle_Manager64PtrToHandle(manager, element).handle == handles[i].handle);
+		REQUIRE(Handle_Manager64PtrToHandle(manager, (uint8_t*)element + 1).handle == handles[i].handle);
+	}
+	// released slots know they are free
+	Test* released = (Test*)Handle_Manager64HandleToPtr(manager, handles[7]);
+	Handle_Manager64Release(manager, handles[7]);
+	REQUIRE(Handle_Manager64PtrToHandle(manager, released).handle == 0);
+	Test notInAManager;
+	REQUIRE(Handle_Manager64PtrToHandle(manager, &notInAManager).handle == 0);
+
+	Handle_Manager64Destroy(manager);
+}
+
+TEST_CASE("NUMA placement 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	Handle_Manager32* manager = Handle_Manager32CreateNuma(sizeof(Test), AllocationBlockSize, 4, false, Handle_NumaNodeLocal);
+	REQUIRE(manager);
+
+	for(int i =0 ; i < AllocationBlockSize * 4;++i) {
+		Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+		REQUIRE(Handle_Manager32IsValid(manager, handle));
+	}
+
+	// every block is somewhere, single node machines don't place them at all
+	uint32_t totalBlocks = Handle_Manager32NumaBlockCount(manager, Handle_NumaBlockNodeNone);
+	for(uint32_t i = 0; i < Handle_NumaNodeCount(); ++i) {
+		totalBlocks += Handle_Manager32NumaBlockCount(manager, i);
+	}
+	REQUIRE(totalBlocks == 4);
+
+	Handle_Manager32* clone = Handle_Manager32Clone(manager);
+	REQUIRE(clone);
+	Handle_Manager32Destroy(clone);
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("NUMA placement 64", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	Handle_Manager64* manager = Handle_Manager64CreateNuma(sizeof(Test), AllocationBlockSize, 4, false, 0);
+	REQUIRE(manager);
+
+	for(int i =0 ; i < AllocationBlockSize * 4;++i) {
+		Handle_Handle64 handle = Handle_Manager64Alloc(manager);
+		REQUIRE(Handle_Manager64IsValid(manager, handle));
+	}
+	uint32_t const node = (Handle_NumaNodeCount() > 1) ? 0 : Handle_NumaBlockNodeNone;
+	REQUIRE(Handle_Manager64NumaBlockCount(manager, node) == 4);
+
+	Handle_Manager64Destroy(manager);
+}
+
+TEST_CASE("Deferred frame release 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	Handle_Manager32* manager = Handle_Manager32Create(sizeof(uint64_t), AllocationBlockSize, 1, false);
+	REQUIRE(manager);
+
+	Handle_Handle32 handles[AllocationBlockSize];
+	uint64_t* elements[AllocationBlockSize];
+	for(int i =0 ; i < AllocationBlockSize;++i) {
+		handles[i] = Handle_Manager32Alloc(manager);
+		elements[i] = (uint64_t*)Handle_Manager32HandleToPtr(manager, handles[i]);
+		*elements[i] = 0xDEADBEEFDEADBEEFull;
+	}
+	// too far ahead is refused and the handle left alone
+	SimpleLogManager_SetWarningQuiet(logger, true);
+	REQUIRE(!Handle_Manager32ReleaseDeferred(manager, handles[0], Handle_MaxDeferredFrames32));
+	SimpleLogManager_SetWarningQuiet(logger, false);
+	REQUIRE(Handle_Manager32IsValid(manager, handles[0]));
+
+	// frame 0 holds the first half, frame 1 the second
+	for(int i =0 ; i < AllocationBlockSize;++i) {
+		REQUIRE(Handle_Manager32ReleaseDeferred(manager, handles[i], i < AllocationBlockSize / 2 ? 0 : 1));
+		REQUIRE(!Handle_Manager32IsValid(manager, handles[i]));
+	}
+	// nothing is free until a frame completes and the elements can still be read
+	SimpleLogManager_SetWarningQuiet(logger, true);
+	REQUIRE(Handle_Manager32Alloc(manager).handle == 0);
+	SimpleLogManager_SetWarningQuiet(logger, false);
+	for(int i =0 ; i < AllocationBlockSize;++i) {
+		REQUIRE(*elements[i] == 0xDEADBEEFDEADBEEFull);
+	}
+
+	Handle_Manager32AdvanceFrame(manager, 0);
+	for(int i =0 ; i < AllocationBlockSize / 2;++i) {
+		Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+		REQUIRE(handle.handle != 0);
+		REQUIRE((handle.handle & Handle_MaxHandles32) < AllocationBlockSize / 2);
+	}
+	SimpleLogManager_SetWarningQuiet(logger, true);
+	REQUIRE(Handle_Manager32Alloc(manager).handle == 0);
+	SimpleLogManager_SetWarningQuiet(logger, false);
+
+	// already completed frames release straight away
+	Handle_Manager32AdvanceFrame(manager, 1);
+	Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+	REQUIRE(handle.handle != 0);
+	REQUIRE(Handle_Manager32ReleaseDeferred(manager, handle, 1));
+	REQUIRE(Handle_Manager32Alloc(manager).handle != 0);
+
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Init policy 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	Handle_Manager32* manager = Handle_Manager32Create(sizeof(Test), AllocationBlockSize, 1, false);
+	REQUIRE(manager);
+
+	// fill the block so each alloc below reuses the slot just released
+	Handle_Handle32 handles[AllocationBlockSize];
+	for (int i = 0; i < AllocationBlockSize; ++i) {
+		handles[i] = Handle_Manager32Alloc(manager);
+		FillTest((Test*)Handle_Manager32HandleToPtr(manager, handles[i]));
+	}
+
+	// none leaves the old contents (bar the free list link at the front)
+	Handle_Manager32SetInitPolicy(manager, Handle_InitPolicyNone, NULL, NULL);
+	Handle_Manager32Release(manager, handles[1]);
+	handles[1] = Handle_Manager32Alloc(manager);
+	Test* test = (Test*)Handle_Manager32HandleToPtr(manager, handles[1]);
+	REQUIRE(test->data[255] == 255);
+
+	// the callback gets each element
+	int callCount = 0;
+	Handle_Manager32SetInitPolicy(manager, Handle_InitPolicyCallback, &MarkTest, &callCount);
+	Handle_Manager32Release(manager, handles[2]);
+	handles[2] = Handle_Manager32Alloc(manager);
+	test = (Test*)Handle_Manager32HandleToPtr(manager, handles[2]);
+	REQUIRE(callCount == 1);
+	REQUIRE(test->data[0] == 0xAB);
+	REQUIRE(test->data[255] == 0xAB);
+
+	// streaming zero is still zero
+	Handle_Manager32SetInitPolicy(manager, Handle_InitPolicyStreamZero, NULL, NULL);
+	Handle_Manager32Release(manager, handles[3]);
+	handles[3] = Handle_Manager32Alloc(manager);
+	test = (Test*)Handle_Manager32HandleToPtr(manager, handles[3]);
+	for (int i = 0; i < 256; ++i) {
+		REQUIRE(test->data[i] == 0);
+	}
+
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Batch alloc 32", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	Handle_Manager32* manager = Handle_Manager32Create(sizeof(Test), AllocationBlockSize, 2, false);
+	REQUIRE(manager);
+	Handle_Manager32SetInitPolicy(manager, Handle_InitPolicyStreamZero, NULL, NULL);
+
+	Handle_Handle32 handles[AllocationBlockSize * 2];
+	REQUIRE(Handle_Manager32AllocBatch(manager, handles, AllocationBlockSize) == AllocationBlockSize);
+	for (int i = 0; i < AllocationBlockSize; ++i) {
+		Test* test = (Test*)Handle_Manager32HandleToPtr(manager, handles[i]);
+		REQUIRE(test->data[255] == 0);
+		FillTest(test);
+	}
+	for (int i = 0; i < AllocationBlockSize; i += 2) {
+		Handle_Manager32Release(manager, handles[i]);
+	}
+
+	// reused and fresh slots, stopping when it runs out
+	SimpleLogManager_SetWarningQuiet(logger, true);
+	uint32_t const count = Handle_Manager32AllocBatch(manager, handles, AllocationBlockSize * 2);
+	SimpleLogManager_SetWarningQuiet(logger, false);
+	REQUIRE(count == AllocationBlockSize + AllocationBlockSize / 2);
+	for (uint32_t i = 0; i < count; ++i) {
+		REQUIRE(Handle_Manager32IsValid(manager, handles[i]));
+		Test* test = (Test*)Handle_Manager32HandleToPtr(manager, handles[i]);
+		for (int j = 0; j < 256; ++j) {
+			REQUIRE(test->data[j] == 0);
+		}
+	}
+
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Batch alloc 64", "[al2o3 handle]") {
+	static const int AllocationBlockSize = 16;
+	Handle_Manager64* manager = Handle_Manager64Create(sizeof(Test), AllocationBlockSize, 4, false);
+	REQUIRE(manager);
+
+	int callCount = 0;
+	Handle_Manager64SetInitPolicy(manager, Handle_InitPolicyCallback, &FillTestInit, &callCount);
+
+	Handle_Handle64 handles[AllocationBlockSize * 3];
+	REQUIRE(Handle_Manager64AllocBatch(manager, handles, AllocationBlockSize * 3) == AllocationBlockSize * 3);
+	REQUIRE(callCount == AllocationBlockSize * 3);
+	for (int i = 0; i < AllocationBlockSize * 3; ++i) {
+		REQUIRE(Handle_Manager64IsValid(manager, handles[i]));
+		Test* test = (Test*)Handle_Manager64HandleToPtr(manager, handles[i]);
+		REQUIRE(test->data[100] == 100);
+	}
+
+	Handle_Manager64Destroy(manager);
+}
+
+TEST_CASE("SeqLock basic 64", "[al2o3 handle]") {
+	Handle_Manager64* manager = Handle_Manager64CreateEx(sizeof(Test), 16, 4, false, Handle_NumaNodeNone, Handle_Manager64FlagSeqLock);
+	REQUIRE(manager);
+
+	Handle_Handle64 handle = Handle_Manager64Alloc(manager);
+	Handle_Manager64BeginWrite(manager, handle);
+	Test* test = (Test*)Handle_Manager64HandleToPtr(manager, handle);
+	FillTest(test);
+	Handle_Manager64EndWrite(manager, handle);
+
+	Test copy;
+	REQUIRE(Handle_Manager64ReadConsistent(manager, handle, &copy, sizeof(Test)));
+	for (int i = 0; i < 256; ++i) {
+		REQUIRE(copy.data[i] == (uint8_t)i);
+	}
+	REQUIRE(Thread_AtomicLoad32Relaxed(Handle_Manager64HandleToSequence(manager, handle)) == 2);
+
+	Handle_Manager64* clone = Handle_Manager64Clone(manager);
+	REQUIRE(clone);
+	REQUIRE(clone->seqLocked);
+	REQUIRE(Handle_Manager64ReadConsistent(clone, handle, &copy, sizeof(Test)));
+	REQUIRE(copy.data[255] == 255);
+	Handle_Manager64Destroy(clone);
+
+	Handle_Manager64Release(manager, handle);
+	REQUIRE(!Handle_Manager64ReadConsistent(manager, handle, &copy, sizeof(Test)));
+
+	Handle_Manager64Destroy(manager);
+}
+
+
 //------------------ Advanced tests -------------------//
 
 static Thread_Atomic64_t leaked = {0};
@@ -481,3 +1258,133 @@ TEST_CASE("Generation overflow stats 64 never reissue old handles", "[al2o3 hand
 
 	Handle_Manager64Destroy(manager);
 }
+
+namespace {
+struct SeqLockTestData {
+	Handle_Manager64* manager;
+	Handle_Handle64 handle;
+	Thread_Atomic32_t done;
+	Thread_Atomic32_t torn;
+	Thread_Atomic32_t reads;
+};
+struct SeqLockElement {
+	uint64_t values[8];
+};
+}
+
+static void SeqLockReaderFunc(void* userPtr) {
+	SeqLockTestData* data = (SeqLockTestData*) userPtr;
+	while(Thread_AtomicLoad32Relaxed(&data->done) == 0) {
+		SeqLockElement copy;
+		if(!Handle_Manager64ReadConsistent(data->manager, data->handle, &copy, sizeof(SeqLockElement))) {
+			Thread_AtomicFetchAdd32Relaxed(&data->torn, 1);
+			continue;
+		}
+		// the writer always fills every value with the same number
+		for(auto i = 1u; i < 8; ++i) {
+			if(copy.values[i] != copy.values[0]) {
+				Thread_AtomicFetchAdd32Relaxed(&data->torn, 1);
+				break;
+			}
+		}
+		Thread_AtomicFetchAdd32Relaxed(&data->reads, 1);
+	}
+}
+
+TEST_CASE("SeqLock Multithreaded 64", "[al2o3 handle]") {
+	static const uint32_t numThreads = 4;
+	SeqLockTestData data;
+	data.manager = Handle_Manager64CreateEx(sizeof(SeqLockElement), 16, 1, false, Handle_NumaNodeNone, Handle_Manager64FlagSeqLock);
+	REQUIRE(data.manager);
+	data.handle = Handle_Manager64Alloc(data.manager);
+	Thread_AtomicStore32Relaxed(&data.done, 0);
+	Thread_AtomicStore32Relaxed(&data.torn, 0);
+	Thread_AtomicStore32Relaxed(&data.reads, 0);
+
+	Thread_Thread * threads = (Thread_Thread *)STACK_ALLOC(sizeof(Thread_Thread) * numThreads);
+	for (auto i = 0u; i < numThreads; ++i) {
+		Thread_ThreadCreate(threads + i, &SeqLockReaderFunc, &data);
+	}
+
+	SeqLockElement* element = (SeqLockElement*) Handle_Manager64HandleToPtr(data.manager, data.handle);
+	for(uint64_t i = 0; i < 1000000ull; ++i) {
+		Handle_Manager64BeginWrite(data.manager, data.handle);
+		for(auto j = 0u; j < 8; ++j) {
+			element->values[j] = i;
+		}
+		Handle_Manager64EndWrite(data.manager, data.handle);
+	}
+	Thread_AtomicStore32Relaxed(&data.done, 1);
+
+	for (auto i = 0u; i < numThreads; ++i) {
+		Thread_ThreadJoin(threads + i);
+		Thread_ThreadDestroy(threads + i);
+	}
+	LOGINFO("%u consistent reads", Thread_AtomicLoad32Relaxed(&data.reads));
+	REQUIRE(Thread_AtomicLoad32Relaxed(&data.torn) == 0);
+
+	Handle_Manager64Destroy(data.manager);
+}
+
+namespace {
+struct OwnedTestData {
+	Handle_Manager32* manager;
+	Handle_Handle32* handles;
+	uint32_t first;
+	uint32_t count;
+};
+}
+
+static void OwnedRemoteReleaseFunc(void* userPtr) {
+	OwnedTestData* data = (OwnedTestData*) userPtr;
+	for(uint32_t i = data->first; i < data->first + data->count; ++i) {
+		Handle_Manager32Release(data->manager, data->handles[i]);
+	}
+}
+
+TEST_CASE("Owned remote release 32", "[al2o3 handle]") {
+	static const uint32_t numThreads = 2;
+	static const uint32_t AllocationBlockSize = 16;
+	static const uint32_t Count = AllocationBlockSize * 4;
+	Handle_Manager32* manager = Handle_Manager32CreateOwned(sizeof(uint64_t), AllocationBlockSize, 4, false);
+	REQUIRE(manager);
+
+	// the owner reuses its own releases
+	Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+	Handle_Manager32Release(manager, handle);
+	REQUIRE(!Handle_Manager32IsValid(manager, handle));
+
+	Handle_Handle32 handles[Count];
+	for(uint32_t i = 0; i < Count; ++i) {
+		handles[i] = Handle_Manager32Alloc(manager);
+		REQUIRE(handles[i].handle != 0);
+	}
+	uint32_t const total = Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated);
+
+	OwnedTestData data[numThreads];
+	Thread_Thread threads[numThreads];
+	for (auto i = 0u; i < numThreads; ++i) {
+		data[i] = { manager, handles, i * (Count / numThreads), Count / numThreads };
+		Thread_ThreadCreate(threads + i, &OwnedRemoteReleaseFunc, data + i);
+	}
+	for (auto i = 0u; i < numThreads; ++i) {
+		Thread_ThreadJoin(threads + i);
+		Thread_ThreadDestroy(threads + i);
+	}
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->remoteFreeHead) != 0);
+
+	// the owner drains the remote releases rather than growing
+	bool seen[Count] = {};
+	for(uint32_t i = 0; i < Count; ++i) {
+		handles[i] = Handle_Manager32Alloc(manager);
+		REQUIRE(handles[i].handle != 0);
+		uint32_t const index = handles[i].handle & Handle_MaxHandles32;
+		REQUIRE(index < Count);
+		REQUIRE(!seen[index]);
+		seen[index] = true;
+	}
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) == total);
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->remoteFreeHead) == 0);
+
+	Handle_Manager32Destroy(manager);
+}
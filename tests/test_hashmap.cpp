@@ -0,0 +1,101 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/handle.h"
+#include "al2o3_handle/hashmap.h"
+
+TEST_CASE("Basic tests HashMap", "[al2o3 handle hashmap]") {
+	Handle_HashMap *map = Handle_HashMapCreate(sizeof(uint32_t), 0);
+	REQUIRE(map);
+
+	Handle_Handle32 key = {0x01000000};
+	REQUIRE(Handle_HashMapLookup32(map, key) == NULL);
+	uint32_t *value = (uint32_t *) Handle_HashMapInsert32(map, key);
+	REQUIRE(value);
+	REQUIRE(*value == 0);
+	*value = 42;
+	REQUIRE(Handle_HashMapCount(map) == 1);
+	REQUIRE(*(uint32_t *) Handle_HashMapLookup32(map, key) == 42);
+	// inserting an existing key returns the existing value
+	REQUIRE(*(uint32_t *) Handle_HashMapInsert32(map, key) == 42);
+
+	REQUIRE(Handle_HashMapRemove32(map, key));
+	REQUIRE(!Handle_HashMapRemove32(map, key));
+	REQUIRE(Handle_HashMapLookup32(map, key) == NULL);
+	REQUIRE(Handle_HashMapCount(map) == 0);
+
+	Handle_HashMapDestroy(map);
+}
+
+TEST_CASE("Stale generation HashMap", "[al2o3 handle hashmap]") {
+	Handle_HashMap *map = Handle_HashMapCreate(sizeof(uint32_t), 16);
+	REQUIRE(map);
+
+	Handle_Handle32 oldKey = {(1u << Handle_GenerationBitShift32) | 5};
+	Handle_Handle32 newKey = {(2u << Handle_GenerationBitShift32) | 5};
+	*(uint32_t *) Handle_HashMapInsert32(map, oldKey) = 1;
+	REQUIRE(Handle_HashMapLookup32(map, newKey) == NULL);
+
+	// same index new generation reuses the dead entry
+	uint32_t *value = (uint32_t *) Handle_HashMapInsert32(map, newKey);
+	REQUIRE(*value == 0);
+	*value = 2;
+	REQUIRE(Handle_HashMapCount(map) == 1);
+	REQUIRE(Handle_HashMapLookup32(map, oldKey) == NULL);
+	REQUIRE(*(uint32_t *) Handle_HashMapLookup32(map, newKey) == 2);
+
+	Handle_HashMapDestroy(map);
+}
+
+TEST_CASE("Growth and removal HashMap 64", "[al2o3 handle hashmap]") {
+	static const uint64_t Count = 10000;
+	Handle_HashMap *map = Handle_HashMapCreate(sizeof(uint64_t), 0);
+	REQUIRE(map);
+
+	for (uint64_t i = 1; i <= Count; ++i) {
+		// stride the indices so they alias in the table
+		Handle_Handle64 key = {(i * 61) | (1ull << Handle_GenerationBitShift64)};
+		*(uint64_t *) Handle_HashMapInsert64(map, key) = i;
+	}
+	REQUIRE(Handle_HashMapCount(map) == Count);
+
+	for (uint64_t i = 1; i <= Count; i += 2) {
+		Handle_Handle64 key = {(i * 61) | (1ull << Handle_GenerationBitShift64)};
+		REQUIRE(Handle_HashMapRemove64(map, key));
+	}
+	for (uint64_t i = 1; i <= Count; ++i) {
+		Handle_Handle64 key = {(i * 61) | (1ull << Handle_GenerationBitShift64)};
+		uint64_t *value = (uint64_t *) Handle_HashMapLookup64(map, key);
+		if (i & 0x1) {
+			REQUIRE(value == NULL);
+		} else {
+			REQUIRE(value);
+			REQUIRE(*value == i);
+		}
+	}
+
+	Handle_HashMapDestroy(map);
+}
+
+TEST_CASE("Purge HashMap", "[al2o3 handle hashmap]") {
+	Handle_Manager32 *manager = Handle_Manager32Create(sizeof(uint32_t), 16, 4, false);
+	REQUIRE(manager);
+	Handle_HashMap *map = Handle_HashMapCreate(sizeof(uint32_t), 16);
+	REQUIRE(map);
+
+	Handle_Handle32 handles[32];
+	for (int i = 0; i < 32; ++i) {
+		handles[i] = Handle_Manager32Alloc(manager);
+		*(uint32_t *) Handle_HashMapInsert32(map, handles[i]) = i;
+	}
+	for (int i = 0; i < 32; i += 4) {
+		Handle_Manager32Release(manager, handles[i]);
+	}
+	REQUIRE(Handle_HashMapPurge32(map, manager) == 8);
+	REQUIRE(Handle_HashMapCount(map) == 24);
+	REQUIRE(Handle_HashMapLookup32(map, handles[0]) == NULL);
+	REQUIRE(*(uint32_t *) Handle_HashMapLookup32(map, handles[1]) == 1);
+
+	Handle_HashMapDestroy(map);
+	Handle_Manager32Destroy(manager);
+}
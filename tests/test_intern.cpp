@@ -0,0 +1,141 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_thread/thread.h"
+#include "al2o3_handle/intern.h"
+
+#include <stdio.h>
+#include <string.h>
+
+TEST_CASE("Basic tests Intern", "[al2o3 handle intern]") {
+	Handle_InternTable *table = Handle_InternTableCreate(64, 64, 4, false);
+	REQUIRE(table);
+
+	Handle_Handle32 a = Handle_InternTableInternString(table, "textures/rock.dds");
+	Handle_Handle32 b = Handle_InternTableInternString(table, "rock");
+	Handle_Handle32 empty = Handle_InternTableIntern(table, NULL, 0);
+	REQUIRE(a.handle != 0);
+	REQUIRE(b.handle != 0);
+	REQUIRE(empty.handle != 0);
+	REQUIRE(a.handle != b.handle);
+	REQUIRE(Handle_InternTableCount(table) == 3);
+
+	// same content same handle, whether inline or in a blob
+	char path[] = "textures/rock.dds";
+	REQUIRE(Handle_InternTableInternString(table, path).handle == a.handle);
+	REQUIRE(Handle_InternTableInternString(table, "rock").handle == b.handle);
+	REQUIRE(Handle_InternTableFind(table, "rock", 4).handle == b.handle);
+	REQUIRE(Handle_InternTableFind(table, "rocks", 5).handle == 0);
+	REQUIRE(Handle_InternTableCount(table) == 3);
+
+	size_t size = 0;
+	char const *bytes = (char const *) Handle_InternTableResolve(table, a, &size);
+	REQUIRE(size == strlen(path));
+	REQUIRE(memcmp(bytes, path, size) == 0);
+	bytes = (char const *) Handle_InternTableResolve(table, b, &size);
+	REQUIRE(size == 4);
+	REQUIRE(memcmp(bytes, "rock", 4) == 0);
+
+	// released ids go stale and the content can be interned again
+	REQUIRE(Handle_InternTableRelease(table, a));
+	REQUIRE(!Handle_InternTableRelease(table, a));
+	REQUIRE(!Handle_InternTableIsValid(table, a));
+	REQUIRE(Handle_InternTableResolve(table, a, &size) == NULL);
+	REQUIRE(Handle_InternTableFind(table, path, strlen(path)).handle == 0);
+	Handle_Handle32 again = Handle_InternTableInternString(table, path);
+	REQUIRE(again.handle != 0);
+	REQUIRE(again.handle != a.handle);
+	REQUIRE(Handle_InternTableIsValid(table, b));
+
+	Handle_InternTableDestroy(table);
+}
+
+TEST_CASE("Intern grow", "[al2o3 handle intern]") {
+	static const int Count = 4000;
+	Handle_InternTable *table = Handle_InternTableCreate(256, 64, 2, false);
+	REQUIRE(table);
+
+	Handle_Handle32 *handles = (Handle_Handle32 *) malloc(sizeof(Handle_Handle32) * Count);
+	char name[64];
+	for (int i = 0; i < Count; ++i) {
+		snprintf(name, sizeof(name), "%s/asset_%d", (i & 0x1) ? "meshes/characters" : "m", i);
+		handles[i] = Handle_InternTableInternString(table, name);
+		REQUIRE(handles[i].handle != 0);
+	}
+	REQUIRE(Handle_InternTableCount(table) == Count);
+
+	// the stripes have rehashed many times, everything is still found
+	for (int i = 0; i < Count; ++i) {
+		snprintf(name, sizeof(name), "%s/asset_%d", (i & 0x1) ? "meshes/characters" : "m", i);
+		REQUIRE(Handle_InternTableFind(table, name, strlen(name)).handle == handles[i].handle);
+		size_t size = 0;
+		void const *bytes = Handle_InternTableResolve(table, handles[i], &size);
+		REQUIRE(size == strlen(name));
+		REQUIRE(memcmp(bytes, name, size) == 0);
+	}
+	for (int i = 0; i < Count; i += 2) {
+		REQUIRE(Handle_InternTableRelease(table, handles[i]));
+	}
+	REQUIRE(Handle_InternTableCount(table) == Count / 2);
+	for (int i = 1; i < Count; i += 2) {
+		snprintf(name, sizeof(name), "meshes/characters/asset_%d", i);
+		REQUIRE(Handle_InternTableFind(table, name, strlen(name)).handle == handles[i].handle);
+	}
+
+	free(handles);
+	Handle_InternTableDestroy(table);
+}
+
+namespace {
+struct InternThreadData {
+	Handle_InternTable *table;
+	Handle_Handle32 *handles;
+	int count;
+	int start;
+};
+
+void InternThreadFunc(void *userData) {
+	InternThreadData *data = (InternThreadData *) userData;
+	char name[64];
+	// every thread interns the same names, starting at different points
+	for (int j = 0; j < data->count; ++j) {
+		int const i = (j + data->start) % data->count;
+		snprintf(name, sizeof(name), "shared/name_%d", i);
+		data->handles[i] = Handle_InternTableInternString(data->table, name);
+	}
+}
+}
+
+TEST_CASE("Intern multithreaded", "[al2o3 handle intern]") {
+	static const int ThreadCount = 4;
+	static const int Count = 1000;
+	Handle_InternTable *table = Handle_InternTableCreate(256, 64, 0, false);
+	REQUIRE(table);
+
+	Handle_Handle32 *handles = (Handle_Handle32 *) malloc(sizeof(Handle_Handle32) * Count * ThreadCount);
+	InternThreadData data[ThreadCount];
+	Thread_Thread threads[ThreadCount];
+	for (int i = 0; i < ThreadCount; ++i) {
+		data[i].table = table;
+		data[i].handles = handles + (i * Count);
+		data[i].count = Count;
+		data[i].start = (i * Count) / ThreadCount;
+		REQUIRE(Thread_ThreadCreate(&threads[i], &InternThreadFunc, &data[i]));
+	}
+	for (int i = 0; i < ThreadCount; ++i) {
+		Thread_ThreadJoin(&threads[i]);
+		Thread_ThreadDestroy(&threads[i]);
+	}
+
+	// racing inserts of the same content all got the one handle
+	REQUIRE(Handle_InternTableCount(table) == Count);
+	for (int i = 0; i < Count; ++i) {
+		REQUIRE(handles[i].handle != 0);
+		for (int t = 1; t < ThreadCount; ++t) {
+			REQUIRE(handles[(t * Count) + i].handle == handles[i].handle);
+		}
+	}
+
+	free(handles);
+	Handle_InternTableDestroy(table);
+}
@@ -0,0 +1,133 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/handle.h"
+#include "al2o3_handle/list.h"
+
+#include <stddef.h>
+
+namespace {
+struct Node {
+	uint64_t value;
+	Handle_ListLink32 link;
+	Handle_QueueLink32 queueLink;
+};
+
+Handle_Handle32 MakeNode(Handle_Manager32 *manager, uint64_t value) {
+	Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+	((Node *) Handle_Manager32HandleToPtr(manager, handle))->value = value;
+	return handle;
+}
+
+uint64_t NodeValue(Handle_Manager32 *manager, Handle_Handle32 handle) {
+	return ((Node *) Handle_Manager32HandleToPtr(manager, handle))->value;
+}
+}
+
+TEST_CASE("List basic tests", "[al2o3 handle list]") {
+	Handle_Manager32 *manager = Handle_Manager32Create(sizeof(Node), 16, 4, false);
+	REQUIRE(manager);
+	Handle_List32 list;
+	Handle_List32Init(&list, manager, offsetof(Node, link));
+	REQUIRE(Handle_List32IsEmpty(&list));
+
+	Handle_Handle32 n1 = MakeNode(manager, 1);
+	Handle_Handle32 n2 = MakeNode(manager, 2);
+	Handle_Handle32 n3 = MakeNode(manager, 3);
+	Handle_Handle32 n4 = MakeNode(manager, 4);
+
+	Handle_List32PushBack(&list, n2);
+	Handle_List32PushFront(&list, n1);
+	Handle_List32PushBack(&list, n4);
+	Handle_List32InsertBefore(&list, n4, n3);
+	REQUIRE(Handle_List32Count(&list) == 4);
+	REQUIRE(Handle_List32Validate(&list));
+
+	uint64_t expected = 1;
+	for (Handle_Handle32 it = Handle_List32Head(&list); it.handle; it = Handle_List32Next(&list, it)) {
+		REQUIRE(NodeValue(manager, it) == expected);
+		expected++;
+	}
+	REQUIRE(expected == 5);
+
+	Handle_List32Remove(&list, n2);
+	REQUIRE(Handle_List32Validate(&list));
+	REQUIRE(Handle_HandleEqual32(Handle_List32Next(&list, n1), n3));
+	REQUIRE(Handle_HandleEqual32(Handle_List32Prev(&list, n3), n1));
+
+	Handle_List32InsertAfter(&list, n1, n2);
+	REQUIRE(Handle_HandleEqual32(Handle_List32Next(&list, n1), n2));
+	REQUIRE(Handle_List32Validate(&list));
+
+	// deque usage
+	REQUIRE(Handle_HandleEqual32(Handle_List32PopFront(&list), n1));
+	REQUIRE(Handle_HandleEqual32(Handle_List32PopBack(&list), n4));
+	REQUIRE(Handle_HandleEqual32(Handle_List32PopBack(&list), n3));
+	REQUIRE(Handle_HandleEqual32(Handle_List32PopFront(&list), n2));
+	REQUIRE(Handle_List32IsEmpty(&list));
+	REQUIRE(Handle_List32PopFront(&list).handle == 0);
+	REQUIRE(Handle_List32Validate(&list));
+
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("List dangling link", "[al2o3 handle list]") {
+	Handle_Manager32 *manager = Handle_Manager32Create(sizeof(Node), 16, 4, false);
+	REQUIRE(manager);
+	Handle_List32 list;
+	Handle_List32Init(&list, manager, offsetof(Node, link));
+
+	Handle_Handle32 n1 = MakeNode(manager, 1);
+	Handle_Handle32 n2 = MakeNode(manager, 2);
+	Handle_List32PushBack(&list, n1);
+	Handle_List32PushBack(&list, n2);
+
+	// released without unlinking, the link is stale not a wild pointer
+	Handle_Manager32Release(manager, n2);
+	LOGINFO("The next WARN is expected as we are testing dangling link detection");
+	REQUIRE(Handle_List32Next(&list, n1).handle == 0);
+	REQUIRE(!Handle_List32Validate(&list));
+
+	Handle_Manager32Destroy(manager);
+}
+
+TEST_CASE("Queue tests", "[al2o3 handle list]") {
+	Handle_Manager32 *manager = Handle_Manager32Create(sizeof(Node), 16, 4, false);
+	REQUIRE(manager);
+	Handle_Queue32 queue;
+	Handle_Queue32Init(&queue, manager, offsetof(Node, queueLink));
+	Handle_List32 list;
+	Handle_List32Init(&list, manager, offsetof(Node, link));
+
+	for (uint64_t i = 0; i < 32; ++i) {
+		Handle_Handle32 node = MakeNode(manager, i);
+		Handle_Queue32Push(&queue, node);
+		// separate links so a node can be in both at once
+		Handle_List32PushFront(&list, node);
+	}
+	REQUIRE(Handle_Queue32Count(&queue) == 32);
+	REQUIRE(NodeValue(manager, Handle_Queue32Peek(&queue)) == 0);
+
+	for (uint64_t i = 0; i < 32; ++i) {
+		Handle_Handle32 node = Handle_Queue32Pop(&queue);
+		REQUIRE(NodeValue(manager, node) == i);
+		REQUIRE(Handle_HandleEqual32(Handle_List32PopBack(&list), node));
+	}
+	REQUIRE(Handle_Queue32IsEmpty(&queue));
+	REQUIRE(Handle_Queue32Pop(&queue).handle == 0);
+
+	// a node released whilst queued truncates the queue rather than becoming its head
+	Handle_Handle32 q1 = MakeNode(manager, 1);
+	Handle_Handle32 q2 = MakeNode(manager, 2);
+	Handle_Handle32 q3 = MakeNode(manager, 3);
+	Handle_Queue32Push(&queue, q1);
+	Handle_Queue32Push(&queue, q2);
+	Handle_Queue32Push(&queue, q3);
+	Handle_Manager32Release(manager, q2);
+	LOGINFO("The next WARN is expected as we are testing dangling link detection");
+	REQUIRE(Handle_HandleEqual32(Handle_Queue32Pop(&queue), q1));
+	REQUIRE(Handle_Queue32IsEmpty(&queue));
+	REQUIRE(Handle_Queue32Pop(&queue).handle == 0);
+
+	Handle_Manager32Destroy(manager);
+}
@@ -0,0 +1,162 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/handle.h"
+#include "al2o3_handle/packed64.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_thread/thread.h"
+
+#include <chrono>
+#include <inttypes.h>
+
+TEST_CASE("Basic tests Packed 64", "[al2o3 handle packed64]") {
+	Handle_PackedManager64 *manager = Handle_PackedManager64Create(sizeof(uint64_t), 16, 1, false);
+	REQUIRE(manager);
+
+	Handle_Handle64 handle0 = Handle_PackedManager64Alloc(manager);
+	REQUIRE(handle0.handle == 0x10000000000ull);
+	Handle_PackedManager64Release(manager, handle0);
+	REQUIRE(!Handle_PackedManager64IsValid(manager, handle0));
+	Handle_Handle64 handle1 = Handle_PackedManager64Alloc(manager);
+	REQUIRE(handle1.handle == 1);
+	Handle_PackedManager64Release(manager, handle1);
+
+	Handle_PackedManager64Destroy(manager);
+}
+
+TEST_CASE("Block allocation tests Packed 64", "[al2o3 handle packed64]") {
+	static const int AllocationBlockSize = 16;
+	Handle_PackedManager64 *manager = Handle_PackedManager64Create(sizeof(uint64_t), AllocationBlockSize, 4, false);
+	REQUIRE(manager);
+
+	for (int i = 0; i < AllocationBlockSize * 4; ++i) {
+		Handle_Handle64 handle = Handle_PackedManager64Alloc(manager);
+		if (i == 0) {
+			REQUIRE(handle.handle == 0x10000000000ull);
+		} else {
+			REQUIRE(handle.handle == (uint64_t) i);
+		}
+		*(uint64_t *) Handle_PackedManager64HandleToPtr(manager, handle) = i;
+	}
+	LOGINFO("The next WARN is expected as we are testing the invalid value is return");
+	REQUIRE(Handle_PackedManager64Alloc(manager).handle == 0);
+
+	Handle_PackedManager64Destroy(manager);
+}
+
+TEST_CASE("generation tests Packed 64", "[al2o3 handle packed64]") {
+	static const int AllocationBlockSize = 16;
+	Handle_PackedManager64 *manager = Handle_PackedManager64Create(sizeof(uint64_t), AllocationBlockSize, 4, false);
+	REQUIRE(manager);
+
+	for (int i = 0; i < AllocationBlockSize * 4; ++i) {
+		Handle_Handle64 handle = Handle_PackedManager64Alloc(manager);
+		Handle_PackedManager64Release(manager, handle);
+		REQUIRE(Handle_PackedManager64IsValid(manager, handle) == false);
+	}
+
+	for (int i = 0; i < AllocationBlockSize * 4; ++i) {
+		Handle_Handle64 handle = Handle_PackedManager64Alloc(manager);
+		REQUIRE(Handle_PackedManager64IsValid(manager, handle) == true);
+		Handle_PackedManager64Release(manager, handle);
+	}
+
+	Handle_PackedManager64Destroy(manager);
+}
+
+namespace {
+struct PackedTestData {
+	Handle_PackedManager64 *manager;
+	// 1 while a thread holds the slot, a second alloc of a held slot is a failure
+	Thread_Atomic32_t *held;
+	Thread_Atomic32_t *failures;
+	uint64_t marker;
+};
+
+void PackedThreadFunc(void *userData) {
+	static const int HeldCount = 64;
+	PackedTestData *data = (PackedTestData *) userData;
+	Handle_Handle64 handles[HeldCount];
+	for (int round = 0; round < 2000; ++round) {
+		for (int i = 0; i < HeldCount; ++i) {
+			handles[i] = Handle_PackedManager64Alloc(data->manager);
+			uint64_t const index = handles[i].handle & Handle_MaxHandles64;
+			if (handles[i].handle == 0 || Thread_AtomicCompareExchange32Relaxed(data->held + index, 0, 1) != 0) {
+				Thread_AtomicFetchAdd32Relaxed(data->failures, 1);
+				handles[i].handle = 0;
+				continue;
+			}
+			*(uint64_t *) Handle_PackedManager64HandleToPtr(data->manager, handles[i]) = data->marker;
+		}
+		for (int i = 0; i < HeldCount; ++i) {
+			if (handles[i].handle == 0) {
+				continue;
+			}
+			// nobody else wrote over it while we held it
+			if (*(uint64_t *) Handle_PackedManager64HandleToPtr(data->manager, handles[i]) != data->marker) {
+				Thread_AtomicFetchAdd32Relaxed(data->failures, 1);
+			}
+			Thread_AtomicStore32Relaxed(data->held + (handles[i].handle & Handle_MaxHandles64), 0);
+			Handle_PackedManager64Release(data->manager, handles[i]);
+		}
+	}
+}
+}
+
+TEST_CASE("Multithreaded Packed 64", "[al2o3 handle packed64]") {
+	static const uint32_t numThreads = 4;
+	static const uint32_t AllocationBlockSize = 64;
+	static const uint32_t MaxBlocks = 16;
+	Handle_PackedManager64 *manager =
+			Handle_PackedManager64Create(sizeof(uint64_t), AllocationBlockSize, MaxBlocks, false);
+	REQUIRE(manager);
+	Thread_Atomic32_t *held =
+			(Thread_Atomic32_t *) calloc(AllocationBlockSize * MaxBlocks, sizeof(Thread_Atomic32_t));
+	Thread_Atomic32_t failures;
+	Thread_AtomicStore32Relaxed(&failures, 0);
+
+	PackedTestData data[numThreads];
+	Thread_Thread threads[numThreads];
+	for (auto i = 0u; i < numThreads; ++i) {
+		data[i] = {manager, held, &failures, 0x1111111111111111ull * (i + 1)};
+		Thread_ThreadCreate(threads + i, &PackedThreadFunc, data + i);
+	}
+	for (auto i = 0u; i < numThreads; ++i) {
+		Thread_ThreadJoin(threads + i);
+		Thread_ThreadDestroy(threads + i);
+	}
+	// no slot was ever handed to two threads at once
+	REQUIRE(Thread_AtomicLoad32Relaxed(&failures) == 0);
+
+	free(held);
+	Handle_PackedManager64Destroy(manager);
+}
+
+// a benchmark, so hidden from the default run
+TEST_CASE("Throughput Packed 64 vs 128 bit CAS", "[.][al2o3 handle packed64]") {
+	static const uint64_t cycles = 10000000ull;
+
+	Handle_Manager64 *manager = Handle_Manager64Create(sizeof(uint64_t), 1024, 16, false);
+	Handle_PackedManager64 *packed = Handle_PackedManager64Create(sizeof(uint64_t), 1024, 16, false);
+	REQUIRE(manager);
+	REQUIRE(packed);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint64_t i = 0; i < cycles; ++i) {
+		Handle_Manager64Release(manager, Handle_Manager64Alloc(manager));
+	}
+	auto mid = std::chrono::high_resolution_clock::now();
+	for (uint64_t i = 0; i < cycles; ++i) {
+		Handle_PackedManager64Release(packed, Handle_PackedManager64Alloc(packed));
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	double const ms128 = std::chrono::duration<double, std::milli>(mid - start).count();
+	double const ms64 = std::chrono::duration<double, std::milli>(end - mid).count();
+	LOGINFO("%" PRId64 " million alloc/release cycles", cycles / 1000000ull);
+	LOGINFO("Handle_Manager64 (128 bit CAS) %.1f ms", ms128);
+	LOGINFO("Handle_PackedManager64 (64 bit CAS) %.1f ms", ms64);
+
+	Handle_PackedManager64Destroy(packed);
+	Handle_Manager64Destroy(manager);
+}
@@ -0,0 +1,209 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_thread/thread.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/handle.h"
+#include "al2o3_handle/ringqueue.h"
+
+#include <chrono>
+#include <inttypes.h>
+
+TEST_CASE("Basic tests RingQueue 32", "[al2o3 handle ringqueue]") {
+	Handle_RingQueue32 *queue = Handle_RingQueue32Create(4);
+	REQUIRE(queue);
+	REQUIRE(Handle_RingQueue32Pop(queue).handle == 0);
+
+	for (uint32_t i = 1; i <= 4; ++i) {
+		Handle_Handle32 handle = {i};
+		REQUIRE(Handle_RingQueue32Push(queue, handle));
+	}
+	Handle_Handle32 extra = {5};
+	REQUIRE(!Handle_RingQueue32Push(queue, extra));
+	REQUIRE(Handle_RingQueue32Count(queue) == 4);
+
+	// several laps to check the turn wraps properly
+	for (uint32_t i = 1; i <= 100; ++i) {
+		REQUIRE(Handle_RingQueue32Pop(queue).handle == i);
+		Handle_Handle32 handle = {i + 4};
+		REQUIRE(Handle_RingQueue32Push(queue, handle));
+	}
+
+	Handle_Handle32 batch[8];
+	REQUIRE(Handle_RingQueue32PopBatch(queue, batch, 8) == 4);
+	for (uint32_t i = 0; i < 4; ++i) {
+		REQUIRE(batch[i].handle == 101 + i);
+	}
+	REQUIRE(Handle_RingQueue32PopBatch(queue, batch, 8) == 0);
+
+	for (uint32_t i = 0; i < 8; ++i) {
+		batch[i].handle = 1000 + i;
+	}
+	REQUIRE(Handle_RingQueue32PushBatch(queue, batch, 8) == 4);
+	REQUIRE(Handle_RingQueue32PushBatch(queue, batch, 8) == 0);
+	for (uint32_t i = 0; i < 4; ++i) {
+		REQUIRE(Handle_RingQueue32Pop(queue).handle == 1000 + i);
+	}
+
+	Handle_RingQueue32Destroy(queue);
+}
+
+TEST_CASE("Basic tests RingQueue 64", "[al2o3 handle ringqueue]") {
+	Handle_RingQueue64 *queue = Handle_RingQueue64Create(3);
+	REQUIRE(queue);
+	REQUIRE(queue->capacityMask == 3);
+
+	Handle_Handle64 batch[6];
+	for (uint64_t i = 0; i < 6; ++i) {
+		batch[i].handle = 0x10000000000ull + i;
+	}
+	REQUIRE(Handle_RingQueue64PushBatch(queue, batch, 6) == 4);
+	REQUIRE(!Handle_RingQueue64Push(queue, batch[5]));
+	for (uint64_t i = 0; i < 2; ++i) {
+		REQUIRE(Handle_RingQueue64Pop(queue).handle == 0x10000000000ull + i);
+	}
+	REQUIRE(Handle_RingQueue64Push(queue, batch[4]));
+	REQUIRE(Handle_RingQueue64Push(queue, batch[5]));
+	REQUIRE(Handle_RingQueue64PopBatch(queue, batch, 6) == 4);
+	REQUIRE(batch[0].handle == 0x10000000002ull);
+	REQUIRE(batch[3].handle == 0x10000000005ull);
+	REQUIRE(Handle_RingQueue64Pop(queue).handle == 0);
+
+	Handle_RingQueue64Destroy(queue);
+}
+
+namespace {
+struct RingQueueTestData {
+	Handle_RingQueue32 *queue;
+	uint32_t itemsPerProducer;
+	Thread_Atomic64_t consumedSum;
+	Thread_Atomic32_t consumedCount;
+	uint32_t totalItems;
+};
+}
+
+static void RingQueueProducerFunc(void *userPtr) {
+	RingQueueTestData *data = (RingQueueTestData *) userPtr;
+	Handle_Handle32 batch[16];
+	uint32_t i = 0;
+	while (i < data->itemsPerProducer) {
+		// mix single and batch pushes
+		if (i & 0x1u) {
+			uint32_t const n = (data->itemsPerProducer - i) < 16 ? (data->itemsPerProducer - i) : 16;
+			for (uint32_t j = 0; j < n; ++j) {
+				batch[j].handle = i + j + 1;
+			}
+			uint32_t const pushed = Handle_RingQueue32PushBatch(data->queue, batch, n);
+			if (pushed == 0) {
+				// full, let the consumers run (matters when threads outnumber cores)
+				Thread_Yield();
+			}
+			i += pushed;
+		} else {
+			Handle_Handle32 handle = {i + 1};
+			if (Handle_RingQueue32Push(data->queue, handle)) {
+				i++;
+			} else {
+				Thread_Yield();
+			}
+		}
+	}
+}
+
+static void RingQueueConsumerFunc(void *userPtr) {
+	RingQueueTestData *data = (RingQueueTestData *) userPtr;
+	Handle_Handle32 batch[8];
+	uint32_t round = 0;
+	while (Thread_AtomicLoad32Relaxed(&data->consumedCount) < data->totalItems) {
+		if (round++ & 0x1u) {
+			uint32_t const n = Handle_RingQueue32PopBatch(data->queue, batch, 8);
+			for (uint32_t j = 0; j < n; ++j) {
+				Thread_AtomicFetchAdd64Relaxed(&data->consumedSum, batch[j].handle);
+			}
+			Thread_AtomicFetchAdd32Relaxed(&data->consumedCount, n);
+			if (n == 0) {
+				Thread_Yield(); // empty, let the producers run
+			}
+		} else {
+			Handle_Handle32 handle = Handle_RingQueue32Pop(data->queue);
+			if (handle.handle) {
+				Thread_AtomicFetchAdd64Relaxed(&data->consumedSum, handle.handle);
+				Thread_AtomicFetchAdd32Relaxed(&data->consumedCount, 1);
+			} else {
+				Thread_Yield();
+			}
+		}
+	}
+}
+
+TEST_CASE("Multithreaded RingQueue 32", "[al2o3 handle ringqueue]") {
+	static const uint32_t numProducers = 2;
+	static const uint32_t numConsumers = 2;
+	RingQueueTestData data;
+	data.queue = Handle_RingQueue32Create(64);
+	REQUIRE(data.queue);
+	data.itemsPerProducer = 100000;
+	data.totalItems = data.itemsPerProducer * numProducers;
+	Thread_AtomicStore64Relaxed(&data.consumedSum, 0);
+	Thread_AtomicStore32Relaxed(&data.consumedCount, 0);
+
+	Thread_Thread *threads = (Thread_Thread *) STACK_ALLOC(sizeof(Thread_Thread) * (numProducers + numConsumers));
+	for (auto i = 0u; i < numProducers; ++i) {
+		Thread_ThreadCreate(threads + i, &RingQueueProducerFunc, &data);
+	}
+	for (auto i = 0u; i < numConsumers; ++i) {
+		Thread_ThreadCreate(threads + numProducers + i, &RingQueueConsumerFunc, &data);
+	}
+	for (auto i = 0u; i < numProducers + numConsumers; ++i) {
+		Thread_ThreadJoin(threads + i);
+		Thread_ThreadDestroy(threads + i);
+	}
+
+	uint64_t const n = data.itemsPerProducer;
+	REQUIRE(Thread_AtomicLoad32Relaxed(&data.consumedCount) == data.totalItems);
+	REQUIRE(Thread_AtomicLoad64Relaxed(&data.consumedSum) == numProducers * ((n * (n + 1)) / 2));
+	REQUIRE(Handle_RingQueue32Count(data.queue) == 0);
+
+	Handle_RingQueue32Destroy(data.queue);
+}
+
+TEST_CASE("Throughput RingQueue 32 vs manager CAS", "[.][al2o3 handle ringqueue]") {
+	static const uint64_t cycles = 10000000ull;
+
+	Handle_Manager32 *manager = Handle_Manager32Create(sizeof(uint64_t), 1024, 16, false);
+	Handle_RingQueue32 *queue = Handle_RingQueue32Create(1024);
+	REQUIRE(manager);
+	REQUIRE(queue);
+	Handle_Handle32 handle = Handle_Manager32Alloc(manager);
+	Handle_Handle32 batch[32];
+	for (uint32_t i = 0; i < 32; ++i) {
+		batch[i] = handle;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint64_t i = 0; i < cycles; ++i) {
+		Handle_Manager32Release(manager, Handle_Manager32Alloc(manager));
+	}
+	auto managerEnd = std::chrono::high_resolution_clock::now();
+	for (uint64_t i = 0; i < cycles; ++i) {
+		Handle_RingQueue32Push(queue, handle);
+		Handle_RingQueue32Pop(queue);
+	}
+	auto singleEnd = std::chrono::high_resolution_clock::now();
+	for (uint64_t i = 0; i < cycles / 32; ++i) {
+		Handle_RingQueue32PushBatch(queue, batch, 32);
+		Handle_RingQueue32PopBatch(queue, batch, 32);
+	}
+	auto batchEnd = std::chrono::high_resolution_clock::now();
+
+	LOGINFO("%" PRId64 " million handle round trips", cycles / 1000000ull);
+	LOGINFO("Handle_Manager32 alloc/release %.1f ms",
+					std::chrono::duration<double, std::milli>(managerEnd - start).count());
+	LOGINFO("Handle_RingQueue32 push/pop %.1f ms",
+					std::chrono::duration<double, std::milli>(singleEnd - managerEnd).count());
+	LOGINFO("Handle_RingQueue32 batch of 32 push/pop %.1f ms",
+					std::chrono::duration<double, std::milli>(batchEnd - singleEnd).count());
+
+	Handle_RingQueue32Destroy(queue);
+	Handle_Manager32Destroy(manager);
+}
@@ -0,0 +1,143 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_thread/atomic.h"
+#include "al2o3_thread/thread.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/sharded.h"
+
+#include <inttypes.h>
+#include <chrono>
+
+TEST_CASE("Basic tests Sharded", "[al2o3 handle sharded]") {
+	Handle_ShardedManager32 *manager = Handle_ShardedManager32Create(sizeof(uint64_t), 16, 4, 1, false);
+	REQUIRE(manager);
+
+	Handle_Handle32 handle0 = Handle_ShardedManager32Alloc(manager);
+	REQUIRE(handle0.handle == 0x01000000);
+	Handle_ShardedManager32Release(manager, handle0);
+	REQUIRE(!Handle_ShardedManager32IsValid(manager, handle0));
+	Handle_Handle32 handle1 = Handle_ShardedManager32Alloc(manager);
+	REQUIRE(handle1.handle == 1);
+	Handle_ShardedManager32Release(manager, handle1);
+
+	Handle_ShardedManager32Destroy(manager);
+}
+
+TEST_CASE("Stealing tests Sharded", "[al2o3 handle sharded]") {
+	static const int AllocationBlockSize = 16;
+	Handle_ShardedManager32 *manager = Handle_ShardedManager32Create(sizeof(uint64_t), AllocationBlockSize, 4, 4, false);
+	REQUIRE(manager);
+	REQUIRE(manager->shardCount == 4);
+
+	// the first block is split across 4 shards, a single thread must steal the rest before growing
+	for (int i = 0; i < AllocationBlockSize; ++i) {
+		Handle_Handle32 handle = Handle_ShardedManager32Alloc(manager);
+		REQUIRE(Handle_ShardedManager32IsValid(manager, handle));
+		*(uint64_t *) Handle_ShardedManager32HandleToPtr(manager, handle) = i;
+	}
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) == AllocationBlockSize);
+
+	// now it has to grow
+	for (int i = 0; i < AllocationBlockSize * 3; ++i) {
+		Handle_Handle32 handle = Handle_ShardedManager32Alloc(manager);
+		REQUIRE(Handle_ShardedManager32IsValid(manager, handle));
+	}
+	REQUIRE(Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated) == AllocationBlockSize * 4);
+
+	Handle_ShardedManager32Destroy(manager);
+}
+
+static Thread_Atomic64_t failures = {0};
+static void ShardedThreadFunc(void *userPtr) {
+	Handle_ShardedManager32 *manager = (Handle_ShardedManager32 *) userPtr;
+	for (uint64_t i = 0; i < 200000; ++i) {
+		Handle_Handle32 handle = Handle_ShardedManager32Alloc(manager);
+		uint64_t *data = (uint64_t *) Handle_ShardedManager32HandleToPtr(manager, handle);
+		if (data == nullptr || *data != 0) {
+			Thread_AtomicFetchAdd64Relaxed(&failures, 1);
+			return;
+		}
+		*data = i + 1;
+		Handle_ShardedManager32Release(manager, handle);
+	}
+}
+
+TEST_CASE("Multithreaded Sharded", "[al2o3 handle sharded]") {
+	static const uint32_t numThreads = 8;
+	Handle_ShardedManager32 *manager = Handle_ShardedManager32Create(sizeof(uint64_t), 64, 256, 4, false);
+	REQUIRE(manager);
+
+	Thread_AtomicStore64Relaxed(&failures, 0);
+	Thread_Thread *threads = (Thread_Thread *) STACK_ALLOC(sizeof(Thread_Thread) * numThreads);
+	for (auto i = 0u; i < numThreads; ++i) {
+		Thread_ThreadCreate(threads + i, &ShardedThreadFunc, manager);
+	}
+	for (auto i = 0u; i < numThreads; ++i) {
+		Thread_ThreadJoin(threads + i);
+		Thread_ThreadDestroy(threads + i);
+	}
+	REQUIRE(Thread_AtomicLoad64Relaxed(&failures) == 0);
+	LOGINFO("Sharded manager with %u shards allocated %u handles",
+					manager->shardCount,
+					Thread_AtomicLoad32Relaxed(&manager->totalHandlesAllocated));
+
+	Handle_ShardedManager32Destroy(manager);
+}
+
+struct ShardedThroughputData {
+	Handle_ShardedManager32 *sharded;
+	Handle_Manager32 *manager;
+	uint64_t cycles;
+};
+
+static void ShardedThroughputFunc(void *userPtr) {
+	ShardedThroughputData *data = (ShardedThroughputData *) userPtr;
+	for (uint64_t i = 0; i < data->cycles; ++i) {
+		Handle_ShardedManager32Release(data->sharded, Handle_ShardedManager32Alloc(data->sharded));
+	}
+}
+
+static void ManagerThroughputFunc(void *userPtr) {
+	ShardedThroughputData *data = (ShardedThroughputData *) userPtr;
+	for (uint64_t i = 0; i < data->cycles; ++i) {
+		Handle_Manager32Release(data->manager, Handle_Manager32Alloc(data->manager));
+	}
+}
+
+static double ThroughputRun(void (*func)(void *), ShardedThroughputData *data, uint32_t numThreads) {
+	Thread_Thread *threads = (Thread_Thread *) STACK_ALLOC(sizeof(Thread_Thread) * numThreads);
+	auto start = std::chrono::high_resolution_clock::now();
+	for (auto i = 0u; i < numThreads; ++i) {
+		Thread_ThreadCreate(threads + i, func, data);
+	}
+	for (auto i = 0u; i < numThreads; ++i) {
+		Thread_ThreadJoin(threads + i);
+		Thread_ThreadDestroy(threads + i);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+TEST_CASE("Throughput Sharded vs Manager32", "[.][al2o3 handle sharded]") {
+	static const uint64_t totalCycles = 8000000ull;
+	static const uint32_t threadCounts[] = {1, 2, 4, 8, 16};
+
+	for (uint32_t numThreads : threadCounts) {
+		ShardedThroughputData data;
+		data.sharded = Handle_ShardedManager32Create(sizeof(uint64_t), 1024, 64, 4, false);
+		data.manager = Handle_Manager32Create(sizeof(uint64_t), 1024, 64, false);
+		REQUIRE(data.sharded);
+		REQUIRE(data.manager);
+		// same total work at every thread count so the times compare directly
+		data.cycles = totalCycles / numThreads;
+
+		double const shardedMs = ThroughputRun(&ShardedThroughputFunc, &data, numThreads);
+		double const managerMs = ThroughputRun(&ManagerThroughputFunc, &data, numThreads);
+
+		LOGINFO("%u threads, %" PRId64 " million alloc/release: Sharded %.1f ms, Manager32 %.1f ms",
+						numThreads, totalCycles / 1000000ull, shardedMs, managerMs);
+
+		Handle_Manager32Destroy(data.manager);
+		Handle_ShardedManager32Destroy(data.sharded);
+	}
+}
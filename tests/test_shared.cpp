@@ -0,0 +1,110 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/handle.h"
+#include "al2o3_handle/shared.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+TEST_CASE("Basic tests Shared 32", "[al2o3 handle shared]") {
+	char name[64];
+	snprintf(name, sizeof(name), "/al2o3_handle_test_%d", (int) getpid());
+
+	Handle_SharedManager32 *manager = Handle_SharedManager32Create(name, sizeof(uint64_t), 16, 4, false);
+	REQUIRE(manager);
+	// a second view of the same segment, mapped at a different address
+	Handle_SharedManager32 *view = Handle_SharedManager32Open(name);
+	REQUIRE(view);
+	REQUIRE(view->header != manager->header);
+
+	Handle_Handle32 handle0 = Handle_SharedManager32Alloc(manager);
+	REQUIRE(handle0.handle == 0x01000000);
+	Handle_Handle32 handle1 = Handle_SharedManager32Alloc(view);
+	REQUIRE(handle1.handle == 1);
+
+	*(uint64_t *) Handle_SharedManager32HandleToPtr(manager, handle1) = 0xCAFEull;
+	REQUIRE(*(uint64_t *) Handle_SharedManager32HandleToPtr(view, handle1) == 0xCAFEull);
+
+	// grow through one view and use the new block from the other
+	Handle_Handle32 last = {0};
+	for (int i = 0; i < 40; ++i) {
+		last = Handle_SharedManager32Alloc(view);
+		REQUIRE(last.handle != 0);
+	}
+	REQUIRE(Handle_SharedManager32IsValid(manager, last));
+	Handle_SharedManager32Release(manager, last);
+	REQUIRE(!Handle_SharedManager32IsValid(view, last));
+	// the deferred link carries the new generation
+	uint32_t const deferredHead = (uint32_t) (Thread_AtomicLoad64Relaxed(&manager->header->freeListHeads) >> 32ull);
+	REQUIRE(deferredHead == (last.handle + (1u << Handle_GenerationBitShift32)));
+
+	Handle_SharedManager32Close(view);
+	Handle_SharedManager32Close(manager);
+	Handle_SharedManager32Unlink(name);
+	LOGINFO("The next WARN is expected as we are testing the segment was unlinked");
+	REQUIRE(Handle_SharedManager32Open(name) == NULL);
+}
+
+#if defined(__linux__)
+TEST_CASE("Multiprocess Shared 32", "[al2o3 handle shared]") {
+	Handle_SharedManager32 *manager = Handle_SharedManager32Create(NULL, sizeof(uint64_t), 256, 64, false);
+	REQUIRE(manager);
+
+	Handle_Handle32 handle = Handle_SharedManager32Alloc(manager);
+	*(uint64_t *) Handle_SharedManager32HandleToPtr(manager, handle) = 42;
+
+	pid_t child = fork();
+	REQUIRE(child >= 0);
+	if (child == 0) {
+		// map it again in the child, no pointers are shared only offsets
+		Handle_SharedManager32 *view = Handle_SharedManager32OpenFd(dup(Handle_SharedManager32Fd(manager)));
+		int result = 0;
+		if (!view || *(uint64_t *) Handle_SharedManager32HandleToPtr(view, handle) != 42) {
+			result = 1;
+		}
+		for (uint64_t i = 0; view && result == 0 && i < 100000; ++i) {
+			Handle_Handle32 h = Handle_SharedManager32Alloc(view);
+			uint64_t *ptr = (uint64_t *) Handle_SharedManager32HandleToPtr(view, h);
+			if (!ptr) {
+				result = 2;
+				break;
+			}
+			*ptr = i;
+			if (*ptr != i) {
+				result = 3;
+			}
+			Handle_SharedManager32Release(view, h);
+		}
+		// hand a handle back to the parent
+		if (view) {
+			Handle_Handle32 h = Handle_SharedManager32Alloc(view);
+			*(uint64_t *) Handle_SharedManager32HandleToPtr(view, h) = 0xC0FFEEull;
+			*(uint64_t *) Handle_SharedManager32HandleToPtr(view, handle) = h.handle;
+		}
+		_exit(result);
+	}
+
+	for (uint64_t i = 0; i < 100000; ++i) {
+		Handle_Handle32 h = Handle_SharedManager32Alloc(manager);
+		REQUIRE(h.handle != 0);
+		*(uint64_t *) Handle_SharedManager32HandleToPtr(manager, h) = i;
+		Handle_SharedManager32Release(manager, h);
+	}
+
+	int status = 0;
+	REQUIRE(waitpid(child, &status, 0) == child);
+	REQUIRE(WIFEXITED(status));
+	REQUIRE(WEXITSTATUS(status) == 0);
+
+	Handle_Handle32 fromChild = {(uint32_t) *(uint64_t *) Handle_SharedManager32HandleToPtr(manager, handle)};
+	REQUIRE(Handle_SharedManager32IsValid(manager, fromChild));
+	REQUIRE(*(uint64_t *) Handle_SharedManager32HandleToPtr(manager, fromChild) == 0xC0FFEEull);
+
+	Handle_SharedManager32Close(manager);
+}
+#endif
+
+#endif
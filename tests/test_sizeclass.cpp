@@ -0,0 +1,79 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/handle.h"
+#include "al2o3_handle/sizeclass.h"
+
+#include <string.h>
+
+TEST_CASE("Basic tests SizeClass", "[al2o3 handle sizeclass]") {
+	Handle_SizeClassAllocator *allocator = Handle_SizeClassAllocatorCreate(4096, 16);
+	REQUIRE(allocator);
+
+	Handle_Handle64 tiny = Handle_SizeClassAlloc(allocator, 3);
+	Handle_Handle64 mid = Handle_SizeClassAlloc(allocator, 100);
+	Handle_Handle64 big = Handle_SizeClassAlloc(allocator, Handle_SizeClassMaxSize);
+	Handle_Handle64 large = Handle_SizeClassAlloc(allocator, Handle_SizeClassMaxSize + 1);
+	REQUIRE(tiny.handle != 0);
+	REQUIRE(mid.handle != 0);
+	REQUIRE(big.handle != 0);
+	REQUIRE(large.handle != 0);
+
+	REQUIRE(Handle_SizeClassOf(tiny) == 0);
+	REQUIRE(Handle_SizeClassOf(mid) == 3);
+	REQUIRE(Handle_SizeClassOf(big) == Handle_SizeClassCount - 1);
+	REQUIRE(Handle_SizeClassOf(large) == Handle_SizeClassLarge);
+
+	REQUIRE(Handle_SizeClassHandleToSize(allocator, tiny) == 16);
+	REQUIRE(Handle_SizeClassHandleToSize(allocator, mid) == 128);
+	REQUIRE(Handle_SizeClassHandleToSize(allocator, big) == Handle_SizeClassMaxSize);
+	REQUIRE(Handle_SizeClassHandleToSize(allocator, large) == Handle_SizeClassMaxSize + 1);
+
+	// all usable and zero'ed
+	uint8_t *midPtr = (uint8_t *) Handle_SizeClassHandleToPtr(allocator, mid);
+	uint8_t *largePtr = (uint8_t *) Handle_SizeClassHandleToPtr(allocator, large);
+	REQUIRE(midPtr);
+	REQUIRE(largePtr);
+	REQUIRE(midPtr[99] == 0);
+	REQUIRE(largePtr[Handle_SizeClassMaxSize] == 0);
+	memset(midPtr, 0xAA, 128);
+	memset(largePtr, 0xAA, Handle_SizeClassMaxSize + 1);
+
+	Handle_SizeClassRelease(allocator, mid);
+	Handle_SizeClassRelease(allocator, large);
+	REQUIRE(!Handle_SizeClassIsValid(allocator, mid));
+	REQUIRE(!Handle_SizeClassIsValid(allocator, large));
+	REQUIRE(Handle_SizeClassIsValid(allocator, tiny));
+	REQUIRE(Handle_SizeClassIsValid(allocator, big));
+
+	// a new handle for the same slot doesn't validate the old one
+	Handle_Handle64 mid2 = Handle_SizeClassAlloc(allocator, 120);
+	REQUIRE(Handle_SizeClassOf(mid2) == 3);
+	REQUIRE(!Handle_HandleEqual64(mid, mid2));
+	REQUIRE(!Handle_SizeClassIsValid(allocator, mid));
+	REQUIRE(((uint8_t *) Handle_SizeClassHandleToPtr(allocator, mid2))[0] == 0);
+
+	// destroy cleans up anything left, including large objects
+	Handle_SizeClassAlloc(allocator, 1024 * 1024);
+	Handle_SizeClassAllocatorDestroy(allocator);
+}
+
+TEST_CASE("Many sizes SizeClass", "[al2o3 handle sizeclass]") {
+	Handle_SizeClassAllocator *allocator = Handle_SizeClassAllocatorCreate(4096, 64);
+	REQUIRE(allocator);
+
+	Handle_Handle64 handles[512];
+	for (uint32_t i = 0; i < 512; ++i) {
+		size_t const size = 1 + ((i * 97u) % 40000u);
+		handles[i] = Handle_SizeClassAlloc(allocator, size);
+		REQUIRE(handles[i].handle != 0);
+		REQUIRE(Handle_SizeClassHandleToSize(allocator, handles[i]) >= size);
+		memset(Handle_SizeClassHandleToPtr(allocator, handles[i]), (int) i, size);
+	}
+	for (uint32_t i = 0; i < 512; ++i) {
+		REQUIRE(*(uint8_t *) Handle_SizeClassHandleToPtr(allocator, handles[i]) == (uint8_t) i);
+		Handle_SizeClassRelease(allocator, handles[i]);
+	}
+
+	Handle_SizeClassAllocatorDestroy(allocator);
+}
@@ -0,0 +1,92 @@
+// License Summary: MIT see LICENSE file
+#include "al2o3_platform/platform.h"
+#include "al2o3_catch2/catch2.hpp"
+#include "al2o3_handle/slotmap.h"
+
+TEST_CASE("Basic tests SlotMap", "[al2o3 handle slotmap]") {
+	Handle_SlotMap32 *map = Handle_SlotMap32Create(sizeof(uint64_t), 16);
+	REQUIRE(map);
+
+	Handle_Handle32 handle0 = Handle_SlotMap32Alloc(map);
+	REQUIRE(handle0.handle == 0x01000000);
+	REQUIRE(Handle_SlotMap32Size(map) == 1);
+	Handle_SlotMap32Release(map, handle0);
+	REQUIRE(!Handle_SlotMap32IsValid(map, handle0));
+	REQUIRE(Handle_SlotMap32Size(map) == 0);
+	Handle_Handle32 handle1 = Handle_SlotMap32Alloc(map);
+	REQUIRE(handle1.handle == 1);
+	Handle_SlotMap32Release(map, handle1);
+
+	Handle_SlotMap32Destroy(map);
+}
+
+TEST_CASE("Initial capacity SlotMap", "[al2o3 handle slotmap]") {
+	// any size is honoured exactly, odd ones included
+	uint32_t const capacities[] = { 1, 3, 17, 100 };
+	for (uint32_t capacity : capacities) {
+		Handle_SlotMap32 *map = Handle_SlotMap32Create(sizeof(uint64_t), capacity);
+		REQUIRE(map);
+		REQUIRE(map->capacity == capacity);
+		for (uint32_t i = 0; i < capacity; ++i) {
+			REQUIRE(Handle_SlotMap32Alloc(map).handle != 0);
+		}
+		// no growth until it is exceeded
+		REQUIRE(map->capacity == capacity);
+		Handle_SlotMap32Destroy(map);
+	}
+}
+
+TEST_CASE("Dense packing SlotMap", "[al2o3 handle slotmap]") {
+	static const uint32_t Count = 100;
+	// start small to force growth
+	Handle_SlotMap32 *map = Handle_SlotMap32Create(sizeof(uint64_t), 2);
+	REQUIRE(map);
+
+	Handle_Handle32 handles[Count];
+	for (uint32_t i = 0; i < Count; ++i) {
+		handles[i] = Handle_SlotMap32Alloc(map);
+		REQUIRE(Handle_SlotMap32IsValid(map, handles[i]));
+		uint64_t *data = (uint64_t *) Handle_SlotMap32HandleToPtr(map, handles[i]);
+		REQUIRE(*data == 0);
+		*data = i;
+	}
+
+	// release every other one, the rest must stay packed and reachable
+	for (uint32_t i = 0; i < Count; i += 2) {
+		Handle_SlotMap32Release(map, handles[i]);
+	}
+	REQUIRE(Handle_SlotMap32Size(map) == Count / 2);
+
+	uint64_t sum = 0;
+	uint64_t const *dense = (uint64_t const *) Handle_SlotMap32Data(map);
+	for (uint32_t i = 0; i < Handle_SlotMap32Size(map); ++i) {
+		REQUIRE((dense[i] & 0x1) == 1);
+		Handle_Handle32 handle = Handle_SlotMap32DenseIndexToHandle(map, i);
+		REQUIRE(Handle_HandleEqual32(handle, handles[dense[i]]));
+		sum += dense[i];
+	}
+	REQUIRE(sum == (Count / 2) * (Count / 2));
+
+	for (uint32_t i = 0; i < Count; ++i) {
+		if (i & 0x1) {
+			REQUIRE(*(uint64_t *) Handle_SlotMap32HandleToPtr(map, handles[i]) == i);
+		} else {
+			REQUIRE(Handle_SlotMap32HandleToPtr(map, handles[i]) == NULL);
+		}
+	}
+
+	Handle_SlotMap32Destroy(map);
+}
+
+TEST_CASE("generation tests SlotMap", "[al2o3 handle slotmap]") {
+	Handle_SlotMap32 *map = Handle_SlotMap32Create(sizeof(uint32_t), 4);
+	REQUIRE(map);
+
+	for (int i = 0; i < 1000; ++i) {
+		Handle_Handle32 handle = Handle_SlotMap32Alloc(map);
+		REQUIRE(Handle_SlotMap32IsValid(map, handle));
+		Handle_SlotMap32Release(map, handle);
+		REQUIRE(!Handle_SlotMap32IsValid(map, handle));
+	}
+	Handle_SlotMap32Destroy(map);
+}